@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+// Heap allocation counters fed by replacement global operator new/delete
+// (src/14_AllocTracker.cpp). Only compiled into profiling builds; the
+// Profiler reads them to attribute allocations to zones and frames.
+
+#ifdef SNAKE_PROFILE
+
+struct AllocCounters {
+    std::uint64_t allocs = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t frees = 0;
+};
+
+namespace AllocTracker {
+    // Running totals for the calling thread
+    AllocCounters thisThread();
+}
+
+#endif
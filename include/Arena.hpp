@@ -0,0 +1,126 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include "Common.hpp"
+#include "WorldSnapshot.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Stress mode: hundreds of AI snakes on one large board (SNAKE_ARENA=<count>).
+//
+// Storage is laid out for many snakes rather than one:
+// - one occupancy grid for the whole board, each cell tagged with the id of
+//   the snake on it (or EMPTY / WALL), so every collision test is one lookup;
+// - every body is a ring buffer inside a single pooled PackedCell array
+//   (MAX_LENGTH cells per snake), so moving is O(1) and nothing is allocated
+//   per tick;
+// - steering decisions only read the shared grids and run in parallel on the
+//   JobSystem; moves, collisions and eating are then resolved in id order, so
+//   a run is reproducible from its seed.
+// Fruits follow the single-player rules (Gomu +1 / Mera +5 / Ope +10, growth,
+// fruit timer); reaching a portal score opens a portal any snake can take.
+class Arena {
+public:
+    Arena(int gridWidth, int gridHeight, int snakeCount, unsigned seed, float tickSeconds = 0.08f);
+
+    void tick();
+    void draw(sf::RenderTarget& target, int blockSize) const;
+
+    int getSnakeCount() const { return (int)snakes.size(); }
+    int getAliveCount() const { return aliveCount; }
+    long getTickCount() const { return tickCount; }
+    int getBestScore() const;
+    int getGridWidth() const { return gridWidth; }
+    int getGridHeight() const { return gridHeight; }
+    // Colour of snake `id`, shared with the network client
+    static sf::Color snakeColor(int id);
+    // Square board size that leaves every snake about 80 cells
+    static int boardSideFor(int snakeCount);
+
+    // Networked play: controlled snakes skip the AI and follow steer()
+    void setControlled(int id, bool on) { controlled[(size_t)id] = on ? 1 : 0; }
+    void steer(int id, int dx, int dy);
+
+    // Read access for network snapshots. The epoch changes whenever a body
+    // jumps (spawn, death, portal); moves counts head steps within an epoch.
+    bool isAlive(int id) const { return snakes[(size_t)id].alive; }
+    int getScore(int id) const { return snakes[(size_t)id].score; }
+    std::uint32_t getEpoch(int id) const { return snakes[(size_t)id].epoch; }
+    std::uint32_t getMoves(int id) const { return snakes[(size_t)id].moves; }
+    void copyBody(int id, std::vector<Cell>& out) const;
+    void copyWalls(std::vector<Cell>& out) const;
+    const std::vector<Fruit>& getFruits() const { return fruits; }
+    const std::vector<Portal>& getPortals() const { return portals; }
+    // Heap owned by this arena (grids, pooled bodies, fruit lists)
+    std::size_t getMemoryBytes() const;
+
+    static const int MAX_LENGTH = 256; // growth stops at this length
+    static const int MAX_PORTALS = 8;
+    // Fruits on the board at once: the Gomu target plus the Mera and Ope caps
+    static constexpr int maxFruits(int snakeCount) {
+        return std::max(1, snakeCount / 2) + 2 * std::max(1, snakeCount / 20);
+    }
+
+private:
+    static constexpr std::uint16_t EMPTY = 0;
+    static constexpr std::uint16_t WALL = 0xFFFF; // otherwise: snake id + 1
+
+    struct ArenaSnake {
+        std::uint32_t head = 0;   // ring index of the head in this snake's pool slice
+        std::uint32_t length = 0;
+        int growPending = 0;
+        Cell dir{0, -1};
+        Cell nextDir{0, -1};
+        int score = 0;
+        int nextPortalScore = 30;
+        float fruitCountdown = 20.f;
+        int respawnTicks = 0;     // counts down while dead
+        int target = -1;          // grid index of the fruit being chased
+        std::uint32_t rng = 1;    // xorshift state for the AI
+        std::uint32_t epoch = 0;
+        std::uint32_t moves = 0;
+        bool alive = false;
+        bool headOn = false;      // lost a head-to-head this tick
+        int moveTo = -1;          // grid index the head enters this tick
+    };
+
+    int index(int x, int y) const { return y * gridWidth + x; }
+    Cell cellAt(std::uint32_t snake, std::uint32_t i) const;
+    void decide(std::uint32_t id);
+    bool spawnSnake(std::uint32_t id);
+    void kill(std::uint32_t id);
+    void eat(std::uint32_t id, int cell);
+    bool teleport(std::uint32_t id);
+    bool randomFreeCell(int& cell);
+    void spawnFruit(Fruit::Type type, float duration);
+    void removeFruit(int cell);
+    void spawnCheck();
+
+    int gridWidth;
+    int gridHeight;
+    float tickSeconds;
+    std::mt19937 rng;
+    long tickCount = 0;
+    int aliveCount = 0;
+
+    std::vector<std::uint16_t> occupancy;  // gridWidth * gridHeight
+    std::vector<std::int32_t> fruitAt;     // index into fruits, -1 if none
+    std::vector<std::uint16_t> headClaim;  // scratch: who moves into each cell this tick
+    std::vector<std::uint32_t> dying;      // scratch: snakes that crashed this tick
+    std::vector<PackedCell> bodies;        // pooled rings, MAX_LENGTH cells per snake
+    std::vector<ArenaSnake> snakes;
+    std::vector<char> controlled;          // per snake: steered from outside
+    std::vector<Fruit> fruits;
+    std::vector<Portal> portals;
+    std::vector<sf::Color> palette;
+
+    int gomuTarget;
+    int typeCount[3] = {0, 0, 0}; // fruits on the board per Fruit::Type
+    float lastSpawnCheck = 0.f;
+    float spawnCheckInterval = 0.5f; // seconds, as in single player
+    static const int RESPAWN_TICKS = 25;
+
+    mutable sf::VertexArray vertices; // reused by draw()
+};
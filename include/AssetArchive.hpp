@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// On-disk layout of assets.pak, shared by the game and the offline packer
+// (tools/AssetPacker.cpp). Everything is little-endian and fixed-size so the
+// index can be read straight out of the mapped file:
+//
+//   Header | Entry[entryCount] | padding | data blob | padding | data blob ...
+//
+// Every data blob starts on a multiple of Header::alignment. Small sprites may
+// be stored pre-decoded as raw RGBA8 so they go to the GPU without decoding.
+namespace pak {
+
+const char MAGIC[4] = {'M', 'S', 'P', 'K'};
+const std::uint32_t VERSION = 1;
+const std::uint32_t DEFAULT_ALIGNMENT = 64;
+const std::size_t NAME_SIZE = 96;
+
+enum class Format : std::uint32_t {
+    Raw = 0,   // file bytes as found under assets/ (png, ttf, mp3, ...)
+    RGBA8 = 1  // decoded pixels, width * height * 4 bytes
+};
+
+struct Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t entryCount;
+    std::uint32_t alignment;
+    std::uint64_t indexOffset;
+    std::uint64_t fileSize;
+};
+
+struct Entry {
+    char name[NAME_SIZE];    // path relative to assets/, NUL terminated
+    std::uint64_t offset;    // from start of file
+    std::uint64_t size;      // bytes
+    std::uint32_t format;    // pak::Format
+    std::uint16_t width;     // RGBA8 only
+    std::uint16_t height;    // RGBA8 only
+    std::uint8_t reserved[8];
+};
+
+// An RGBA8 entry holds exactly its pixels; any other format is unknown
+inline bool sizeMatches(const Entry& e) {
+    if (e.format == (std::uint32_t)Format::Raw) return true;
+    return e.format == (std::uint32_t)Format::RGBA8 && e.width > 0 && e.height > 0 &&
+           e.size == (std::uint64_t)e.width * e.height * 4;
+}
+
+static_assert(sizeof(Header) == 32, "pak::Header layout changed");
+static_assert(sizeof(Entry) == 128, "pak::Entry layout changed");
+
+} // namespace pak
+
+// Read-only, memory-mapped view of an assets.pak file. Lookups return pointers
+// into the mapping, which stays valid for the archive's lifetime; resources
+// built with loadFromMemory() (fonts, music) rely on that.
+class AssetArchive {
+public:
+    AssetArchive() = default;
+    ~AssetArchive();
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+
+    std::uint32_t size() const { return count; }
+    const pak::Entry& entryAt(std::uint32_t i) const { return entries[i]; }
+    // Binary search over the (sorted) index; nullptr if not packed
+    const pak::Entry* find(const std::string& name) const;
+    const void* data(const pak::Entry& e) const { return base + e.offset; }
+
+private:
+    const unsigned char* base = nullptr;
+    std::size_t mappedSize = 0;
+    const pak::Entry* entries = nullptr;
+    std::uint32_t count = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <SFML/Audio.hpp>
+#include "AssetArchive.hpp"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Which startup phase needs an asset. Critical assets are decoded first and the
+// first frame waits for them; Background assets finish while the menu is up.
+enum class LoadPriority { Critical = 0, Background = 1 };
+
+// Central access point for everything under assets/.
+// If an assets.pak (built by tools/AssetPacker) is found it is memory-mapped
+// and every resource is loaded from the mapped bytes. Otherwise the loose
+// assets/ root is resolved once and indexed with a single directory walk, so
+// lookups never touch the filesystem again. Loaded resources
+// are handed out as shared handles: every GameLogic (or any other user) asking
+// for the same file gets the same texture/font/buffer, and it is released when
+// the last handle goes away.
+class AssetManager {
+public:
+    static AssetManager& instance();
+    ~AssetManager();
+
+    // Names are relative to assets/ ("images/portal.png"); a leading
+    // "assets/" or "../assets/" is accepted too. resolve() gives the loose
+    // file path, "" if not indexed (always "" when running from a pack).
+    std::string resolve(const std::string& name) const;
+    bool exists(const std::string& name) const;
+
+    // Never null: on failure an empty resource is returned, so callers keep
+    // their usual "size == 0 -> draw fallback" checks. A texture that is still
+    // being decoded by textureAsync() is returned as is and fills in later.
+    std::shared_ptr<sf::Texture> texture(const std::string& name);
+    std::shared_ptr<sf::Font> font(const std::string& name);
+    std::shared_ptr<sf::SoundBuffer> soundBuffer(const std::string& name);
+    // sf::Music streams, so it cannot be shared; this only opens the source
+    bool openMusic(sf::Music& music, const std::string& name);
+
+    // Returns the (still empty) texture right away and decodes the image on a
+    // worker thread. The pixels reach the GPU in pumpUploads()/finishLoading(),
+    // which must be called from the render thread.
+    std::shared_ptr<sf::Texture> textureAsync(const std::string& name, LoadPriority priority);
+    // Upload every image decoded so far; returns how many textures changed
+    int pumpUploads();
+    // Block until all queued images up to `upTo` priority are uploaded
+    void finishLoading(LoadPriority upTo = LoadPriority::Background);
+    bool isLoading() const;
+
+    const std::string& getRoot() const { return root; }
+
+private:
+    AssetManager();
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    void indexAssets();
+    static std::string normalize(const std::string& name);
+
+    template <typename T>
+    std::shared_ptr<T> acquire(std::unordered_map<std::string, std::weak_ptr<T>>& cache,
+                               const std::string& name, const char* kind);
+
+    std::string root; // "assets", "../assets", "assets.pak", ...; empty if not found
+    AssetArchive archive;
+    std::unordered_map<std::string, std::string> index; // relative name -> full path
+    std::unordered_map<std::string, std::weak_ptr<sf::Texture>> textures;
+    std::unordered_map<std::string, std::weak_ptr<sf::Font>> fonts;
+    std::unordered_map<std::string, std::weak_ptr<sf::SoundBuffer>> soundBuffers;
+    std::mutex cacheMutex;                   // guards the caches, not the loads
+    std::condition_variable cacheLoaded;
+    std::unordered_set<std::string> loading; // "kind:name" being loaded by acquire()
+
+    // Image decode pool
+    struct DecodeJob {
+        std::string path;
+        std::shared_ptr<sf::Texture> target;
+        LoadPriority priority;
+        const pak::Entry* packed = nullptr; // set when the bytes come from the archive
+        sf::Image image;
+        bool decoded = false;
+    };
+    void startWorkers();
+    void workerLoop();
+    std::vector<std::thread> workers;
+    std::deque<DecodeJob> queued[2];  // per priority, waiting for a worker
+    std::vector<DecodeJob> decoded;   // waiting for upload on the render thread
+    int outstanding[2] = {0, 0};      // queued + decoding + waiting for upload
+    mutable std::mutex jobMutex;
+    std::condition_variable jobReady;  // workers wait for queued jobs
+    std::condition_variable jobDone;   // finishLoading waits for decoded images
+    bool stopping = false;
+};
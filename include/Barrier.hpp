@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <random>
+#include <memory>
 #include <SFML/Graphics.hpp>
 #include "Common.hpp"
 
@@ -9,11 +10,19 @@ class Barrier {
 public:
     Barrier(int minX, int minY, int maxX, int maxY);
     
-    void draw(sf::RenderWindow& window, int blockSize);
+    void draw(sf::RenderTarget& window, int blockSize);
     bool checkCollision(const Cell& pos) const;
     // regenerate random internal walls while keeping border
     void generateRandom(std::mt19937 &rng, int gridWidth, int gridHeight, const std::vector<Cell>& forbidden);
+    // Cells the map after a portal jump keeps free: the column a snake of
+    // `length` occupies straight up from the exit plus a 1-cell margin
+    // (sorted), or only the 3x3 around the exit when `column` is false
+    static void portalSafeArea(int ex, int ey, int length, bool column, int gridWidth, int gridHeight, std::vector<Cell>& out);
     const std::vector<Cell>& getWalls() const { return walls; }
+    // replace the wall set (save-state restore, render-side copy)
+    void setWalls(const std::vector<Cell>& w) { walls = w; version++; }
+    // bumped whenever the wall set is rebuilt or replaced
+    unsigned getVersion() const { return version; }
     void loadTexture(const std::string& path);
     
     int getMinX() const { return minX; }
@@ -24,7 +33,8 @@ public:
 private:
     int minX, minY, maxX, maxY;
     std::vector<Cell> walls;
-    sf::Texture wallTexture;
+    unsigned version = 0;
+    std::shared_ptr<sf::Texture> wallTexture;
     
     void buildWalls();
 };
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Common.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Board geometry for tick loops. Board<W, H> has its size built in, so cell
+// indices, ring wrap-around and bitboard word counts are constants, and the
+// neighbours of a cell come from a table built at compile time. Board<0, 0>
+// offers the same calls with the size read at run time, for any other board.
+// withBoard() picks the specialisation for a size.
+//
+// Directions are in GymEnv action order: up, down, left, right.
+
+// Bitboards: one bit per cell, cell i in word i / 64
+struct Bitboard {
+    using Word = std::uint64_t;
+    static int wordsFor(int area) { return (area + 63) / 64; }
+    static bool test(const std::vector<Word>& bits, int cell) { return (bits[(std::size_t)(cell >> 6)] >> (cell & 63)) & 1; }
+    static void set(std::vector<Word>& bits, int cell) { bits[(std::size_t)(cell >> 6)] |= (Word)1 << (cell & 63); }
+    static void reset(std::vector<Word>& bits, int cell) { bits[(std::size_t)(cell >> 6)] &= ~((Word)1 << (cell & 63)); }
+};
+
+template <int W, int H>
+class Board : public Bitboard {
+    static_assert(W > 0 && H > 0 && W * H <= (1 << 24), "Board<0, 0> is the run-time sized board");
+
+public:
+    static constexpr int AREA = W * H;
+    static constexpr int WORDS = (AREA + 63) / 64;
+
+    static constexpr int width() { return W; }
+    static constexpr int height() { return H; }
+    static constexpr int area() { return AREA; }
+    static constexpr int words() { return WORDS; }
+    static constexpr bool isSpecialised() { return true; }
+
+    static constexpr bool inside(int x, int y) { return x >= 0 && y >= 0 && x < W && y < H; }
+    static constexpr int index(int x, int y) { return y * W + x; }
+    static constexpr Cell cellOf(int cell) { return {cell % W, cell / W}; }
+    // slot in [0, 2 * area)
+    static constexpr int wrap(int slot) { return slot % AREA; }
+    // -1 off the board
+    static int neighbour(int cell, int dir) {
+        return (OPEN[(std::size_t)cell] >> dir & 1) ? cell + STEP[dir] : -1;
+    }
+
+private:
+    static constexpr int STEP[4] = {-W, W, -1, 1};
+
+    // Bit d set when the cell has a neighbour in direction d
+    static constexpr std::array<std::uint8_t, AREA> makeOpen() {
+        std::array<std::uint8_t, AREA> open{};
+        for (int y = 0; y < H; ++y) {
+            for (int x = 0; x < W; ++x) {
+                open[(std::size_t)(y * W + x)] = (std::uint8_t)((y > 0 ? 1 : 0) | (y + 1 < H ? 2 : 0)
+                                                                 | (x > 0 ? 4 : 0) | (x + 1 < W ? 8 : 0));
+            }
+        }
+        return open;
+    }
+    static constexpr std::array<std::uint8_t, AREA> OPEN = makeOpen();
+};
+
+// The generic fallback
+template <>
+class Board<0, 0> : public Bitboard {
+public:
+    Board(int width, int height) : w(width), h(height), cells(width * height), wordCount(wordsFor(width * height)) {}
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int area() const { return cells; }
+    int words() const { return wordCount; }
+    static constexpr bool isSpecialised() { return false; }
+
+    bool inside(int x, int y) const { return x >= 0 && y >= 0 && x < w && y < h; }
+    int index(int x, int y) const { return y * w + x; }
+    Cell cellOf(int cell) const { return {cell % w, cell / w}; }
+    int wrap(int slot) const { return slot % cells; }
+    int neighbour(int cell, int dir) const {
+        int x = cell % w, y = cell / w;
+        switch (dir) {
+            case 0: return y > 0 ? cell - w : -1;
+            case 1: return y + 1 < h ? cell + w : -1;
+            case 2: return x > 0 ? cell - 1 : -1;
+            default: return x + 1 < w ? cell + 1 : -1;
+        }
+    }
+
+private:
+    int w;
+    int h;
+    int cells;
+    int wordCount;
+};
+
+using DynamicBoard = Board<0, 0>;
+
+// Calls f(board) with the specialisation for width x height if there is one
+// (the game's 60x60 and the sizes training and the benchmarks use), else
+// with a DynamicBoard. f must return the same type for every board.
+template <typename F>
+auto withBoard(int width, int height, F&& f) {
+    if (width == height) {
+        switch (width) {
+            case 20: return f(Board<20, 20>());
+            case 60: return f(Board<60, 60>());
+            case 128: return f(Board<128, 128>());
+            default: break;
+        }
+    }
+    return f(DynamicBoard(width, height));
+}
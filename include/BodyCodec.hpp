@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Common.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compact bodies for saved games and spectator keyframes. A snake body is a
+// chain: each segment is one step from the one before it, except the copies
+// of the tail that grow() leaves for growth still to come. So it is stored as
+// the head, the number of tail copies and two bits per step (up, down, left,
+// right), 32 times smaller than Cells. Anything that is not such a chain is
+// stored as PackedCells instead.
+//
+// Layout, little endian: u32 segments, u8 format, then
+//   CHAIN: i16 head x, i16 head y, u32 tail copies, steps four to a byte
+//          (first step in the low bits)
+//   CELLS: i16 x, i16 y per segment
+namespace bodycodec {
+
+enum Format : std::uint8_t { CHAIN = 0, CELLS = 1 };
+
+// Appends body to out
+void encode(const std::vector<Cell>& body, std::vector<std::uint8_t>& out);
+void encode(const PackedBody& body, std::vector<std::uint8_t>& out);
+// Reads one body from the front of data; returns the bytes it took, 0 when
+// they do not hold a whole body or it has more than maxSegments (body is then
+// left empty). The limit comes from the caller because tail copies take no
+// bytes, so the data alone cannot bound them.
+std::size_t decode(const std::uint8_t* data, std::size_t size, std::size_t maxSegments, std::vector<Cell>& body);
+
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include "Barrier.hpp"
+#include "NetProtocol.hpp"
+#include "SpscQueue.hpp"
+#include "WorldSnapshot.hpp"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Live spectator stream of a local game: SNAKE_BROADCAST=[port] publishes it,
+// SNAKE_WATCH=host[:port] watches it (Spectator).
+//
+// The simulation thread records what each tick changed: the move (direction,
+// regrow step, growth from a fruit), a portal jump with the seed its new map
+// was generated from, fruits added and removed, portals, score, state and the
+// HUD timers. That record, usually a dozen bytes, goes into a lock-free ring.
+// Every KEYFRAME_TICKS, and whenever something can't be told as a change (a
+// new game, a loaded session), the whole state is written as a keyframe. The
+// cost on the simulation thread does not depend on how many people watch,
+// and nothing there ever blocks.
+//
+// The Broadcaster thread drains the ring and sends every record to every
+// viewer. New viewers get the newest keyframe plus the records since. Records
+// carry their tick: a gap means a datagram was lost, and the viewer asks again
+// and waits for a keyframe.
+namespace cast {
+
+const unsigned short DEFAULT_PORT = 47810;
+const int KEYFRAME_TICKS = 50; // 4 s at the default tick
+const int RECORD_BYTES = 120;  // larger ticks are sent as keyframes instead
+
+// A spectator's copy of the game
+struct Replica {
+    std::uint32_t tick = 0;
+    bool synced = false;
+    int gridWidth = 0;
+    int gridHeight = 0;
+    GameState state = GameState::Menu;
+    bool showCountdown = false;
+    bool portalShowCountdown = false;
+    int countdownNumber = 3;
+    int score = 0;
+    float elapsed = 0.f;
+    float fruitCountdown = 0.f;
+    std::vector<Cell> body; // head first
+    std::vector<Fruit> fruits;
+    Portal portalEntrance;
+    Portal portalExit;
+    Barrier walls{0, 0, 0, 0}; // bounds matter: portal jumps regenerate the map
+};
+
+// How the snake moved during one tick; the other fields travel as the new
+// values in a Replica
+struct TickMotion {
+    bool moved = false;
+    Cell direction{0, -1};
+    bool regrow = false;    // grew before moving (portal exit)
+    int grown = 0;          // tail cells added by a fruit after moving
+    bool teleport = false;
+    std::uint32_t mapSeed = 0;
+    Cell exit{0, 0};
+    int exitLength = 0;
+    bool exitColumn = false; // Barrier::portalSafeArea
+};
+
+enum ChangeFlags : std::uint8_t {
+    MOVED = 1, REGROW = 2, TELEPORT = 4, STATE = 8, SCORE = 16, FRUITS = 32, PORTALS = 64
+};
+
+void writeKeyframe(net::ByteWriter& w, const Replica& r);
+bool readKeyframe(net::ByteReader& r, Replica& out);
+// One tick: `motion`, then whatever of `now` differs from `before`
+void writeChange(net::ByteWriter& w, std::uint32_t tick, const TickMotion& motion, const Replica& before, const Replica& now);
+// False on a gap or a malformed record; the replica is then out of sync
+// until the next keyframe
+bool applyChange(net::ByteReader& r, Replica& replica);
+
+// Tick number at the front of a keyframe or change body
+std::uint32_t tickOf(const std::uint8_t* data, std::size_t size);
+
+}
+
+class Broadcaster {
+public:
+    explicit Broadcaster(unsigned short port = cast::DEFAULT_PORT);
+    ~Broadcaster();
+
+    bool start();
+    void stop();
+
+    // --- Simulation thread; neither call blocks ---
+    // False when the ring is full: the stream has a gap, send a keyframe
+    bool pushChange(const std::vector<std::uint8_t>& change);
+    // False while the previous keyframe is still being taken (try next tick).
+    // On success the buffers are swapped, so `keyframe` comes back with the
+    // old capacity and refilling it does not allocate.
+    bool offerKeyframe(std::vector<std::uint8_t>& keyframe);
+
+    int getViewerCount() const { return viewerCount.load(std::memory_order_relaxed); }
+
+private:
+    struct Record {
+        std::uint16_t size;
+        std::uint8_t data[cast::RECORD_BYTES];
+    };
+
+    struct Viewer {
+        sf::IpAddress address;
+        unsigned short port;
+        float lastHeard;
+    };
+
+    void run();
+    void receiveAll(float now);
+    void takeKeyframe();
+    void sendCatchUp(const Viewer& v);
+    void sendRecord(const Record& record);
+    void send(const Viewer& v, net::MsgType type, const std::uint8_t* data, std::size_t size);
+
+    unsigned short port;
+    sf::UdpSocket socket;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<int> viewerCount{0};
+
+    SpscQueue<Record, 256> ring;
+    std::mutex offerMutex;
+    std::vector<std::uint8_t> offered;
+    bool hasOffer = false;
+
+    // Broadcaster thread only
+    std::vector<std::uint8_t> keyframe; // newest, empty until the first one
+    std::deque<Record> recent;          // newest records, for catching up
+    std::vector<Viewer> viewers;
+    std::vector<std::uint8_t> packet;
+    std::vector<std::uint8_t> receiveBuffer;
+    sf::Clock clock;
+};
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
 struct Cell {
     int x;
     int y;
@@ -8,3 +14,97 @@ struct Cell {
         return x == o.x && y == o.y; 
     }
 };
+
+// A Cell in 4 bytes, for cells kept in bulk (bodies, saved games).
+// Boards stay far below 32768 cells a side. Code works with Cell and
+// converts at the edges: PackedCell::of(cell), packed.cell().
+struct PackedCell {
+    std::int16_t x;
+    std::int16_t y;
+
+    static PackedCell of(const Cell& c) { return {(std::int16_t)c.x, (std::int16_t)c.y}; }
+    Cell cell() const { return {x, y}; }
+    bool operator==(const PackedCell& o) const { return x == o.x && y == o.y; }
+};
+
+// A snake body as PackedCells, head first, read back as Cells. Like Arena's
+// pooled bodies it is a ring (a power of two long, so an index is a mask): a
+// tick pushes the head and pops the tail in O(1) and nothing else moves.
+class PackedBody {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Cell;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Cell;
+
+        const_iterator(const PackedBody* body, std::size_t i) : body(body), i(i) {}
+        Cell operator*() const { return (*body)[i]; }
+        const_iterator& operator++() { ++i; return *this; }
+        bool operator==(const const_iterator& o) const { return i == o.i; }
+        bool operator!=(const const_iterator& o) const { return i != o.i; }
+
+    private:
+        const PackedBody* body;
+        std::size_t i;
+    };
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    Cell operator[](std::size_t i) const { return ring[(first + i) & (ring.size() - 1)].cell(); }
+    Cell front() const { return (*this)[0]; }
+    Cell back() const { return (*this)[count - 1]; }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count); }
+
+    void pushFront(const Cell& c) {
+        if (count == ring.size()) grow();
+        first = (first - 1) & (ring.size() - 1);
+        ring[first] = PackedCell::of(c);
+        count++;
+    }
+    void pushBack(const Cell& c) {
+        if (count == ring.size()) grow();
+        ring[(first + count) & (ring.size() - 1)] = PackedCell::of(c);
+        count++;
+    }
+    void popBack() { count--; }
+    // Keeps the first n segments
+    void truncate(std::size_t n) {
+        if (n < count) count = n;
+    }
+    void clear() { first = count = 0; }
+    void assign(const std::vector<Cell>& body) {
+        clear();
+        for (const Cell& c : body) pushBack(c);
+    }
+    // Into a Cell vector, reusing its storage: the ring's two runs in turn
+    void copyTo(std::vector<Cell>& out) const {
+        out.resize(count);
+        std::size_t run = std::min(count, ring.size() - first);
+        widen(ring.data() + first, run, out.data());
+        widen(ring.data(), count - run, out.data() + run);
+    }
+
+private:
+    // n cells of one run of the ring
+    static void widen(const PackedCell* from, std::size_t n, Cell* to) {
+        for (std::size_t i = 0; i < n; ++i) {
+            to[i].x = from[i].x;
+            to[i].y = from[i].y;
+        }
+    }
+    // Doubles the ring, unwrapped so the head is at 0
+    void grow() {
+        std::vector<PackedCell> bigger(ring.empty() ? 8 : ring.size() * 2);
+        for (std::size_t i = 0; i < count; ++i) bigger[i] = ring[(first + i) & (ring.size() - 1)];
+        ring.swap(bigger);
+        first = 0;
+    }
+
+    std::vector<PackedCell> ring;
+    std::size_t first = 0;  // the head's slot
+    std::size_t count = 0;
+};
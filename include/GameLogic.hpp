@@ -4,34 +4,57 @@
 #include "Snake.hpp"
 #include "Barrier.hpp"
 #include "SnakeRenderer.hpp"
+#include "SoundEffects.hpp"
+#include "Leaderboard.hpp"
+#include "WorldSnapshot.hpp"
+#include "TripleBuffer.hpp"
+#include "SpscQueue.hpp"
+#include "Broadcast.hpp"
+#include "HamiltonSolver.hpp"
+#include "SpawnMap.hpp"
+#include "TrapDetector.hpp"
+#include <atomic>
 #include <random>
 #include <SFML/Audio.hpp>
 #include <vector>
 #include <string>
+#include <memory>
 
-struct Fruit {
-    enum class Type { Gomu, Mera, Ope } type;
-    int x;
-    int y;
-    float spawnTime; // seconds since game start
-    float duration; // 0 = permanent until eaten
-
-    bool operator==(const Cell &c) const {
-        return x == c.x && y == c.y;
-    }
+// Input handed from the render thread to the simulation thread
+struct InputCommand {
+    enum class Type { Event, Steer } type;
+    sf::Event event; // Type::Event: window/keyboard event
+    int dx, dy;      // Type::Steer: direction key held this frame
 };
 
+// The game runs on two threads. The simulation thread (runSimulation) owns
+// the rules state: snake, walls, fruits, portals, timers, leaderboard. The
+// render thread only sees immutable WorldSnapshots published through a
+// triple buffer and sends input back through a lock-free queue, so a slow
+// frame never delays a tick and a slow tick never drops a frame.
 class GameLogic {
-    sf::Texture portalTexture;
+    // tools/Benchmark.cpp drives private pieces (spawning, portal search) directly
+    friend struct BenchAccess;
+    std::shared_ptr<sf::Texture> portalTexture;
 public:
     GameLogic(int gridWidth, int gridHeight, int blockSize);
-    
+
+    // --- Simulation thread ---
+    // Fixed-rate tick loop; returns once `running` is cleared and the input
+    // queue has been drained (so a final close event can still suspend).
+    void runSimulation(float tickSeconds, const std::atomic<bool>& running);
     void update();
-    void handleInput();
-    void draw(sf::RenderWindow& window);
+    void applyInput(const InputCommand& cmd);
     // event processing for text input (high-score name entry)
     void processEvent(const sf::Event& event);
+    void publishSnapshot();
+    // Spectator stream (SNAKE_BROADCAST); set before runSimulation starts
+    void setBroadcaster(Broadcaster* b) { broadcaster = b; }
+    // Hamiltonian-cycle autopilot (SNAKE_AUTOPILOT) for endurance runs and
+    // long-snake profiling; set before runSimulation starts
+    void setAutopilot(bool on);
     
+
     bool isGameOver() const { return gameOver; }
     int getScore() const { return score; }
     
@@ -40,18 +63,55 @@ public:
     void togglePause();
     void goToMenu();
     void startGame();
-    void toggleTailRotate();
     bool canRestart() const { return !awaitingNameEntry; }
     bool isPaused() const { return state == State::Paused; }
     bool isMenu() const { return state == State::Menu; }
+
+    // --- Render thread ---
+    // Queue an event for the simulation; false if the queue is full
+    bool postEvent(const sf::Event& event);
+    // Steering keys go to the simulation; sprite scale is applied here
+    void handleInput();
+    // Take the newest snapshot if there is one; true when it changed the view
+    bool consumeSnapshot();
+    void draw(sf::RenderTarget& window);
+    void toggleTailRotate();
+    void startMusic();
+    // Start sound effects queued by update(); call from the render thread
+    void pumpAudio() { sfx.pump(); }
+    // Snake moving with no countdown or overlay screen up (allocation check)
+    bool isInPlay() const;
+
+    // Idle-aware rendering: Menu, Paused and a finished GameOver screen are
+    // static, so they are only redrawn when something visible changes.
+    bool isIdleScreen() const;
+    bool needsRedraw() const;
+    void invalidate() { redrawRequested = true; inputIdleClock.restart(); }
+    sf::Time timeUntilNextRedraw() const;
+
+    // Save states: binary snapshot of a running or paused session
+    static constexpr const char* SESSION_FILE = "session.sav";
+    bool hasSession() const { return state == State::Playing || state == State::Paused; }
+    void captureSnapshot(std::vector<unsigned char>& out) const;
+    bool restoreSnapshot(const std::vector<unsigned char>& in);
+    bool suspendToFile(const std::string& path);
+    // consume: delete the file once loaded (menu "continue")
+    bool resumeFromFile(const std::string& path, bool consume);
+    bool hasSuspendedSession() const { return suspendedSession; }
     
 private:
+    using State = GameState;
+
     Snake snake;
     Barrier barriers;
+    Barrier wallView; // render-side copy of the walls, textured
     // support multiple fruits on the board
     std::vector<Fruit> fruits;
     SnakeRenderer renderer;
     sf::Music music;
+    // update() only queues effects here; the render thread plays them
+    SoundEffects sfx;
+    int lastCountdownSound = -1;
     
     int gridWidth;
     int gridHeight;
@@ -60,41 +120,53 @@ private:
     bool gameOver;
     
     std::mt19937 rng;
+    // Open areas of the map with the body's cells set aside, followed tick by tick
+    SpawnMap spawnMap;
+    unsigned spawnMapVersion = ~0u; // none built yet
+    void followSpawnMap();
+    // Free space the head can reach, followed tick by tick
+    TrapDetector traps;
+    unsigned trapsWallsVersion = 0;
+    bool trapped = false;
+    void checkTrapped();
 
     void spawnFood();
+    // A random free cell in the snake's area of the map (fruit, portals)
+    bool randomOpenCell(Cell& out);
+    bool findPortalExit(int oldLen, int& ex, int& ey, std::vector<Cell>& safeArea);
     void spawnCheck(float nowSeconds);
     void removeExpired(float nowSeconds);
     void loadFruitTextures();
 
     
 
-    // high score persistence
-    void loadHighScore();
-    void saveHighScore();
-    int highScore = 0;
-    std::string highName = "Nobody";
+    // high score persistence (append-only log, written off the render thread)
+    Leaderboard leaderboard;
+    static const int LEADERBOARD_ENTRY_RANK = 10; // ask for a name when entering the top 10
+    bool qualifiesForLeaderboard(int s) const;
     std::string nameBuffer; // temporary buffer when entering name
     float lastSpawnCheck = 0.f;
     float spawnCheckInterval = 0.5f; // seconds
 
     bool awaitingNameEntry = false;
 
-    // fruit textures
-    sf::Texture texGomu;
-    sf::Texture texMera;
-    sf::Texture texOpe;
+    // fruit textures (shared through AssetManager)
+    std::shared_ptr<sf::Texture> texGomu;
+    std::shared_ptr<sf::Texture> texMera;
+    std::shared_ptr<sf::Texture> texOpe;
     // UI control key textures
-    sf::Texture texW;
-    sf::Texture texA;
-    sf::Texture texS;
-    sf::Texture texD;
-    sf::Texture texP;
+    std::shared_ptr<sf::Texture> texW;
+    std::shared_ptr<sf::Texture> texA;
+    std::shared_ptr<sf::Texture> texS;
+    std::shared_ptr<sf::Texture> texD;
+    std::shared_ptr<sf::Texture> texP;
     // UI
-    sf::Font uiFont;
-    sf::Font titleFont; // second font for title/pause
+    std::shared_ptr<sf::Font> uiFont;
+    std::shared_ptr<sf::Font> titleFont; // second font for title/pause
     sf::Text scoreText;
     sf::Text timerText;
     sf::Text fruitTimerText;
+    sf::Text trappedText;
     sf::Clock startClock;
     float elapsedPlaySeconds = 0.f; // time excluding paused
     float pausedAccumSeconds = 0.f;
@@ -107,7 +179,6 @@ private:
     float lastUpdateSeconds = 0.f;
 
     // Portal support
-    struct Portal { int x; int y; bool active = false; bool isExit = false; };
     Portal portalEntrance;
     Portal portalExit;
     // bool inPortalMode = false; // eliminado: ya no hay inmunidad tras portal
@@ -127,7 +198,6 @@ private:
     float portalRegrowAccum = 0.f;
     float portalRegrowInterval = 0.4f; // seconds between auto-grow steps
     int portalGraceTicks = 0;
-    enum class State { Menu, Playing, Paused, GameOver };
     State state = State::Menu;
     float spriteScale = 2.0f;
     
@@ -143,4 +213,53 @@ private:
     int animatedScore = 0;
     bool scoreAnimationDone = false;
     sf::Clock scoreAnimClock;
+    void advanceScoreAnimation();
+
+    // Thread hand-off
+    SpscQueue<InputCommand, 256> inputQueue;
+    TripleBuffer<WorldSnapshot> snapshots;
+    std::uint64_t revision = 1;          // sim: bumped on every visible change
+    std::uint64_t publishedRevision = 0; // sim
+    std::uint64_t viewRevision = 0;      // render: revision of snapshots.read()
+    unsigned viewWallsVersion = 0;       // render: walls copied into wallView
+    GameState viewState = GameState::Menu;
+    sf::Clock viewStateClock;            // render: time since the shown screen changed
+    sf::Clock animClock;                 // render: drives the waving titles
+
+    // Damage tracking for static screens
+    long idleFrameKey() const;
+    float idleAnimTime() const;
+    bool redrawRequested = true;
+    long lastDrawnKey = -1;
+    sf::Clock inputIdleClock;
+    float idleAnimHz = 20.f;      // title wave steps per second on static screens
+    float idleAnimTimeout = 30.f; // seconds without input before the wave settles
+
+    float currentPlaySeconds() const;
+    bool suspendedSession = false; // session.sav exists, offer "continue" in the menu
+
+    // Spectator stream: update() notes how the snake moved, recordCast()
+    // turns the tick into a change record or a keyframe (simulation thread)
+    Broadcaster* broadcaster = nullptr;
+    cast::TickMotion castMotion;
+    cast::Replica castSeen;    // what viewers have; body and walls only as of the last keyframe
+    cast::Replica castNow;
+    std::uint32_t castTick = 0;
+    int castSinceKeyframe = 0;
+    bool castBroken = true;    // no keyframe yet, or a record was lost
+    unsigned castWallsVersion = 0;
+    Cell castHead{0, 0};
+    std::size_t castLength = 0;
+    std::vector<std::uint8_t> castChange;
+    std::vector<std::uint8_t> castKeyframe;
+    void recordCast();
+
+    // Autopilot: steers along a Hamiltonian cycle of the current walls,
+    // rebuilt at each teleport while the portal countdown runs
+    std::unique_ptr<HamiltonSolver> autopilot;
+    unsigned autopilotWallsVersion = 0;
+    std::vector<std::uint8_t> autopilotBody; // visible segments, by cell
+    std::vector<Cell> autopilotGoals;
+    void rebuildAutopilot();
+    void steerAutopilot();
 };
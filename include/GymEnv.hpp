@@ -0,0 +1,212 @@
+#pragma once
+
+#include "Barrier.hpp"
+#include "Board.hpp"
+#include "SpawnMap.hpp"
+#include "TrapDetector.hpp"
+#include "WorldSnapshot.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Headless single-player environment for training agents, Gym style:
+// reset(seed), step(action), observation planes. No window, clock or assets:
+// one step is one game tick of `tickSeconds`.
+//
+// The rules are the game's: the same map generator and start position,
+// Gomu +1 / Mera +5 / Ope +10 with growth 1 / 2 / 3 and +5 / +10 / +15 s on
+// the fruit timer, Mera and Ope spawning on the 0.5 s check with their
+// lifetimes, a portal to a new map every 30 points, and game over on a wall,
+// on itself or when the fruit timer runs out. The reward of a step is the
+// points it scored; the step that ends the episode also gets the game's time
+// bonus (one point per second played). Countdowns are not simulated, and
+// after a portal jump the snake emerges from the exit one cell per step.
+//
+// Observation: PLANE_COUNT planes of gridWidth * gridHeight bytes, plane
+// major then row major (plane * area + y * gridWidth + x), 1 where the thing
+// is present. bindObservation() hands the environment a caller-owned buffer
+// (a numpy array, a tensor) that it then keeps current in place: each step
+// only touches the handful of cells that changed, nothing is copied.
+//
+// For search-based bots: getHash() is a Zobrist hash of the position, kept
+// up to date by the same cell changes that update the observation, and
+// saveState() / loadState() copy an episode in O(snake length) so a rollout
+// can start from the same position again and again.
+//
+// getReachableArea() / isTrapped() tell a bot when the snake has sealed
+// itself in. The first call after reset(), a portal or loadState() labels
+// the board; from then on each step updates it from the head and tail cells
+// alone, so rollouts that never ask pay nothing.
+class GymEnv {
+public:
+    enum Plane { PLANE_WALLS, PLANE_BODY, PLANE_HEAD, PLANE_GOMU, PLANE_MERA, PLANE_OPE, PLANE_PORTAL, PLANE_COUNT };
+    enum Action { ACTION_UP, ACTION_DOWN, ACTION_LEFT, ACTION_RIGHT }; // reversing is ignored, as in the game
+    enum class End { None, Wall, Self, FruitTimer };
+
+    struct Step {
+        float reward = 0.f;
+        bool done = false;
+        End end = End::None;
+    };
+
+    static const int MIN_SIDE = 16; // room for the map generator and the portal exit search
+
+    // splitmix64; 8 bytes of state, so saving an episode copies no mt19937
+    struct Random {
+        using result_type = std::uint32_t;
+        std::uint64_t state = 0;
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return 0xffffffffu; }
+        void seed(std::uint64_t s) { state = s; }
+        result_type operator()() { return (result_type)(mix(state += 0x9e3779b97f4a7c15ull) >> 32); }
+        static std::uint64_t mix(std::uint64_t z) {
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+    };
+
+    // Everything a step can change. The walls are shared with the
+    // environment, not copied; a state only loads into an environment of the
+    // size that saved it.
+    class State {
+        friend class GymEnv;
+        std::vector<int> body;   // cells, head first
+        std::vector<Fruit> fruits;
+        std::shared_ptr<const std::vector<Cell>> walls;
+        Portal entrance;
+        Portal exit;
+        Cell dir{0, -1};
+        int growPending = 0;
+        int emerging = 0;
+        int nextPortalScore = 30;
+        int score = 0;
+        float time = 0.f;
+        float fruitCountdown = 20.f;
+        float lastSpawnCheck = 0.f;
+        long steps = 0;
+        bool done = true;
+        End end = End::None;
+        Random rng;
+    };
+
+    GymEnv(int gridWidth = 60, int gridHeight = 60, float tickSeconds = 0.08f);
+
+    void reset(std::uint32_t seed);
+    Step step(int action);
+
+    // planes must hold observationSize() bytes and outlive the binding;
+    // nullptr unbinds
+    void bindObservation(std::uint8_t* planes);
+    // One-off full write into any buffer of observationSize() bytes
+    void writeObservation(std::uint8_t* planes) const;
+    std::size_t observationSize() const { return (std::size_t)PLANE_COUNT * (std::size_t)area; }
+
+    int getGridWidth() const { return gridWidth; }
+    int getGridHeight() const { return gridHeight; }
+    int getScore() const { return score; }
+    int getLength() const { return length + growPending; }
+    long getSteps() const { return steps; }
+    float getFruitCountdown() const { return fruitCountdown; }
+    bool isDone() const { return done; }
+    End getEnd() const { return end; }
+    Cell getHead() const { return cellOf(ring[(std::size_t)headSlot]); }
+    Cell getTail() const { return cellOf(ring[(std::size_t)((headSlot + length - 1) % area)]); }
+    Cell getDirection() const { return dir; }
+    int getBodyLength() const { return length; }      // segments on the board
+    int getGrowPending() const { return growPending; }
+    const std::vector<Cell>& getWalls() const { return barrier.getWalls(); }
+    unsigned getMapVersion() const { return barrier.getVersion(); }
+    const std::vector<Fruit>& getFruits() const { return fruits; }
+    const Portal& getEntrance() const { return entrance; }
+    // No wall or body there (for scripted baselines)
+    bool isFree(int x, int y) const;
+    // step() runs on a Board<W, H> specialisation when there is one for
+    // this size; on forces the run-time sized fallback (benchmarks, checks)
+    void useGenericBoard(bool on) { genericBoard = on; }
+
+    // Reuses out's buffers, so saving into the same State does not allocate
+    void saveState(State& out) const;
+    void loadState(const State& in);
+    // Walls, body, head, fruit, portal, heading, growth to come and points to
+    // the next portal. Clocks are left out: positions that differ only in
+    // time played or the fruit timer hash alike.
+    std::uint64_t getHash() const;
+
+    // Free cells the head can reach
+    int getReachableArea();
+    // Less room than the body needs and the tail out of reach
+    bool isTrapped();
+
+private:
+    int index(int x, int y) const { return y * gridWidth + x; }
+    Cell cellOf(int i) const { return {i % gridWidth, i / gridWidth}; }
+    // Every mark outside the walls plane flips the cell, so it flips the
+    // cell's key in the hash too
+    void mark(Plane plane, int cell, std::uint8_t value) {
+        if (plane != PLANE_WALLS) boardHash ^= zobrist(plane, cell);
+        if (obs) obs[(std::size_t)plane * (std::size_t)area + (std::size_t)cell] = value;
+    }
+    // The key of one feature is a hash of it rather than a table entry, so
+    // environments of one size agree on keys without sharing anything
+    static std::uint64_t zobrist(int feature, int value) {
+        return Random::mix(((std::uint64_t)(std::uint32_t)feature << 32 | (std::uint32_t)value) + 0x9e3779b97f4a7c15ull);
+    }
+    template <class B> Step stepOn(const B& b, int action);
+    template <class B> void pushHead(const B& b, int cell);
+    template <class B> void popTail(const B& b);
+    void clearBody();
+    void followTraps();
+    void loadWalls();
+    void applyWalls();
+    void teleport();
+    bool randomFreeCell(int& cell);
+    void addFruit(Fruit::Type type, float duration);
+    void placeFruit(const Fruit& f);
+    void removeFruit(std::size_t i);
+    void spawnGomu();
+    void spawnCheck();
+    void finish(End why, Step& result);
+
+    int gridWidth;
+    int gridHeight;
+    int area;
+    float tickSeconds;
+    Barrier barrier;
+    DynamicBoard board;
+    bool genericBoard = false;
+    std::shared_ptr<const std::vector<Cell>> walls;  // barrier's walls, shared with saved states
+    SpawnMap spawnMap;
+    TrapDetector traps;
+    bool trapsLive = false;             // traps follows pushHead / popTail
+    Random rng;
+    std::uint8_t* obs = nullptr;
+    std::uint64_t wallHash = 0;
+    std::uint64_t boardHash = 0;                      // everything mark() touches
+
+    std::vector<Bitboard::Word> wallBits;
+    std::vector<Bitboard::Word> bodyBits;
+    std::vector<std::uint8_t> fruitAt;  // Fruit::Type + 1, 0 = none
+    std::vector<int> ring;              // body cells, head at headSlot, tail behind it
+    int headSlot = 0;
+    int length = 0;
+    int growPending = 0;
+    Cell dir{0, -1};
+
+    std::vector<Fruit> fruits;
+    Portal entrance;
+    Portal exit;
+    int emerging = 0;                   // cells still inside the exit portal
+    int nextPortalScore = 30;
+
+    float time = 0.f;
+    float fruitCountdown = 20.f;
+    float lastSpawnCheck = 0.f;
+    int score = 0;
+    long steps = 0;
+    bool done = true;
+    End end = End::None;
+    std::vector<Cell> scratch;
+};
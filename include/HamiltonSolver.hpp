@@ -0,0 +1,140 @@
+#pragma once
+
+#include "Common.hpp"
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Hamiltonian cycle over the free cells of a wall layout, plus an autopilot
+// that rides it (SNAKE_AUTOPILOT, the endurance benchmark).
+//
+// The cycle comes from a spanning forest of the 2x2 blocks that are entirely
+// free: walking around each tree visits every cell of its blocks. Cells the
+// blocks miss (next to walls) are spliced in afterwards by replacing a cycle
+// edge with a detour through them, and neighbouring cycles are merged where
+// they run side by side. On a checkerboard colouring a cycle alternates
+// colours, so a region with more cells of one colour, or a dead-end cell,
+// has no Hamiltonian cycle at all: that is reported as Impossible and the
+// largest cycle found is still usable.
+//
+// build() keeps the previous forest: tree edges between blocks that are still
+// free survive, only the blocks whose shape changed are re-linked, and the
+// cells that fall outside the cycle are the only ones searched again.
+//
+// The autopilot keeps the body in cycle order (tail ... head), so every cycle
+// cell between the head and the tail is free. A shortcut lands at most
+// `ahead - (length + growPending + one fruit)` cells along, so the head stays
+// behind the tail by a whole body length plus the growth to come. The cells
+// it skips are cleared once the tail has travelled one body length; closing
+// the gap before then would need more than a body length of new growth
+// during that one body length of travel. Once
+// length + growPending passes half the cycle there are no more shortcuts,
+// and the snake rides the cycle to a full board. Fruit off the cycle is
+// reached through a detour that rejoins the cycle under the same rule.
+class HamiltonSolver {
+public:
+    enum class Status { None, Complete, Partial, Impossible };
+
+    // What the autopilot needs to know about the snake this tick
+    struct SnakeState {
+        Cell head;
+        Cell tail;            // last segment on the board
+        Cell direction;       // current heading; the reverse move is never chosen
+        int length = 0;       // segments on the board
+        int growPending = 0;  // moves the tail will stay put
+    };
+
+    HamiltonSolver(int gridWidth, int gridHeight);
+
+    // (Re)build for this wall set over the cells reachable from `start`;
+    // also restarts the autopilot
+    Status build(const std::vector<Cell>& walls, const Cell& start);
+
+    Status getStatus() const { return status; }
+    int getCycleLength() const { return cycleLength; }
+    int getFreeCells() const { return freeCells; }   // cells reachable from start
+    bool onCycle(const Cell& c) const { return inGrid(c) && order[(std::size_t)index(c)] >= 0; }
+    // Next cell along the cycle in the autopilot's direction
+    Cell successor(const Cell& c) const { return cellOf(follow(index(c))); }
+
+    // Where the head should go next. goals are fruit cells, or the portal
+    // entrance when `teleport` (entering it ends the path). isBody reports
+    // cells the snake occupies.
+    Cell nextMove(const SnakeState& snake, const std::vector<Cell>& goals, bool teleport,
+                  const std::function<bool(const Cell&)>& isBody);
+
+private:
+    enum Side : std::uint8_t { UP = 1, DOWN = 2, LEFT = 4, RIGHT = 8 };
+
+    int index(const Cell& c) const { return c.y * gridWidth + c.x; }
+    Cell cellOf(int i) const { return {i % gridWidth, i / gridWidth}; }
+    bool inGrid(const Cell& c) const { return c.x >= 0 && c.y >= 0 && c.x < gridWidth && c.y < gridHeight; }
+    int blockOf(int cell) const;
+    int findSet(int block);
+    bool unite(int a, int b);
+
+    // true when the region provably has no Hamiltonian cycle
+    bool floodRegion(const Cell& start);
+    void chooseOrigin();
+    void buildForest(const Cell& start);
+    void resetCell(int cell);
+    void linkCell(int cell, int from, int to);
+    void markTouched(int cell);
+    bool absorb(int cell);
+    int mergeCycles();
+    void walkMainCycle();
+
+    // Autopilot
+    int follow(int cell) const { return forward ? nextOf[(std::size_t)cell] : prevOf[(std::size_t)cell]; }
+    int distance(int from, int to) const;
+    int jumpLimit(int ahead, const SnakeState& snake) const;
+    bool planDetour(int head, int gap, const SnakeState& snake, int goal, bool teleport,
+                    const std::function<bool(const Cell&)>& isBody, int& entry, std::vector<int>& path);
+    int approachCycle(int head, int reverse, const std::function<bool(const Cell&)>& isBody);
+    Cell anyFreeNeighbour(const SnakeState& snake, int reverse, const std::function<bool(const Cell&)>& isBody) const;
+
+    int gridWidth;
+    int gridHeight;
+    int area;
+    int originX = -1;             // block grid alignment, picked on the first build
+    int originY = 0;
+    int blocksW = 0;
+    int blocksH = 0;
+
+    std::vector<std::uint8_t> wall;
+    std::vector<std::uint8_t> region;     // reachable from the start cell
+    std::vector<std::uint8_t> blockFull;  // all four cells in the region
+    std::vector<std::uint8_t> blockOpen;  // Side bits: tree edges to neighbouring blocks
+    std::vector<int> blockSet;            // union-find over blocks: one set per cycle
+    std::vector<int> setCells;            // cycle length per set root
+    std::vector<int> links;               // two cycle neighbours per cell, -1 = off every cycle
+    std::vector<int> anchor;              // a block of the cell's cycle
+    std::vector<std::uint8_t> touched;    // links differ from the block's own pattern
+    std::vector<int> touchedCells;
+    std::vector<int> uncovered;
+
+    std::vector<int> order;               // position on the main cycle, -1 = off it
+    std::vector<int> nextOf;
+    std::vector<int> prevOf;
+    int cycleLength = 0;
+    int freeCells = 0;
+    Status status = Status::None;
+
+    // BFS scratch; stamp avoids clearing between searches
+    std::vector<int> visit;
+    std::vector<int> parent;
+    std::vector<int> queue;
+    std::vector<std::pair<int, int>> doorScratch;
+    std::vector<int> candidate;
+    int stamp = 0;
+
+    // Autopilot state, reset by build()
+    bool forward = true;
+    bool oriented = false;
+    int plannedSteps = 0;         // moves since the body was last out of cycle order
+    int rejoin = -1;              // where the head last came back onto the cycle
+    std::vector<int> stretch;     // cells of the last off-cycle run
+    std::vector<int> detour;      // committed off-cycle path, ends on the cycle or the goal
+    std::size_t detourStep = 0;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing task scheduler shared by everything that wants to run in
+// parallel (map generation, AI, batch simulation), so no subsystem has to
+// start threads of its own.
+//
+//   auto a = jobs.submit([&] { buildLeft(); });
+//   auto b = jobs.submit([&] { buildRight(); });
+//   auto c = jobs.submit([&] { merge(); }, {a, b}); // runs after a and b
+//   jobs.wait(c);
+//
+// Every worker owns a deque: it pushes and pops its own jobs at the back and
+// idle workers steal from the front of the others. Jobs submitted from
+// outside the pool (render or simulation thread) go to a shared injection
+// queue. A thread blocked in wait() or parallelFor() runs queued jobs instead
+// of sleeping, so waiting from inside a job never deadlocks.
+class JobSystem {
+public:
+    struct Job;
+    using Handle = std::shared_ptr<Job>;
+
+    static JobSystem& instance();
+    ~JobSystem();
+
+    // Queue fn; it starts once every job in `after` has finished
+    Handle submit(std::function<void()> fn, std::initializer_list<Handle> after = {});
+    // Continuation: fn runs when `job` has finished
+    Handle then(const Handle& job, std::function<void()> fn) { return submit(std::move(fn), {job}); }
+    // Help with queued work until `job` has finished
+    void wait(const Handle& job);
+    static bool isDone(const Handle& job);
+
+    // body(first, last) over [begin, end) in chunks of `grain` indices; the
+    // caller runs chunks too and returns when all of them are done
+    void parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body);
+
+    int workerCount() const { return (int)workers.size(); }
+
+private:
+    JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    struct Queue {
+        std::mutex lock;
+        std::deque<Handle> jobs;
+    };
+
+    void enqueue(Handle job);
+    Handle findJob();
+    void execute(const Handle& job);
+    void workerLoop(int index);
+
+    std::vector<std::unique_ptr<Queue>> queues; // one per worker, the last one is the injection queue
+    std::vector<std::thread> workers;
+    std::atomic<int> queued{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<bool> stopping{false};
+};
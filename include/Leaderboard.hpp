@@ -0,0 +1,74 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Persistent top-N leaderboard.
+// Scores are appended to a record log (leaderboard.log), one checksummed line
+// per entry, so a crash mid-write only loses the torn last line. Every so often
+// the log is compacted into leaderboard.dat, written to a temp file and renamed
+// over the old one. clear() writes a new empty snapshot; if that fails, a
+// tombstone line in the log drops every record before it. All disk work happens on a background thread: submit() and
+// clear() only queue a request, and queries read the in-memory table.
+class Leaderboard {
+public:
+    struct Record {
+        std::uint64_t seq;   // monotonically increasing id, used to skip replayed log lines
+        int score;
+        std::int64_t time;   // unix seconds
+        std::string name;
+    };
+
+    explicit Leaderboard(const std::string& basePath = "leaderboard", std::size_t capacity = 100);
+    ~Leaderboard();
+
+    // Add a score; returns its 1-based rank
+    int submit(int score, const std::string& name);
+    // Forget every record (the "erase all data" shortcut)
+    void clear();
+
+    std::vector<Record> top(std::size_t n) const;
+    // 1-based position a score would take (ties rank below existing records)
+    int rankOf(int score) const;
+    bool empty() const { return records.empty(); }
+    int bestScore() const { return records.empty() ? 0 : records.front().score; }
+    std::string bestName() const { return records.empty() ? std::string("Nobody") : records.front().name; }
+
+    // Block until queued writes are on disk (used at shutdown and by tools)
+    void flush();
+
+private:
+    void load();
+    void importLegacyHighScore();
+    void insertSorted(const Record& r);
+    void writerLoop();
+    // A clearSeq writes a tombstone before the batch
+    bool appendToLog(const std::vector<Record>& batch, std::uint64_t clearSeq = 0);
+    bool compact(const std::vector<Record>& snapshot, std::uint64_t lastSeq, const std::vector<Record>& appended);
+
+    std::string logPath, dataPath, tmpPath;
+    std::size_t capacity;
+    std::vector<Record> records; // sorted by score desc, then seq asc; simulation thread only
+    std::uint64_t nextSeq = 1;
+    std::size_t appendsSinceCompact = 0;
+
+    // Hand-off to the writer thread
+    struct Pending {
+        std::vector<Record> appended;
+        bool compactRequested = false;
+        std::vector<Record> snapshot;
+        std::uint64_t snapshotSeq = 0;
+        std::uint64_t clearSeq = 0;    // clear() since the last batch: its tombstone seq
+    };
+    Pending pending;
+    bool writerBusy = false;
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::thread writer;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Simulated players for load-testing RoomServer over loopback
+// (SnakeServer --rooms N --load M). Each client has its own UDP socket, joins
+// a room round-robin and then behaves like NetClient: one input per tick with
+// an occasional random turn, acknowledging the newest snapshot so the server
+// keeps sending deltas. Snapshots are counted, not decoded. Linux only.
+class LoadGenerator {
+public:
+    struct Stats {
+        int joined = 0;
+        int refused = 0;               // got Full
+        std::uint64_t snapshots = 0;   // since the previous call
+        std::uint64_t bytes = 0;
+    };
+
+    LoadGenerator(unsigned short port, int clients, int rooms, float tickSeconds);
+    ~LoadGenerator();
+
+    bool start();
+    void stop();
+    Stats takeStats();
+    int getClientCount() const { return (int)clients.size(); }
+
+private:
+    struct SimClient {
+        int fd = -1;
+        std::uint16_t room = 0;
+        bool joined = false;
+        bool refused = false;
+        std::uint32_t latestTick = 0;
+        std::uint32_t seq = 0;
+        std::int8_t dx = 0, dy = -1;
+        std::uint32_t rng = 1;
+        std::uint64_t nextSendMs = 0;
+    };
+
+    void run();
+    void receive(SimClient& c);
+    void sendNext(SimClient& c, std::uint64_t now);
+
+    unsigned short port;
+    int rooms;
+    float tickSeconds;
+    int requested;
+    std::vector<SimClient> clients;
+    int epollFd = -1;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<int> joined{0};
+    std::atomic<int> refused{0};
+    std::atomic<std::uint64_t> snapshots{0};
+    std::atomic<std::uint64_t> bytes{0};
+    std::vector<std::uint8_t> packet;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+// Asynchronous logger for the game thread.
+//
+//   LOG_DEBUG("Teleported to exit ({},{}) oldLen={}", ex, ey, oldLen);
+//
+// A call copies the format pointer and up to LOG_MAX_ARGS numbers / string
+// literals into the calling thread's lock-free ring; the writer thread
+// started by Log::start() formats and prints them ("{}" placeholders).
+// Nothing is formatted or flushed on the caller's thread, and a full ring
+// drops the record instead of blocking.
+//
+// Levels below SNAKE_LOG_LEVEL are compiled out (0 trace .. 4 error, default
+// debug); the runtime threshold defaults to info and is read from SNAKE_LOG
+// (trace, debug, info, warn, error). String arguments must outlive the write,
+// so pass literals or other static strings only.
+
+enum class LogLevel : std::uint8_t { Trace = 0, Debug, Info, Warn, Error };
+
+#ifndef SNAKE_LOG_LEVEL
+#define SNAKE_LOG_LEVEL 1
+#endif
+
+const int LOG_MAX_ARGS = 6;
+
+struct LogArg {
+    enum class Type : std::uint8_t { Int, Uint, Double, Str } type;
+    union {
+        long long i;
+        unsigned long long u;
+        double d;
+        const char* s;
+    };
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, int>::type = 0>
+    LogArg(T v) : type(Type::Int), i(v) {}
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value, int>::type = 0>
+    LogArg(T v) : type(Type::Uint), u(v) {}
+    template <typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+    LogArg(T v) : type(Type::Double), d(v) {}
+    LogArg(const char* v) : type(Type::Str), s(v) {}
+    LogArg() : type(Type::Int), i(0) {}
+};
+
+struct LogRecord {
+    std::uint64_t timeNs;
+    const char* fmt;
+    LogLevel level;
+    std::uint8_t argc;
+    LogArg args[LOG_MAX_ARGS];
+};
+
+class Log {
+public:
+    static void start();
+    // Drain everything still queued, then stop the writer thread
+    static void stop();
+
+    // Any thread may change the level while others log
+    static bool enabled(LogLevel level) { return (int)level >= threshold.load(std::memory_order_relaxed); }
+    static void setLevel(LogLevel level) { threshold.store((int)level, std::memory_order_relaxed); }
+
+    template <typename... Args>
+    static void write(LogLevel level, const char* fmt, const Args&... args) {
+        static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+        LogRecord r;
+        r.level = level;
+        r.fmt = fmt;
+        r.argc = (std::uint8_t)sizeof...(Args);
+        int n = 0;
+        using expand = int[];
+        (void)expand{0, (r.args[n++] = LogArg(args), 0)...};
+        submit(r);
+    }
+
+private:
+    static void submit(LogRecord& r);
+    static std::atomic<int> threshold; // a LogLevel
+};
+
+#define LOG_ENABLED(lvl) ((int)LogLevel::lvl >= SNAKE_LOG_LEVEL && Log::enabled(LogLevel::lvl))
+#define LOG_AT(lvl, ...) do { if (LOG_ENABLED(lvl)) Log::write(LogLevel::lvl, __VA_ARGS__); } while (0)
+#define LOG_TRACE(...) LOG_AT(Trace, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(Debug, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_AT(Info, __VA_ARGS__)
+#define LOG_WARN(...)  LOG_AT(Warn, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(Error, __VA_ARGS__)
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <SFML/Network.hpp>
+#include "NetProtocol.hpp"
+#include <deque>
+#include <string>
+#include <vector>
+
+// Client side of the LAN mode (SNAKE_CONNECT=host[:port][/room]).
+// Keeps the last HISTORY worlds the server sent so any acknowledged tick can
+// serve as a delta baseline. Our own snake is drawn predicted: the newest
+// authoritative body plus every input the server has not applied yet, so
+// turning feels immediate whatever the round trip. The other snakes are drawn
+// as last received.
+class NetClient {
+public:
+    // Resends Hello until a Welcome arrives or `timeout` expires; `room` only
+    // matters on a multi-room server
+    bool connect(const std::string& host, unsigned short port, int room = 0, sf::Time timeout = sf::seconds(3.f));
+    void disconnect();
+
+    // Drains the socket and, on each client tick, sends the current direction
+    void update();
+    void draw(sf::RenderTarget& target, int blockSize);
+
+    bool isConnected() const { return connected; }
+    int getGridWidth() const { return gridWidth; }
+    int getGridHeight() const { return gridHeight; }
+    int getPlayerId() const { return playerId; }
+    int getScore() const;
+    int getBestScore() const;
+    float getRttMs() const { return rttMs; }
+    std::size_t getLastSnapshotBytes() const { return lastSnapshotBytes; }
+
+private:
+    struct PendingInput {
+        net::InputEntry entry;
+        sf::Time sentAt;
+    };
+
+    void receiveAll();
+    void handleSnapshot(net::ByteReader& r, std::size_t size);
+    void readDirection();
+    void sendInput();
+    void predict();
+    const net::NetWorld& latest() const { return received[latestTick % net::HISTORY]; }
+
+    sf::UdpSocket socket;
+    sf::IpAddress server;
+    unsigned short serverPort = 0;
+    bool connected = false;
+    int playerId = -1;
+    int gridWidth = 0;
+    int gridHeight = 0;
+    float tickSeconds = 0.08f;
+    std::vector<Cell> walls;
+
+    std::vector<net::NetWorld> received; // indexed by tick % HISTORY
+    net::NetWorld empty;
+    net::NetWorld scratch;
+    std::uint32_t latestTick = 0;
+    std::uint32_t appliedSeq = 0;        // last input the server reported applied
+
+    std::deque<PendingInput> pending;    // sent, not yet applied by the server
+    std::uint32_t nextSeq = 1;
+    Cell wantedDir{0, -1};
+    std::vector<Cell> predicted;
+
+    sf::Clock clock;                     // timestamps for rtt
+    float accum = 0.f;
+    sf::Clock tickClock;
+    float rttMs = 0.f;
+    std::size_t lastSnapshotBytes = 0;
+    std::vector<std::uint8_t> packet;
+    std::vector<std::uint8_t> receiveBuffer;
+    sf::VertexArray vertices; // reused by draw()
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "BodyCodec.hpp"
+#include "Common.hpp"
+#include "WorldSnapshot.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Wire format of the LAN multiplayer mode (tools/SnakeServer.cpp + NetClient).
+//
+// Every datagram starts with MAGIC, VERSION and a MsgType. Integers are
+// little-endian; cells are two bytes (boards are at most 255x255).
+//
+//   Hello     client -> server  join request for a room, repeated until Welcome arrives
+//   Welcome   server -> client  player id, board size, tick, static walls
+//   Full      server -> client  every player slot is taken
+//   Input     client -> server  ack tick + the last few (seq, direction) inputs
+//   Snapshot  server -> client  world at `tick` as a delta against `baseTick`
+//   Bye       either way        leaving
+//
+// Watch / Keyframe / Change belong to the spectator stream (Broadcast.hpp).
+//
+// Snapshots are deltas against the newest tick the client acknowledged
+// (0 = empty world), so a lost datagram costs nothing: the next one is still
+// relative to something the client has. Per snake only the new head cells and
+// the number of tail cells dropped are sent; the full body goes out only when
+// it jumped (spawn, death, portal). Fruits are sent as added / removed cells,
+// portals only when they changed.
+namespace net {
+
+const std::uint16_t MAGIC = 0x534D; // "MS"
+const std::uint8_t VERSION = 2;
+const unsigned short DEFAULT_PORT = 47800;
+const int MAX_INPUTS_PER_PACKET = 8; // redundancy against loss
+const int HISTORY = 64;              // ticks of world state kept for baselines
+const int MAX_BOARD_SIDE = 255;      // cells travel as single bytes
+const std::size_t MAX_PAYLOAD = 65507; // largest UDP datagram over IPv4
+
+enum class MsgType : std::uint8_t { Hello = 1, Welcome, Full, Input, Snapshot, Bye, Watch, Keyframe, Change };
+
+struct NetSnake {
+    std::uint32_t epoch = 0;
+    std::uint32_t moves = 0;
+    std::uint16_t score = 0;
+    bool alive = false;
+    std::vector<Cell> body; // head first
+};
+
+struct NetWorld {
+    std::uint32_t tick = 0;
+    std::vector<NetSnake> snakes;
+    std::vector<Fruit> fruits;
+    std::vector<Portal> portals;
+};
+
+struct InputEntry {
+    std::uint32_t seq;
+    std::int8_t dx, dy;
+};
+
+class ByteWriter {
+public:
+    explicit ByteWriter(std::vector<std::uint8_t>& out) : out(out) { out.clear(); }
+    void u8(std::uint8_t v) { out.push_back(v); }
+    void u16(std::uint16_t v) { u8((std::uint8_t)v); u8((std::uint8_t)(v >> 8)); }
+    void u32(std::uint32_t v) { u16((std::uint16_t)v); u16((std::uint16_t)(v >> 16)); }
+    void cell(const Cell& c) { u8((std::uint8_t)c.x); u8((std::uint8_t)c.y); }
+    // A whole body, two bits a segment (BodyCodec.hpp)
+    void body(const std::vector<Cell>& cells) { bodycodec::encode(cells, out); }
+    void header(MsgType type) { u16(MAGIC); u8(VERSION); u8((std::uint8_t)type); }
+    std::size_t size() const { return out.size(); }
+    // Patch a count written earlier (known only after the items)
+    void patch8(std::size_t at, std::uint8_t v) { out[at] = v; }
+    void patch16(std::size_t at, std::uint16_t v) { out[at] = (std::uint8_t)v; out[at + 1] = (std::uint8_t)(v >> 8); }
+private:
+    std::vector<std::uint8_t>& out;
+};
+
+// Reading past the end returns zeros and clears ok(); check it once at the end
+class ByteReader {
+public:
+    ByteReader(const std::uint8_t* data, std::size_t size) : p(data), end(data + size) {}
+    std::uint8_t u8() { if (p >= end) { good = false; return 0; } return *p++; }
+    std::uint16_t u16() { std::uint16_t lo = u8(); return (std::uint16_t)(lo | (u8() << 8)); }
+    std::uint32_t u32() { std::uint32_t lo = u16(); return lo | ((std::uint32_t)u16() << 16); }
+    Cell cell() { int x = u8(); return {x, (int)u8()}; }
+    // More than maxSegments is treated as malformed
+    void body(std::vector<Cell>& cells, std::size_t maxSegments) {
+        std::size_t used = bodycodec::decode(p, (std::size_t)(end - p), maxSegments, cells);
+        if (used == 0) good = false;
+        p += used;
+    }
+    // False if the datagram is not ours or not this version
+    bool header(MsgType& type) {
+        if (u16() != MAGIC || u8() != VERSION) return false;
+        type = (MsgType)u8();
+        return good;
+    }
+    bool ok() const { return good; }
+private:
+    const std::uint8_t* p;
+    const std::uint8_t* end;
+    bool good = true;
+};
+
+// Snapshot body: `cur` relative to `base` (base.tick 0 = empty world)
+void writeDelta(ByteWriter& w, const NetWorld& base, const NetWorld& cur, std::uint32_t lastInputSeq);
+// Reads the tick numbers first so the caller can find the baseline
+bool readDeltaTicks(ByteReader& r, std::uint32_t& tick, std::uint32_t& baseTick, std::uint32_t& lastInputSeq);
+// Rebuilds the world into `out` from its baseline; false on a malformed packet
+bool applyDelta(ByteReader& r, const NetWorld& base, std::uint32_t tick, NetWorld& out);
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Arena.hpp"
+#include "NetProtocol.hpp"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+// One networked game, independent of the transport: an Arena, the player
+// slots and the snapshot history used as delta baselines. NetServer (one
+// room over an SFML socket) and RoomServer (many rooms behind one epoll loop)
+// hand it datagrams and send whatever it writes.
+//
+// Peers are identified by a 64-bit key, (IPv4 << 16) | port, so a transport
+// can turn the key back into an address. Snakes 0..players-1 belong to the
+// player slots and the rest are bots; a free slot is played by the AI.
+class NetRoom {
+public:
+    using Send = std::function<void(std::uint64_t peer, const std::vector<std::uint8_t>& packet)>;
+
+    NetRoom(int roomId, int players, int bots, unsigned seed, float tickSeconds, Send send);
+
+    // Largest Snapshot for `snakes` snakes: every body sent in full at
+    // Arena::MAX_LENGTH, every fruit removed and re-added, portals changed.
+    static constexpr std::size_t maxSnapshotBytes(int snakes) {
+        return 4 + 12 + 2 + 2 + (std::size_t)snakes * (15 + 2 * Arena::MAX_LENGTH) +
+               4 + (std::size_t)Arena::maxFruits(snakes) * 5 + 2 + 2 * Arena::MAX_PORTALS;
+    }
+    // players + bots in one room, so that any snapshot fits in one datagram
+    static constexpr int MAX_SNAKES = 120;
+    // A player silent for this long is dropped and the AI takes over
+    static constexpr float CLIENT_TIMEOUT = 5.f;
+
+    void receive(std::uint64_t peer, const std::uint8_t* data, std::size_t size);
+    // Applies one queued input per client, steps the arena, sends snapshots
+    void tick();
+    // Tells every client goodbye (server shutdown)
+    void close();
+
+    int getConnectedCount() const { return connectedCount; }
+    const Arena& getArena() const { return arena; }
+    float getTickSeconds() const { return tickSeconds; }
+    // Heap + object size, for the per-room memory report
+    std::size_t getMemoryBytes() const;
+    // Snapshots sent and their bytes since the last call
+    void takeTraffic(std::uint64_t& snapshots, std::uint64_t& bytes);
+
+    static std::uint64_t peerKey(std::uint32_t ipv4, unsigned short port) { return ((std::uint64_t)ipv4 << 16) | port; }
+    static std::uint32_t peerAddress(std::uint64_t peer) { return (std::uint32_t)(peer >> 16); }
+    static unsigned short peerPort(std::uint64_t peer) { return (unsigned short)(peer & 0xFFFF); }
+
+private:
+    struct Client {
+        bool connected = false;
+        std::uint64_t peer = 0;
+        long lastHeardTick = 0;
+        std::uint32_t ackTick = 0;         // newest snapshot the client has
+        std::uint32_t lastReceivedSeq = 0;
+        std::uint32_t lastAppliedSeq = 0;  // echoed in snapshots for prediction
+        std::deque<net::InputEntry> inputs; // one is applied per tick
+    };
+
+    int findClient(std::uint64_t peer) const;
+    void sendWelcome(int slot);
+    void disconnect(int slot, const char* reason);
+    void capture(net::NetWorld& world);
+    void sendSnapshots();
+
+    int roomId;
+    int players;
+    float tickSeconds;
+    long timeoutTicks;
+    Arena arena;
+    Send send;
+    int connectedCount = 0;
+    std::vector<Cell> walls;
+    std::vector<Client> clients;        // index = player slot = snake id
+    std::vector<net::NetWorld> history; // indexed by tick % HISTORY
+    net::NetWorld empty;
+    std::vector<std::uint8_t> packet;
+
+    std::uint64_t snapshotsSent = 0;
+    std::uint64_t snapshotBytes = 0;
+};
+
+static_assert(NetRoom::maxSnapshotBytes(NetRoom::MAX_SNAKES) <= net::MAX_PAYLOAD,
+              "a full snapshot must fit in one datagram");
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include "NetRoom.hpp"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Headless authoritative server for one LAN game (bin/SnakeServer.exe).
+// Portable: an SFML socket in front of a single NetRoom, ticked on the
+// calling thread. RoomServer is the Linux variant that hosts many rooms.
+class NetServer {
+public:
+    NetServer(int players, int bots, unsigned short port, float tickSeconds = 0.08f);
+
+    bool start();
+    // Returns once `running` is cleared; tells connected clients goodbye
+    void run(const std::atomic<bool>& running);
+
+private:
+    void receiveAll();
+    void send(std::uint64_t peer, const std::vector<std::uint8_t>& packet);
+
+    int players;
+    unsigned short port;
+    float tickSeconds;
+    NetRoom room;
+    sf::UdpSocket socket;
+    std::vector<std::uint8_t> receiveBuffer;
+
+    // Traffic stats, printed every few seconds
+    sf::Clock statsClock;
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+
+// Scoped timing zones for the hot paths.
+//
+//   void Barrier::draw(...) { PROFILE_ZONE("Barrier::draw"); ... }
+//
+// Each thread records into its own lock-free ring buffer, together with the
+// heap allocations made inside the zone; the render thread drains them all in
+// Profiler::endFrame() and keeps a rolling window per zone (min / avg / p99,
+// allocs) plus a flame graph of the last frame for the overlay.
+// Built with -DSNAKE_PROFILE (make PROFILE=1); otherwise every macro expands
+// to nothing and the Profiler calls are empty inlines.
+
+#ifdef SNAKE_PROFILE
+
+class Profiler {
+public:
+    // Zone ids are handed out once per PROFILE_ZONE site
+    static int registerZone(const char* name);
+    static void beginZone();
+    static void endZone(int zone);
+
+    // Render thread: collect this frame's samples and close the frame
+    static void endFrame();
+    static void toggleOverlay() { overlay = !overlay; }
+    static bool overlayVisible() { return overlay; }
+    static void drawOverlay(sf::RenderWindow& window, const sf::Font& font);
+
+    // Trace recorder: every drained zone also goes into a preallocated event
+    // buffer, written as Chrome trace_event JSON (chrome://tracing, Perfetto).
+    // Starts at launch when SNAKE_TRACE is set, or with toggleTrace(); each
+    // recording starts empty. Events past a full buffer are counted and
+    // reported by writeTrace() instead of growing it.
+    static void toggleTrace();
+    static bool isTracing();
+    static bool writeTrace(const char* path);
+
+    // Allocation accounting (see AllocTracker.hpp). With SNAKE_ALLOC_CHECK set,
+    // frames flagged steady are checked for heap allocations after a warm-up;
+    // allocCheckExitCode() prints the verdict and returns non-zero on failure.
+    // The check is done once SNAKE_ALLOC_FRAMES (default 600) frames passed it.
+    static void setSteadyState(bool steady);
+    static bool allocCheckEnabled();
+    static bool allocCheckDone();
+    static int allocCheckExitCode();
+
+private:
+    static bool overlay;
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(int zone) : zone(zone) { Profiler::beginZone(); }
+    ~ProfileScope() { Profiler::endZone(zone); }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+private:
+    int zone;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) \
+    static const int PROFILE_CONCAT(profileZoneId_, __LINE__) = Profiler::registerZone(name); \
+    ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(PROFILE_CONCAT(profileZoneId_, __LINE__))
+
+#else
+
+class Profiler {
+public:
+    static void endFrame() {}
+    static void toggleOverlay() {}
+    static bool overlayVisible() { return false; }
+    static void drawOverlay(sf::RenderWindow&, const sf::Font&) {}
+    static void toggleTrace() {}
+    static bool isTracing() { return false; }
+    static bool writeTrace(const char*) { return false; }
+    static void setSteadyState(bool) {}
+    static bool allocCheckEnabled() { return false; }
+    static bool allocCheckDone() { return false; }
+    static int allocCheckExitCode() { return 0; }
+};
+
+#define PROFILE_ZONE(name) ((void)0)
+
+#endif
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "NetRoom.hpp"
+#include "SpscQueue.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Multi-room server (SnakeServer --rooms N, Linux only).
+//
+// One thread owns the UDP socket and an epoll loop: it reads datagrams in
+// batches, routes each one to its room (Hello names the room, later packets
+// follow the sender's address) and queues it for the worker that owns that
+// room. Rooms are spread over a pool of workers, one per core, and never
+// shared. A worker keeps its rooms in a TimerWheel and ticks each one when
+// its deadline comes up; rooms without players are not scheduled at all, so
+// thousands of idle rooms cost memory but no CPU. Workers send snapshots
+// straight from their own thread on the shared socket.
+class RoomServer {
+public:
+    struct Config {
+        unsigned short port = 47800;
+        int rooms = 1000;
+        int players = 2;     // player slots per room
+        int bots = 2;        // AI snakes per room
+        int workers = 0;     // 0 = one per core, minus the network thread
+        float tickSeconds = 0.08f;
+    };
+
+    // Counters since the previous call, for the periodic report
+    struct Stats {
+        int activeRooms = 0;
+        int createdRooms = 0;
+        std::uint64_t ticks = 0;
+        float tickP99Us = 0.f;      // cost of one room tick
+        float latenessP99Us = 0.f;  // how late ticks started after their deadline
+        std::uint64_t snapshots = 0;
+        std::uint64_t snapshotBytes = 0;
+        std::uint64_t datagramsIn = 0;
+        std::uint64_t dropped = 0;  // worker queue full
+        std::size_t bytesPerRoom = 0;
+    };
+
+    explicit RoomServer(const Config& config);
+    ~RoomServer();
+
+    bool start();
+    // Network loop on the calling thread until `running` is cleared
+    void run(const std::atomic<bool>& running);
+    Stats takeStats();
+    int getWorkerCount() const { return (int)workers.size(); }
+    unsigned short getPort() const { return config.port; }
+
+    static const int MAX_DATAGRAM = 64; // every client->server message fits
+
+private:
+    struct Datagram {
+        std::uint64_t peer;
+        std::uint16_t room;
+        std::uint8_t size;
+        std::uint8_t data[MAX_DATAGRAM];
+    };
+
+    // Microsecond histogram: workers add lock-free, takeStats() drains it
+    struct Histogram {
+        static const int BUCKETS = 1024;  // 10 us each, the last one open-ended
+        std::atomic<std::uint32_t> counts[BUCKETS] = {};
+        void add(float us);
+        float takePercentile(float p);
+    };
+
+    struct Worker {
+        std::thread thread;
+        SpscQueue<Datagram, 4096> inbox;
+        std::mutex sleepMutex;
+        std::condition_variable wake;
+        std::atomic<bool> sleeping{false};
+        bool pending = false; // network thread: pushed since the last notify
+        std::atomic<int> activeRooms{0};
+        std::atomic<int> createdRooms{0};
+        std::atomic<std::uint64_t> ticks{0};
+        std::atomic<std::uint64_t> snapshots{0};
+        std::atomic<std::uint64_t> snapshotBytes{0};
+        std::atomic<std::uint64_t> memoryBytes{0};
+        Histogram tickUs;
+        Histogram latenessUs;
+    };
+
+    void workerLoop(int index);
+    void receiveBatch();
+    void route(std::uint64_t peer, const std::uint8_t* data, std::size_t size);
+    void expirePeers(std::uint64_t now);
+    void sendTo(std::uint64_t peer, const std::vector<std::uint8_t>& packet);
+
+    Config config;
+    int fd = -1;
+    int epollFd = -1;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> stopping{false};
+    // Network thread only. A peer silent for twice the room's client timeout
+    // has been dropped by its room, so its entry is expired here as well
+    struct PeerRoute {
+        std::uint16_t room;
+        std::uint64_t lastHeardMs;
+    };
+    std::unordered_map<std::uint64_t, PeerRoute> peerRooms;
+    std::uint64_t batchMs = 0;       // receive time of the current batch
+    std::uint64_t nextPeerExpiry = 0;
+    std::vector<std::uint8_t> packet;
+    std::atomic<std::uint64_t> datagramsIn{0};
+    std::atomic<std::uint64_t> dropped{0};
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Common.hpp"
+
+// Versioned binary snapshot of a game session.
+// Layout: Header | Core | body (bodyBytes, BodyCodec.hpp) | PackedCell walls[wallCount] | SavedFruit fruits[fruitCount]
+// Every block but the body is plain data copied with memcpy, and files are
+// written and read with a single call, so suspend/resume cost is dominated by
+// the copies. The body goes in two bits a segment.
+namespace savestate {
+
+const char MAGIC[4] = {'M', 'S', 'S', 'V'};
+const std::uint32_t VERSION = 3;
+
+struct Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t totalSize;  // bytes including this header
+    std::uint32_t checksum;   // FNV-1a over everything after the header
+    std::uint32_t bodyCount;
+    std::uint32_t wallCount;
+    std::uint32_t fruitCount;
+    std::uint32_t bodyBytes;
+};
+
+struct SavedPortal {
+    std::int32_t x, y;
+    std::uint8_t active, isExit, pad[2];
+};
+
+struct SavedFruit {
+    std::int32_t type;
+    std::int32_t x, y;
+    float spawnTime;
+    float duration;
+};
+
+struct Core {
+    std::int32_t gridWidth, gridHeight;
+    std::int32_t state;               // GameLogic::State
+    std::int32_t score;
+    Cell direction, nextDirection;
+
+    // timers, all in play seconds (pauses excluded)
+    float elapsedPlaySeconds;
+    float fruitCountdown;
+    float lastUpdateSeconds;
+    float lastSpawnCheck;
+    float portalRegrowAccum;
+    float portalExitCountdown;
+
+    SavedPortal portalEntrance, portalExit;
+    std::int32_t portalTargetLength;
+    std::int32_t nextPortalScore;
+    std::int32_t portalRegrowPlaced;
+    std::int32_t portalRegrowNeeded;
+    std::int32_t portalGraceTicks;
+    std::int32_t countdownNumber;     // 3..0, 0 = "START"
+    std::uint8_t portalShowCountdown;
+    std::uint8_t portalRegrowingActive;
+    std::uint8_t portalExitCountdownActive;
+    std::uint8_t showCountdown;
+
+    unsigned char rng[sizeof(std::mt19937)]; // engine state, copied bytewise
+};
+
+static_assert(std::is_trivially_copyable<Cell>::value, "Cell must stay plain data");
+static_assert(std::is_trivially_copyable<PackedCell>::value, "PackedCell must stay plain data");
+static_assert(std::is_trivially_copyable<std::mt19937>::value, "RNG state is saved bytewise");
+
+std::uint32_t checksum(const unsigned char* data, std::size_t size);
+bool writeFile(const std::string& path, const std::vector<unsigned char>& bytes);
+bool readFile(const std::string& path, std::vector<unsigned char>& bytes);
+
+} // namespace savestate
@@ -10,12 +10,18 @@ public:
     
     void changeDirection(int dx, int dy);
     void update();
-    void draw(sf::RenderWindow& window, int blockSize);
+    void draw(sf::RenderTarget& window, int blockSize);
+    // rectangle fallback used for any body (the renderer draws from snapshots)
+    static void drawCells(sf::RenderTarget& window, const std::vector<Cell>& body, int blockSize, sf::Color color);
     
     bool checkSelfCollision() const;
     Cell getHead() const { return body.front(); }
-    const std::vector<Cell>& getBody() const { return body; }
+    // Stored packed; read as Cells
+    const PackedBody& getBody() const { return body; }
     Cell getDirection() const { return direction; }
+    Cell getNextDirection() const { return nextDirection; }
+    // restore a saved heading without the reversal check
+    void setDirection(const Cell& dir, const Cell& next) { direction = dir; nextDirection = next; }
     
     void grow();
     void growAt(const Cell& pos);
@@ -24,7 +30,7 @@ public:
     void shrinkTo(int len);
     
 private:
-    std::vector<Cell> body;
+    PackedBody body;
     Cell direction;
     Cell nextDirection;
     sf::Color color;
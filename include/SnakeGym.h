@@ -0,0 +1,88 @@
+#pragma once
+
+/* C interface to GymEnv for FFI (ctypes, cffi, Julia, ...); make gym builds
+ * bin/libsnakegym.so. Version 1; entries are only ever added.
+ *
+ *   SnakeGym* env = snake_gym_create(60, 60);
+ *   uint8_t* obs = malloc(snake_gym_observation_size(env));
+ *   snake_gym_bind_observation(env, obs);   // kept current in place
+ *   snake_gym_reset(env, seed);
+ *   while (!snake_gym_step(env, action, &reward)) { ... read obs ... }
+ *
+ * Observation layout, plane order and reward are documented in GymEnv.hpp.
+ * An environment is not thread-safe; use one per thread.
+ *
+ * Search (version 2): snake_gym_hash identifies the position, and a state
+ * saved once can be loaded before every rollout:
+ *
+ *   SnakeGymState* root = snake_gym_state_create();
+ *   snake_gym_save(env, root);
+ *   for (...) { snake_gym_load(env, root); ... step ... }
+ *   snake_gym_state_destroy(root);
+ *
+ * Version 3: snake_gym_reachable_area and snake_gym_trapped, followed
+ * incrementally once asked for (see GymEnv::isTrapped). */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define SNAKE_GYM_API __declspec(dllexport)
+#else
+#define SNAKE_GYM_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNAKE_GYM_VERSION 3
+
+typedef struct SnakeGym SnakeGym;
+typedef struct SnakeGymState SnakeGymState;
+
+/* Actions */
+enum { SNAKE_GYM_UP = 0, SNAKE_GYM_DOWN = 1, SNAKE_GYM_LEFT = 2, SNAKE_GYM_RIGHT = 3 };
+/* Planes */
+enum {
+    SNAKE_GYM_WALLS = 0, SNAKE_GYM_BODY, SNAKE_GYM_HEAD, SNAKE_GYM_GOMU, SNAKE_GYM_MERA,
+    SNAKE_GYM_OPE, SNAKE_GYM_PORTAL, SNAKE_GYM_PLANES
+};
+/* Why an episode ended */
+enum { SNAKE_GYM_RUNNING = 0, SNAKE_GYM_WALL, SNAKE_GYM_SELF, SNAKE_GYM_FRUIT_TIMER };
+
+SNAKE_GYM_API int snake_gym_version(void);
+/* NULL if the board is smaller than 16x16 or larger than 255x255 */
+SNAKE_GYM_API SnakeGym* snake_gym_create(int width, int height);
+SNAKE_GYM_API void snake_gym_destroy(SnakeGym* env);
+
+SNAKE_GYM_API void snake_gym_reset(SnakeGym* env, uint32_t seed);
+/* Returns 1 when the episode is over (see snake_gym_end) */
+SNAKE_GYM_API int snake_gym_step(SnakeGym* env, int action, float* reward);
+
+SNAKE_GYM_API size_t snake_gym_observation_size(const SnakeGym* env);
+/* planes: observation_size bytes owned by the caller; NULL unbinds */
+SNAKE_GYM_API void snake_gym_bind_observation(SnakeGym* env, uint8_t* planes);
+SNAKE_GYM_API void snake_gym_write_observation(const SnakeGym* env, uint8_t* planes);
+
+SNAKE_GYM_API int snake_gym_score(const SnakeGym* env);
+SNAKE_GYM_API int snake_gym_length(const SnakeGym* env);
+SNAKE_GYM_API float snake_gym_fruit_timer(const SnakeGym* env);
+SNAKE_GYM_API int snake_gym_end(const SnakeGym* env);
+
+/* Version 2 */
+SNAKE_GYM_API uint64_t snake_gym_hash(const SnakeGym* env);
+SNAKE_GYM_API SnakeGymState* snake_gym_state_create(void);
+SNAKE_GYM_API void snake_gym_state_destroy(SnakeGymState* state);
+SNAKE_GYM_API void snake_gym_save(const SnakeGym* env, SnakeGymState* state);
+/* Only a state saved by an environment of the same size */
+SNAKE_GYM_API void snake_gym_load(SnakeGym* env, const SnakeGymState* state);
+
+/* Version 3 */
+SNAKE_GYM_API int snake_gym_reachable_area(SnakeGym* env);
+/* 1 when sealed into less room than the body needs, away from its tail */
+SNAKE_GYM_API int snake_gym_trapped(SnakeGym* env);
+
+#ifdef __cplusplus
+}
+#endif
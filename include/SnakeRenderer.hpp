@@ -1,29 +1,37 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include "WorldSnapshot.hpp"
 #include <vector>
 #include <memory>
 
+// Flat-colour cells for the views without sprites (arena, LAN client,
+// spectator): one quad per cell, shrunk by `inset` pixels on every side.
+namespace cellquad {
+void append(sf::VertexArray& vertices, int x, int y, float blockSize, sf::Color color, float inset);
+sf::Color fruitColor(Fruit::Type type);
+}
+
 class SnakeRenderer {
 public:
     SnakeRenderer();
 
+    // Queues the weedle sprites for decoding; false if a file is missing
     bool loadSprites();
-    bool isLoaded() const { return loaded; }
+    bool isLoaded() const;
     void setSpriteScale(float scale) { spriteScale = scale; }
     float getSpriteScale() const { return spriteScale; }
     void setTailRotate180(bool v) { tailRotate180 = v; }
     bool getTailRotate180() const { return tailRotate180; }
 
-    void drawHead(sf::RenderWindow& window, int x, int y, int blockSize, int dirX, int dirY);
-    void drawBody(sf::RenderWindow& window, int x, int y, int blockSize, int dirX, int dirY);
-    void drawTail(sf::RenderWindow& window, int x, int y, int blockSize, int dirX, int dirY);
+    void drawHead(sf::RenderTarget& window, int x, int y, int blockSize, int dirX, int dirY);
+    void drawBody(sf::RenderTarget& window, int x, int y, int blockSize, int dirX, int dirY);
+    void drawTail(sf::RenderTarget& window, int x, int y, int blockSize, int dirX, int dirY);
 
 private:
-    sf::Texture headTexture, bodyTexture, tailTexture;
-    bool loaded = false;
+    std::shared_ptr<sf::Texture> headTexture, bodyTexture, tailTexture;
 
-    bool loadTexture(sf::Texture& tex, const std::string& path);
+    bool loadTexture(std::shared_ptr<sf::Texture>& tex, const std::string& path);
     float spriteScale = 1.5f; // Multiply sprite rendering size relative to blockSize
     bool tailRotate180 = true;
 };
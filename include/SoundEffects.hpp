@@ -0,0 +1,62 @@
+#pragma once
+
+#include <SFML/Audio.hpp>
+#include "SpscQueue.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+
+enum class Sfx {
+    EatGomu,
+    EatMera,
+    EatOpe,
+    PortalSpawn,
+    PortalTeleport,
+    CountdownTick,
+    CountdownGo,
+    GameOver,
+    Count
+};
+
+// Sound effects mixer.
+// Buffers are preloaded once (assets/sfx/*.wav, or a synthesized tone when the
+// file is missing) and played on a fixed pool of voices; when every voice is
+// busy the oldest lower-priority one is stolen. The simulation only calls
+// trigger(), which pushes onto a lock-free queue and never touches SFML audio
+// objects. pump() runs on the render thread and starts the queued sounds.
+class SoundEffects {
+public:
+    SoundEffects();
+    ~SoundEffects();
+
+    // Producer side (game tick): lock-free, never blocks, drops if the queue is full
+    void trigger(Sfx id);
+    // Consumer side (render thread): play everything queued since the last call
+    void pump();
+
+    void setVolume(float v) { volume = v; }
+
+    // Trigger-to-play() latency, in microseconds. dropped counts events lost to
+    // a full queue, outranked those skipped because no voice could be stolen.
+    struct LatencyStats { std::uint64_t count = 0; double avgUs = 0, maxUs = 0; std::uint64_t stolen = 0, dropped = 0, outranked = 0; };
+    LatencyStats getLatencyStats() const;
+
+private:
+    struct Event { Sfx id; std::int64_t triggeredNs; };
+    struct Voice { sf::Sound sound; int priority = 0; std::int64_t startedNs = 0; };
+    static const int VOICES = 12;
+
+    void loadBuffers();
+    Voice* pickVoice(int priority);
+
+    SpscQueue<Event, 64> queue;
+    std::array<std::shared_ptr<sf::SoundBuffer>, (size_t)Sfx::Count> buffers;
+    std::array<Voice, VOICES> voices;
+    float volume = 70.f;
+
+    std::uint64_t latencyCount = 0;
+    double latencySumUs = 0, latencyMaxUs = 0;
+    std::uint64_t stolenVoices = 0;
+    std::uint64_t outrankedEvents = 0;  // skipped: every voice busy with a higher priority
+    std::atomic<std::uint64_t> droppedEvents{0};
+};
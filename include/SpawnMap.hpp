@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Common.hpp"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// The open areas of a wall layout, so fruit and portals only go where the
+// snake can get to. build() labels the cells strictly inside the border once
+// per map (a flood fill) and lists each area's cells together, the cells
+// under the body kept at the back of each list. follow() moves the one or
+// two cells a tick changes between the halves, so pick() draws straight
+// from the free half: only fruit and portals (a handful) are rejected.
+class SpawnMap {
+public:
+    // Border walls sit on minX..maxX, minY..maxY; the cells between are labelled
+    // Clears the body
+    void build(const std::vector<Cell>& walls, int gridWidth, int gridHeight, int minX, int minY, int maxX, int maxY);
+
+    // The body after one tick, head first, as TrapDetector::follow(): a head
+    // step and tail changes cost O(1), any other move is taken from scratch.
+    // Cells off the open area are ignored.
+    void follow(const PackedBody& body);
+
+    // -1 for walls and cells outside the border
+    int areaOf(const Cell& c) const {
+        if (c.x < 0 || c.y < 0 || c.x >= gridWidth || c.y >= gridHeight) return -1;
+        return label[(std::size_t)(c.y * gridWidth + c.x)];
+    }
+    int getAreaCount() const { return (int)start.size() - 1; }
+    int getAreaSize(int area) const { return start[(std::size_t)area + 1] - start[(std::size_t)area]; }
+    int getLargestArea() const { return largest; }
+
+    // A cell of the area off the body; occupied(cell index y * gridWidth + x)
+    // says what else is on it
+    template <typename Rng, typename Occupied>
+    bool pick(int area, Rng& rng, const Occupied& occupied, Cell& out) const {
+        if (area < 0 || area >= getAreaCount()) return false;
+        int first = start[(std::size_t)area], n = freeCount[(std::size_t)area];
+        if (n == 0) return false;
+        std::uniform_int_distribution<int> dist(0, n - 1);
+        for (int i = 0; i < RANDOM_DRAWS; ++i) {
+            int cell = cells[(std::size_t)(first + dist(rng))];
+            if (!occupied(cell)) return found(cell, out);
+        }
+        // Mostly full: the first free cell from a random point
+        int from = dist(rng);
+        for (int i = 0; i < n; ++i) {
+            int cell = cells[(std::size_t)(first + (from + i) % n)];
+            if (!occupied(cell)) return found(cell, out);
+        }
+        return false;
+    }
+
+private:
+    static const int RANDOM_DRAWS = 16;
+
+    bool found(int cell, Cell& out) const {
+        out = {cell % gridWidth, cell / gridWidth};
+        return true;
+    }
+    void assignBody(const PackedBody& body);
+    void occupy(const Cell& c);
+    void release(const Cell& c);
+
+    int gridWidth = 0;
+    int gridHeight = 0;
+    int largest = -1;
+    std::vector<int> label;   // area per cell
+    std::vector<int> cells;   // cell indices grouped by area
+    std::vector<int> start;   // area a owns cells[start[a] .. start[a + 1])
+    std::vector<int> freeCount; // cells[start[a] .. start[a] + freeCount[a]) are off the body
+    std::vector<int> slot;    // where a cell sits in cells
+    std::vector<std::uint16_t> users; // body segments on a cell (growth stacks on the tail)
+    PackedBody trail;         // the body as follow() last saw it
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <SFML/Network.hpp>
+#include "Broadcast.hpp"
+#include <string>
+#include <vector>
+
+// Viewer of a broadcast game (SNAKE_WATCH=host[:port]). Subscribes with
+// Watch, repeated as a keep-alive, and rebuilds the game from the newest
+// keyframe plus the change records after it. When a record goes missing the
+// picture stays frozen and a keyframe is requested; the game itself never
+// waits for a viewer.
+class Spectator {
+public:
+    // Waits for the first keyframe, up to `timeout`
+    bool connect(const std::string& host, unsigned short port, sf::Time timeout = sf::seconds(3.f));
+    void disconnect();
+
+    // Drains the socket; re-asks for a keyframe while out of sync
+    void update();
+    void draw(sf::RenderTarget& target, int blockSize);
+
+    bool isConnected() const { return connected; }
+    const cast::Replica& getReplica() const { return replica; }
+    int getResyncCount() const { return resyncs; }
+    // Stream bandwidth over the last second
+    float getBytesPerSecond() const { return bytesPerSecond; }
+
+private:
+    void receiveAll();
+    void sendWatch(bool needKeyframe);
+
+    sf::UdpSocket socket;
+    sf::IpAddress host;
+    unsigned short hostPort = 0;
+    bool connected = false;
+    cast::Replica replica;
+    int resyncs = 0;
+
+    sf::Clock watchClock;   // keep-alive / keyframe requests
+    sf::Clock rateClock;
+    std::size_t bytesThisSecond = 0;
+    float bytesPerSecond = 0.f;
+    std::vector<std::uint8_t> packet;
+    std::vector<std::uint8_t> receiveBuffer;
+    sf::VertexArray vertices; // reused by draw()
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <SFML/System.hpp>
+#include <string>
+#include <vector>
+
+// Records named milestones relative to process start (time-to-window,
+// time-to-first-frame, ...) and prints them as a small report.
+class StartupTimeline {
+public:
+    static void mark(const std::string& label);
+    static float elapsedMs();
+    static void report();
+    static bool wasReported() { return reported; }
+
+private:
+    struct Entry { std::string label; float ms; };
+    static sf::Clock clock;
+    static std::vector<Entry> entries;
+    static bool reported;
+};
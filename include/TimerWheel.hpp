@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hashed timer wheel with millisecond slots. Scheduling and firing are O(1)
+// per timer and only pending timers are ever visited, so thousands of
+// entries that are not due (or not scheduled at all) cost nothing per tick.
+// Deadlines further out than one revolution stay in their slot and are
+// skipped until their turn comes round. Not thread-safe: one owner thread.
+//
+//   wheel.schedule(room, now + 80);
+//   wheel.advance(now, [&](std::uint32_t id, std::uint64_t due) { ... });
+class TimerWheel {
+public:
+    explicit TimerWheel(std::uint64_t nowMs) : cursor(nowMs) {}
+
+    void schedule(std::uint32_t id, std::uint64_t dueMs) {
+        // From inside fire() the current slot is already being emptied
+        std::uint64_t earliest = advancing ? cursor + 1 : cursor;
+        if (dueMs < earliest) dueMs = earliest;
+        slots[dueMs % SLOTS].push_back({id, dueMs});
+        count++;
+    }
+
+    // fire(id, due) for every timer due at or before nowMs; fire may schedule
+    template <typename Fn>
+    void advance(std::uint64_t nowMs, Fn&& fire) {
+        if (count == 0) {
+            if (nowMs >= cursor) cursor = nowMs + 1;
+            return;
+        }
+        advancing = true;
+        for (; cursor <= nowMs; ++cursor) {
+            std::vector<Timer>& slot = slots[cursor % SLOTS];
+            if (slot.empty()) continue;
+            firing.swap(slot);
+            for (const Timer& t : firing) {
+                if (t.due > cursor) {
+                    slot.push_back(t); // a later revolution
+                    continue;
+                }
+                count--;
+                fire(t.id, t.due);
+            }
+            firing.clear();
+        }
+        advancing = false;
+    }
+
+    // Earliest pending deadline (looks one revolution ahead); false if empty
+    bool nextDue(std::uint64_t& dueMs) const {
+        if (count == 0) return false;
+        for (std::uint64_t t = cursor; t < cursor + SLOTS; ++t) {
+            for (const Timer& timer : slots[t % SLOTS]) {
+                if (timer.due == t) {
+                    dueMs = t;
+                    return true;
+                }
+            }
+        }
+        dueMs = cursor + SLOTS;
+        return true;
+    }
+
+    std::size_t size() const { return count; }
+
+private:
+    struct Timer {
+        std::uint32_t id;
+        std::uint64_t due;
+    };
+
+    static const std::size_t SLOTS = 256;
+    std::vector<Timer> slots[SLOTS];
+    std::vector<Timer> firing;
+    std::uint64_t cursor;
+    std::size_t count = 0;
+    bool advancing = false;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Search results keyed by a position hash (GymEnv::getHash()), shared by any
+// number of search threads without locks. A slot is two 64-bit atomics: the
+// packed result and the key XOR that result. Writers racing on one slot can
+// leave a key from one and a result from the other; the XOR then no longer
+// gives the key back and the probe reads it as a miss, never as another
+// position's result.
+//
+// Slots come in pairs. A store goes to the slot already holding its key, else
+// to the one left by an older search (newSearch()), else to the shallower one.
+class TranspositionTable {
+public:
+    enum class Bound : std::uint8_t { Exact, Lower, Upper };
+
+    struct Entry {
+        float value = 0.f;
+        int depth = 0;              // plies searched below, 0..255
+        Bound bound = Bound::Exact;
+        int action = 0;             // best move found, 0..3
+    };
+
+    // Rounded down to a power of two slot pairs
+    explicit TranspositionTable(std::size_t megabytes);
+
+    bool probe(std::uint64_t key, Entry& out) const;
+    void store(std::uint64_t key, const Entry& entry);
+    // Entries from earlier searches are replaced first
+    void newSearch() { generation.fetch_add(1, std::memory_order_relaxed); }
+    // Not safe while other threads probe or store
+    void clear();
+    std::size_t getSlots() const { return (mask + 1) * 2; }
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> check{0};   // key ^ data
+        std::atomic<std::uint64_t> data{0};    // 0 = empty
+    };
+
+    static std::uint64_t pack(const Entry& e, std::uint8_t generation);
+    static void unpack(std::uint64_t data, Entry& e);
+
+    std::unique_ptr<Slot[]> slots;
+    std::size_t mask = 0;                      // pair index mask
+    std::atomic<std::uint8_t> generation{0};
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Common.hpp"
+#include <cstdint>
+#include <vector>
+
+// Which free cells the snake's head can still get to, kept up to date one
+// cell at a time instead of a flood fill per tick. Free cells carry region
+// labels joined in a union-find.
+//
+// Freeing a cell (the tail moving on) only unites the regions around it.
+// Blocking one (the head moving in) can split its region, but only when the
+// free cells beside it are not already joined through the ring of eight
+// cells around it. Only then does it search, one search per side in
+// lockstep. The search ends once every side but one has run out. The sides
+// that ran out are relabelled, so the work is about the size of the smaller
+// pieces. In open play the ring check settles almost every tick.
+class TrapDetector {
+public:
+    TrapDetector(int gridWidth, int gridHeight);
+
+    // From scratch: O(board)
+    void reset(const std::vector<Cell>& walls, const PackedBody& body);
+    void reset(const std::vector<Cell>& walls, const std::vector<Cell>& body);
+    // New walls under the same body
+    void setWalls(const std::vector<Cell>& walls);
+
+    // The body after one tick, head first: the new head is blocked, cells
+    // the tail left are freed and growth at the tail is blocked. A body that
+    // moved any other way (teleport, loaded game) is taken from scratch.
+    void follow(const PackedBody& body);
+    // One cell at a time, for callers that know their moves. A cell may be
+    // occupied more than once (growth stacks on the tail); it is free again
+    // after as many releases. Cells off the grid are ignored.
+    void occupy(const Cell& c);
+    void release(const Cell& c);
+
+    bool isFree(const Cell& c) const { return inside(c) && blocked[(std::size_t)index(c)] == 0; }
+    // Free cells the head can move into next tick and all they lead to
+    int reachableArea(const Cell& head) const;
+    bool canReach(const Cell& head, const Cell& target) const;
+    // Shut into fewer free cells than it has segments, with its tail not
+    // beside them to open a way out
+    bool isTrapped(const Cell& head, const Cell& tail, int length) const;
+
+    // Cells visited by split searches and full relabels since construction
+    long getCellsSearched() const { return cellsSearched; }
+
+private:
+    bool inside(const Cell& c) const { return c.x >= 0 && c.y >= 0 && c.x < gridWidth && c.y < gridHeight; }
+    int index(const Cell& c) const { return c.y * gridWidth + c.x; }
+    int find(int node) const;
+    int unite(int a, int b);
+    int newRegion(int size);
+    void occupyCell(int cell);
+    void releaseCell(int cell);
+    void split(int cell, int region);
+    void relabel();
+    void assignBody(const PackedBody& body);
+    // Up to four distinct regions around a cell; returns how many
+    int regionsAround(const Cell& c, int out[4]) const;
+
+    int gridWidth;
+    int gridHeight;
+    std::vector<std::uint16_t> blocked;     // wall + body segments on the cell
+    std::vector<std::uint8_t> wall;
+    std::vector<int> label;                 // region node of a free cell, -1 if blocked
+    mutable std::vector<int> parent;        // union-find over region nodes
+    std::vector<int> size;                  // free cells, valid at a root
+    PackedBody trail;                       // the body as follow() last saw it
+
+    // Split search scratch
+    std::vector<std::uint32_t> seen;        // == stamp: visited by this split
+    std::vector<std::uint8_t> owner;        // which search visited it
+    std::vector<int> found[4];              // each search's queue, also its visited cells
+    std::uint32_t stamp = 0;
+    long cellsSearched = 0;
+};
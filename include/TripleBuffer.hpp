@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free triple buffer for one writer and one reader. The writer fills
+// write() and publish()es it; the reader calls update() to take the newest
+// published value and then reads read() for as long as it likes. Neither side
+// ever waits, and the reader always sees a complete value (never a half-
+// written one). Values the reader did not pick up in time are overwritten.
+template <typename T>
+class TripleBuffer {
+public:
+    T& write() { return slots[back]; }
+
+    void publish() {
+        back = middle.exchange((std::uint8_t)(back | FRESH), std::memory_order_acq_rel) & INDEX;
+    }
+
+    // True when a newer value replaced read()
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    const T& read() const { return slots[front]; }
+
+private:
+    static const std::uint8_t INDEX = 0x3;
+    static const std::uint8_t FRESH = 0x4;
+
+    T slots[3];
+    std::uint8_t back = 0;                // writer only
+    alignas(64) std::atomic<std::uint8_t> middle{1};
+    alignas(64) std::uint8_t front = 2;   // reader only
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Common.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class GameState { Menu, Playing, Paused, GameOver };
+
+struct Fruit {
+    enum class Type { Gomu, Mera, Ope } type;
+    int x;
+    int y;
+    float spawnTime; // seconds since game start
+    float duration; // 0 = permanent until eaten
+
+    bool operator==(const Cell &c) const {
+        return x == c.x && y == c.y;
+    }
+};
+
+struct Portal { int x = 0; int y = 0; bool active = false; bool isExit = false; };
+
+// Everything the renderer needs from one simulation step. The simulation
+// thread fills one of these per change and hands it over through a
+// TripleBuffer; the render thread never touches the live game state.
+// Vectors are assigned in place, so once capacities settle publishing does
+// not allocate; walls are only copied when wallsVersion changes.
+struct WorldSnapshot {
+    std::uint64_t revision = 0;
+    GameState state = GameState::Menu;
+
+    std::vector<Cell> body;
+    Cell direction{0, -1};
+    std::vector<Fruit> fruits;
+    Portal portalEntrance;
+    Portal portalExit;
+    bool portalShowCountdown = false;
+    std::vector<Cell> walls;
+    unsigned wallsVersion = 0;
+
+    // HUD
+    int score = 0;
+    float displayElapsed = 0.f;  // play time shown by the timer (frozen while paused / after game over)
+    float fruitCountdown = 0.f;
+    bool trapped = false;        // sealed into less room than the body needs
+    bool showCountdown = false;
+    int countdownNumber = 3;
+
+    // Game over screen
+    int animatedScore = 0;
+    int timeBonusRemaining = 0;
+    bool scoreAnimationDone = false;
+    float finalElapsedSeconds = 0.f;
+    bool awaitingNameEntry = false;
+    std::string nameBuffer;
+    int bestScore = 0;
+    std::string bestName;
+    int scoreRank = 0;
+
+    bool suspendedSession = false;
+};
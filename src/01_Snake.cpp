@@ -1,10 +1,33 @@
 #include "Snake.hpp"
 
+namespace {
+
+template <typename Body>
+void drawBody(sf::RenderTarget& window, const Body& body, int blockSize, sf::Color color) {
+    sf::RectangleShape rect({(float)blockSize, (float)blockSize});
+    rect.setFillColor(color);
+    // Draw body and tail first
+    for (size_t i = 1; i < body.size(); ++i) {
+        rect.setPosition((float)(body[i].x * blockSize), (float)(body[i].y * blockSize));
+        rect.setFillColor(color);
+        window.draw(rect);
+    }
+    // Draw head last so it stays on top
+    if (!body.empty()) {
+        rect.setPosition((float)(body[0].x * blockSize), (float)(body[0].y * blockSize));
+        sf::Color darkColor(color.r / 2, color.g / 2, color.b / 2);
+        rect.setFillColor(darkColor);
+        window.draw(rect);
+    }
+}
+
+}
+
 Snake::Snake(int startX, int startY, sf::Color col)
     : color(col), direction({0, -1}), nextDirection({0, -1}) {
-    body.push_back({startX, startY});        // head
-    body.push_back({startX, startY + 1});    // body
-    body.push_back({startX, startY + 2});    // tail
+    body.pushBack({startX, startY});        // head
+    body.pushBack({startX, startY + 1});    // body
+    body.pushBack({startX, startY + 2});    // tail
 }
 
 void Snake::changeDirection(int dx, int dy) {
@@ -24,26 +47,16 @@ void Snake::update() {
     Cell head = body.front();
     Cell newHead{head.x + direction.x, head.y + direction.y};
     
-    body.insert(body.begin(), newHead);
-    body.pop_back();
+    body.pushFront(newHead);
+    body.popBack();
 }
 
-void Snake::draw(sf::RenderWindow& window, int blockSize) {
-    sf::RectangleShape rect({(float)blockSize, (float)blockSize});
-    rect.setFillColor(color);
-    // Draw body and tail first
-    for (size_t i = 1; i < body.size(); ++i) {
-        rect.setPosition((float)(body[i].x * blockSize), (float)(body[i].y * blockSize));
-        rect.setFillColor(color);
-        window.draw(rect);
-    }
-    // Draw head last so it stays on top
-    if (!body.empty()) {
-        rect.setPosition((float)(body[0].x * blockSize), (float)(body[0].y * blockSize));
-        sf::Color darkColor(color.r / 2, color.g / 2, color.b / 2);
-        rect.setFillColor(darkColor);
-        window.draw(rect);
-    }
+void Snake::draw(sf::RenderTarget& window, int blockSize) {
+    drawBody(window, body, blockSize, color);
+}
+
+void Snake::drawCells(sf::RenderTarget& window, const std::vector<Cell>& body, int blockSize, sf::Color color) {
+    drawBody(window, body, blockSize, color);
 }
 
 bool Snake::checkSelfCollision() const {
@@ -58,28 +71,28 @@ bool Snake::checkSelfCollision() const {
 
 void Snake::grow() {
     Cell tail = body.back();
-    body.push_back(tail);
+    body.pushBack(tail);
 }
 
 void Snake::growAt(const Cell& pos) {
-    body.push_back(pos);
+    body.pushBack(pos);
 }
 
 void Snake::setBody(const std::vector<Cell>& b) {
-    body = b;
+    body.assign(b);
 }
 
 void Snake::shrinkTo(int len) {
     if (len < 1) len = 1;
     if ((int)body.size() <= len) return;
-    body.resize((size_t)len);
+    body.truncate((size_t)len);
 }
 
 void Snake::reset(int startX, int startY) {
     body.clear();
-    body.push_back({startX, startY});        // head
-    body.push_back({startX, startY + 1});    // body
-    body.push_back({startX, startY + 2});    // tail
+    body.pushBack({startX, startY});        // head
+    body.pushBack({startX, startY + 1});    // body
+    body.pushBack({startX, startY + 2});    // tail
     direction = {0, -1};
     nextDirection = {0, -1};
 }
@@ -1,6 +1,10 @@
 #include "Barrier.hpp"
-#include <iostream>
-#include <fstream>
+#include "Profiler.hpp"
+#include "AssetManager.hpp"
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 
 Barrier::Barrier(int minX, int minY, int maxX, int maxY)
     : minX(minX), minY(minY), maxX(maxX), maxY(maxY) {
@@ -9,6 +13,7 @@ Barrier::Barrier(int minX, int minY, int maxX, int maxY)
 
 void Barrier::buildWalls() {
     walls.clear();
+    version++;
     // Pared superior
     for (int x = minX; x <= maxX; ++x) {
         walls.push_back({x, minY});
@@ -30,13 +35,14 @@ void Barrier::buildWalls() {
     }
 }
 
-void Barrier::draw(sf::RenderWindow& window, int blockSize) {
+void Barrier::draw(sf::RenderTarget& window, int blockSize) {
+    PROFILE_ZONE("Barrier::draw");
     // If texture is loaded, draw with sprite; otherwise fallback to rectangles
-    if (wallTexture.getSize().x > 0) {
+    if (wallTexture && wallTexture->getSize().x > 0) {
         // Draw using texture sprite
         for (const auto& wall : walls) {
-            sf::Sprite sprite(wallTexture);
-            sf::Vector2u ts = wallTexture.getSize();
+            sf::Sprite sprite(*wallTexture);
+            sf::Vector2u ts = wallTexture->getSize();
             float texW = (float)ts.x;
             float texH = (float)ts.y;
             float sizeInPixels = (float)blockSize;
@@ -68,8 +74,172 @@ bool Barrier::checkCollision(const Cell& pos) const {
     return false;
 }
 
-// Generate internal random walls with dense patterns, closed structures, and traps
+namespace {
+
+struct GenBounds { int minXg, minYg, maxXg, maxYg, gridWidth, gridHeight; };
+using OccGrid = std::vector<std::vector<bool>>;
+
+// Cells reachable from (sx, sy) through free cells (BFS)
+int connectivity(const OccGrid& occ, int gridWidth, int gridHeight, int sx, int sy) {
+    std::vector<std::vector<char>> seen(gridWidth, std::vector<char>(gridHeight, 0));
+    std::vector<Cell> q;
+    if (sx < 0 || sx >= gridWidth || sy < 0 || sy >= gridHeight) return 0;
+    if (occ[sx][sy]) return 0;
+    q.push_back({sx, sy});
+    seen[sx][sy] = 1;
+    size_t idx = 0;
+    while (idx < q.size()) {
+        Cell c = q[idx++];
+        const int dx[4] = {1,-1,0,0};
+        const int dy[4] = {0,0,1,-1};
+        for (int i=0;i<4;++i) {
+            int nx = c.x + dx[i];
+            int ny = c.y + dy[i];
+            if (nx<0||ny<0||nx>=gridWidth||ny>=gridHeight) continue;
+            if (seen[nx][ny]) continue;
+            if (occ[nx][ny]) continue;
+            seen[nx][ny]=1;
+            q.push_back({nx,ny});
+        }
+    }
+    return (int)q.size();
+}
+
+// One candidate layout: lines with gaps plus a few pillars, placed on top of
+// occLocal (border + forbidden cells); the new walls go to newWalls.
+void generateCandidate(std::mt19937& rng, const GenBounds& b, OccGrid& occLocal, std::vector<Cell>& newWalls) {
+    const int minXg = b.minXg, minYg = b.minYg, maxXg = b.maxXg, maxYg = b.maxYg;
+    // === Generate fewer lines and pillars (reduce density) ===
+    int numLines = std::uniform_int_distribution<int>(2, 4)(rng); // menos líneas
+    for (int l = 0; l < numLines; ++l) {
+        int dir = std::uniform_int_distribution<int>(0, 2)(rng); // 0=horizontal, 1=vertical, 2=diagonal
+
+        if (dir == 0) {
+            // Horizontal line
+            int y = std::uniform_int_distribution<int>(minYg, maxYg)(rng);
+            int xStart = minXg;
+            int xEnd = maxXg;
+            int lineLength = xEnd - xStart + 1;
+            int minGaps = std::max(5, lineLength / 4); // Más huecos
+            int numGaps = std::uniform_int_distribution<int>(minGaps, minGaps + 3)(rng);
+            std::vector<int> gapPos;
+            for (int g = 0; g < numGaps; ++g) {
+                gapPos.push_back(std::uniform_int_distribution<int>(xStart, xEnd)(rng));
+            }
+            for (int x = xStart; x <= xEnd; ++x) {
+                bool isGap = false;
+                for (int gx : gapPos) if (x == gx) { isGap = true; break; }
+                if (!isGap && !occLocal[x][y]) {
+                    bool canPlace = true;
+                    for (int dy = -2; dy <= 2; ++dy) {
+                        if (dy == 0) continue;
+                        int checkY = y + dy;
+                        if (checkY >= minYg && checkY <= maxYg && occLocal[x][checkY]) {
+                            canPlace = false;
+                            break;
+                        }
+                    }
+                    if (canPlace) {
+                        if (x > minXg && occLocal[x-1][y]) canPlace = false;
+                        if (x < maxXg && occLocal[x+1][y]) canPlace = false;
+                    }
+                    if (canPlace) {
+                        occLocal[x][y] = true;
+                        newWalls.push_back({x, y});
+                    }
+                }
+            }
+        } else if (dir == 1) {
+            // Vertical line
+            int x = std::uniform_int_distribution<int>(minXg, maxXg)(rng);
+            int yStart = minYg;
+            int yEnd = maxYg;
+            int lineLength = yEnd - yStart + 1;
+            int minGaps = std::max(5, lineLength / 4);
+            int numGaps = std::uniform_int_distribution<int>(minGaps, minGaps + 3)(rng);
+            std::vector<int> gapPos;
+            for (int g = 0; g < numGaps; ++g) {
+                gapPos.push_back(std::uniform_int_distribution<int>(yStart, yEnd)(rng));
+            }
+            for (int y = yStart; y <= yEnd; ++y) {
+                bool isGap = false;
+                for (int gy : gapPos) if (y == gy) { isGap = true; break; }
+                if (!isGap && !occLocal[x][y]) {
+                    bool canPlace = true;
+                    for (int dx = -2; dx <= 2; ++dx) {
+                        if (dx == 0) continue;
+                        int checkX = x + dx;
+                        if (checkX >= minXg && checkX <= maxXg && occLocal[checkX][y]) {
+                            canPlace = false;
+                            break;
+                        }
+                    }
+                    if (canPlace) {
+                        if (y > minYg && occLocal[x][y-1]) canPlace = false;
+                        if (y < maxYg && occLocal[x][y+1]) canPlace = false;
+                    }
+                    if (canPlace) {
+                        occLocal[x][y] = true;
+                        newWalls.push_back({x, y});
+                    }
+                }
+            }
+        } else {
+            // Diagonal line
+            int startX = std::uniform_int_distribution<int>(minXg, maxXg)(rng);
+            int startY = std::uniform_int_distribution<int>(minYg, maxYg)(rng);
+            int diagDir = std::uniform_int_distribution<int>(0, 3)(rng); // 0=NE, 1=NW, 2=SE, 3=SW
+            std::vector<Cell> diagCells;
+            int x = startX, y = startY;
+            int dx = 0, dy = 0;
+            if (diagDir == 0) { dx = 1; dy = -1; }
+            else if (diagDir == 1) { dx = -1; dy = -1; }
+            else if (diagDir == 2) { dx = 1; dy = 1; }
+            else { dx = -1; dy = 1; }
+            while (x >= minXg && x <= maxXg && y >= minYg && y <= maxYg) {
+                diagCells.push_back({x, y});
+                x += dx;
+                y += dy;
+            }
+            int diagLength = (int)diagCells.size();
+            int minGaps = std::max(3, diagLength / 4);
+            int numGaps = std::uniform_int_distribution<int>(minGaps, minGaps + 2)(rng);
+            std::vector<int> gapIndices;
+            for (int g = 0; g < numGaps && diagLength > 0; ++g) {
+                gapIndices.push_back(std::uniform_int_distribution<int>(0, diagLength - 1)(rng));
+            }
+            for (int i = 0; i < (int)diagCells.size(); ++i) {
+                bool isGap = false;
+                for (int gi : gapIndices) if (i == gi) { isGap = true; break; }
+                if (!isGap && !occLocal[diagCells[i].x][diagCells[i].y]) {
+                    occLocal[diagCells[i].x][diagCells[i].y] = true;
+                    newWalls.push_back(diagCells[i]);
+                }
+            }
+        }
+    }
+
+    // === Add scattered single pillars (menos y más dispersos) ===
+    int numPillars = std::uniform_int_distribution<int>(1, 3)(rng); // menos pilares
+    for (int p = 0; p < numPillars; ++p) {
+        int px = std::uniform_int_distribution<int>(minXg, maxXg)(rng);
+        int py = std::uniform_int_distribution<int>(minYg, maxYg)(rng);
+        if (px >= minXg && px <= maxXg && py >= minYg && py <= maxYg && !occLocal[px][py]) {
+            occLocal[px][py] = true;
+            newWalls.push_back({px, py});
+        }
+    }
+
+}
+
+} // namespace
+
+// Generate internal random walls with dense patterns, closed structures, and traps.
+// Candidate layouts are built in parallel on the JobSystem; the lowest-numbered
+// one that keeps enough of the board reachable wins, so the result only
+// depends on rng, not on thread timing.
 void Barrier::generateRandom(std::mt19937 &rng, int gridWidth, int gridHeight, const std::vector<Cell>& forbidden) {
+    PROFILE_ZONE("map generation");
     // Start with border
     buildWalls();
 
@@ -82,212 +252,89 @@ void Barrier::generateRandom(std::mt19937 &rng, int gridWidth, int gridHeight, c
     if (minXg > maxXg || minYg > maxYg) return;
 
     // occupancy grid
-    std::vector<std::vector<bool>> occ(gridWidth, std::vector<bool>(gridHeight, false));
+    OccGrid occ(gridWidth, std::vector<bool>(gridHeight, false));
     for (const auto &w : walls) occ[w.x][w.y] = true;
     for (const auto &f : forbidden) if (f.x >= 0 && f.x < gridWidth && f.y >= 0 && f.y < gridHeight) occ[f.x][f.y] = true;
+    // Reachability is measured with only the walls blocking (the forbidden
+    // cells are usually the snake), from the snake's head when there is one
+    OccGrid wallsOnly(gridWidth, std::vector<bool>(gridHeight, false));
+    for (const auto &w : walls) wallsOnly[w.x][w.y] = true;
+    int sx = (minXg + maxXg) / 2;
+    int sy = (minYg + maxYg) / 2;
+    if (!forbidden.empty() && forbidden.front().x >= minXg && forbidden.front().x <= maxXg &&
+        forbidden.front().y >= minYg && forbidden.front().y <= maxYg) {
+        sx = forbidden.front().x;
+        sy = forbidden.front().y;
+    }
 
-    // Helper to test connectivity from center (BFS)
-    auto connectivity = [&](int sx, int sy)->int {
-        std::vector<std::vector<char>> seen(gridWidth, std::vector<char>(gridHeight, 0));
-        std::vector<Cell> q;
-        if (sx < 0 || sx >= gridWidth || sy < 0 || sy >= gridHeight) return 0;
-        if (occ[sx][sy]) return 0;
-        q.push_back({sx, sy});
-        seen[sx][sy] = 1;
-        size_t idx = 0;
-        while (idx < q.size()) {
-            Cell c = q[idx++];
-            const int dx[4] = {1,-1,0,0};
-            const int dy[4] = {0,0,1,-1};
-            for (int i=0;i<4;++i) {
-                int nx = c.x + dx[i];
-                int ny = c.y + dy[i];
-                if (nx<0||ny<0||nx>=gridWidth||ny>=gridHeight) continue;
-                if (seen[nx][ny]) continue;
-                if (occ[nx][ny]) continue;
-                seen[nx][ny]=1;
-                q.push_back({nx,ny});
-            }
-        }
-        return (int)q.size();
-    };
-
+    const GenBounds bounds{minXg, minYg, maxXg, maxYg, gridWidth, gridHeight};
     int gridCells = (maxXg - minXg + 1) * (maxYg - minYg + 1);
-    int bestTry = 0;
-    std::vector<Cell> bestWalls = walls;
-
-    // Try multiple generations with different densities
-    for (int attempt = 0; attempt < 20; ++attempt) {
-        auto occLocal = occ;
-        std::vector<Cell> newWalls;
+    const int ATTEMPTS = 20;
 
-        // === Generate fewer lines and pillars (reduce density) ===
-        int numLines = std::uniform_int_distribution<int>(2, 4)(rng); // menos líneas
-        for (int l = 0; l < numLines; ++l) {
-            int dir = std::uniform_int_distribution<int>(0, 2)(rng); // 0=horizontal, 1=vertical, 2=diagonal
+    // Seeds are drawn up front so every candidate is reproducible
+    struct Candidate { std::uint32_t seed; std::vector<Cell> walls; int reachable = -1; };
+    std::vector<Candidate> candidates(ATTEMPTS);
+    for (auto &c : candidates) c.seed = (std::uint32_t)rng();
+    std::atomic<int> firstPass{ATTEMPTS};
 
-            if (dir == 0) {
-                // Horizontal line
-                int y = std::uniform_int_distribution<int>(minYg, maxYg)(rng);
-                int xStart = minXg;
-                int xEnd = maxXg;
-                int lineLength = xEnd - xStart + 1;
-                int minGaps = std::max(5, lineLength / 4); // Más huecos
-                int numGaps = std::uniform_int_distribution<int>(minGaps, minGaps + 3)(rng);
-                std::vector<int> gapPos;
-                for (int g = 0; g < numGaps; ++g) {
-                    gapPos.push_back(std::uniform_int_distribution<int>(xStart, xEnd)(rng));
-                }
-                for (int x = xStart; x <= xEnd; ++x) {
-                    bool isGap = false;
-                    for (int gx : gapPos) if (x == gx) { isGap = true; break; }
-                    if (!isGap && !occLocal[x][y]) {
-                        bool canPlace = true;
-                        for (int dy = -2; dy <= 2; ++dy) {
-                            if (dy == 0) continue;
-                            int checkY = y + dy;
-                            if (checkY >= minYg && checkY <= maxYg && occLocal[x][checkY]) {
-                                canPlace = false;
-                                break;
-                            }
-                        }
-                        if (canPlace) {
-                            if (x > minXg && occLocal[x-1][y]) canPlace = false;
-                            if (x < maxXg && occLocal[x+1][y]) canPlace = false;
-                        }
-                        if (canPlace) {
-                            occLocal[x][y] = true;
-                            newWalls.push_back({x, y});
-                        }
-                    }
-                }
-            } else if (dir == 1) {
-                // Vertical line
-                int x = std::uniform_int_distribution<int>(minXg, maxXg)(rng);
-                int yStart = minYg;
-                int yEnd = maxYg;
-                int lineLength = yEnd - yStart + 1;
-                int minGaps = std::max(5, lineLength / 4);
-                int numGaps = std::uniform_int_distribution<int>(minGaps, minGaps + 3)(rng);
-                std::vector<int> gapPos;
-                for (int g = 0; g < numGaps; ++g) {
-                    gapPos.push_back(std::uniform_int_distribution<int>(yStart, yEnd)(rng));
-                }
-                for (int y = yStart; y <= yEnd; ++y) {
-                    bool isGap = false;
-                    for (int gy : gapPos) if (y == gy) { isGap = true; break; }
-                    if (!isGap && !occLocal[x][y]) {
-                        bool canPlace = true;
-                        for (int dx = -2; dx <= 2; ++dx) {
-                            if (dx == 0) continue;
-                            int checkX = x + dx;
-                            if (checkX >= minXg && checkX <= maxXg && occLocal[checkX][y]) {
-                                canPlace = false;
-                                break;
-                            }
-                        }
-                        if (canPlace) {
-                            if (y > minYg && occLocal[x][y-1]) canPlace = false;
-                            if (y < maxYg && occLocal[x][y+1]) canPlace = false;
-                        }
-                        if (canPlace) {
-                            occLocal[x][y] = true;
-                            newWalls.push_back({x, y});
-                        }
-                    }
-                }
-            } else {
-                // Diagonal line
-                int startX = std::uniform_int_distribution<int>(minXg, maxXg)(rng);
-                int startY = std::uniform_int_distribution<int>(minYg, maxYg)(rng);
-                int diagDir = std::uniform_int_distribution<int>(0, 3)(rng); // 0=NE, 1=NW, 2=SE, 3=SW
-                std::vector<Cell> diagCells;
-                int x = startX, y = startY;
-                int dx = 0, dy = 0;
-                if (diagDir == 0) { dx = 1; dy = -1; }
-                else if (diagDir == 1) { dx = -1; dy = -1; }
-                else if (diagDir == 2) { dx = 1; dy = 1; }
-                else { dx = -1; dy = 1; }
-                while (x >= minXg && x <= maxXg && y >= minYg && y <= maxYg) {
-                    diagCells.push_back({x, y});
-                    x += dx;
-                    y += dy;
-                }
-                int diagLength = (int)diagCells.size();
-                int minGaps = std::max(3, diagLength / 4);
-                int numGaps = std::uniform_int_distribution<int>(minGaps, minGaps + 2)(rng);
-                std::vector<int> gapIndices;
-                for (int g = 0; g < numGaps && diagLength > 0; ++g) {
-                    gapIndices.push_back(std::uniform_int_distribution<int>(0, diagLength - 1)(rng));
-                }
-                for (int i = 0; i < (int)diagCells.size(); ++i) {
-                    bool isGap = false;
-                    for (int gi : gapIndices) if (i == gi) { isGap = true; break; }
-                    if (!isGap && !occLocal[diagCells[i].x][diagCells[i].y]) {
-                        occLocal[diagCells[i].x][diagCells[i].y] = true;
-                        newWalls.push_back(diagCells[i]);
-                    }
-                }
+    JobSystem::instance().parallelFor(0, ATTEMPTS, 1, [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            // A lower candidate already passed: this one can't win
+            if (i > firstPass.load(std::memory_order_relaxed)) continue;
+            PROFILE_ZONE("map candidate");
+            Candidate& c = candidates[(size_t)i];
+            std::mt19937 local(c.seed);
+            OccGrid occLocal = occ;
+            generateCandidate(local, bounds, occLocal, c.walls);
+            OccGrid blocked = wallsOnly;
+            for (const auto &cw : c.walls) blocked[cw.x][cw.y] = true;
+            c.reachable = connectivity(blocked, gridWidth, gridHeight, sx, sy);
+            // Lower threshold: require ~55% reachable space instead of 75%
+            if (c.reachable >= gridCells * 0.55) {
+                int seen = firstPass.load(std::memory_order_relaxed);
+                while (i < seen && !firstPass.compare_exchange_weak(seen, i, std::memory_order_relaxed)) {}
             }
         }
+    });
 
-        // === Add scattered single pillars (menos y más dispersos) ===
-        int numPillars = std::uniform_int_distribution<int>(1, 3)(rng); // menos pilares
-        for (int p = 0; p < numPillars; ++p) {
-            int px = std::uniform_int_distribution<int>(minXg, maxXg)(rng);
-            int py = std::uniform_int_distribution<int>(minYg, maxYg)(rng);
-            if (px >= minXg && px <= maxXg && py >= minYg && py <= maxYg && !occLocal[px][py]) {
-                occLocal[px][py] = true;
-                newWalls.push_back({px, py});
+    int winner = firstPass.load();
+    if (winner == ATTEMPTS) {
+        // If no good candidate, use best
+        int bestTry = 0;
+        for (int i = 0; i < ATTEMPTS; ++i) {
+            if (candidates[(size_t)i].reachable > bestTry) {
+                bestTry = candidates[(size_t)i].reachable;
+                winner = i;
             }
         }
-
-        // Test connectivity: accept lower connectivity to allow sparser maps
-        int sx = (minXg + maxXg) / 2;
-        int sy = (minYg + maxYg) / 2;
-        int reachable = connectivity(sx, sy);
-        if (reachable > bestTry) {
-            bestTry = reachable;
-            bestWalls = walls;
-            for (auto &cw : newWalls) bestWalls.push_back(cw);
-        }
-        // Lower threshold: require ~55% reachable space instead of 75%
-        if (reachable >= gridCells * 0.55) {
-            for (auto &cw : newWalls) walls.push_back(cw);
-            return;
-        }
+        if (winner == ATTEMPTS) return;
     }
+    for (auto &cw : candidates[(size_t)winner].walls) walls.push_back(cw);
+}
 
-    // If no good candidate, use best
-    if (bestTry > 0) {
-        walls = bestWalls;
+void Barrier::portalSafeArea(int ex, int ey, int length, bool column, int gridWidth, int gridHeight, std::vector<Cell>& out) {
+    out.clear();
+    if (!column) {
+        for (int dx = -1; dx <= 1; ++dx)
+            for (int dy = -1; dy <= 1; ++dy)
+                out.push_back({ex + dx, ey + dy});
+        return;
     }
+    for (int i = 0; i < length; ++i) {
+        Cell c{ex, ey - i};
+        out.push_back(c);
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                Cell adj{c.x + dx, c.y + dy};
+                if (adj.x >= 0 && adj.x < gridWidth && adj.y >= 0 && adj.y < gridHeight) out.push_back(adj);
+            }
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const Cell& a, const Cell& b) { return a.x == b.x ? a.y < b.y : a.x < b.x; });
+    out.erase(std::unique(out.begin(), out.end()), out.end());
 }
 
 void Barrier::loadTexture(const std::string& path) {
-    auto findAssetPath = [&](const std::string &p)->std::string {
-        std::ifstream f(p);
-        if (f.good()) { f.close(); return p; }
-        if (p.rfind("../", 0) == 0) {
-            std::string alt = p.substr(3);
-            std::ifstream f2(alt);
-            if (f2.good()) { f2.close(); return alt; }
-        } else {
-            std::string alt = std::string("../") + p;
-            std::ifstream f2(alt);
-            if (f2.good()) { f2.close(); return alt; }
-        }
-        return std::string();
-    };
-    
-    std::string candidate = findAssetPath(path);
-    if (!candidate.empty()) {
-        if (wallTexture.loadFromFile(candidate)) {
-            std::cout << "Loaded wall texture: " << candidate << "\n";
-        } else {
-            std::cerr << "Failed to load wall texture from: " << candidate << "\n";
-        }
-    } else {
-        std::cerr << "Wall texture file not found: " << path << "\n";
-    }
+    // Walls are visible behind the menu, so they load with the first batch
+    wallTexture = AssetManager::instance().textureAsync(path, LoadPriority::Critical);
 }
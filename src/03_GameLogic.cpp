@@ -4,10 +4,18 @@
 #include <algorithm>
 #include <cstdio>
 #include <cmath>
+#include <cstdlib>
 #include <vector>
 #include <fstream>
 #include <sstream>
 #include <random>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include "SaveState.hpp"
+#include "BodyCodec.hpp"
+#include "Profiler.hpp"
+#include "Log.hpp"
 
 // ... rest of the file ...
 
@@ -15,33 +23,19 @@ void GameLogic::spawnFood() {
     // Do not spawn fruits if portal entrance is active
     if (portalEntrance.active) return;
 
-    // Spawn a common Gomu fruit at a valid position
-    std::uniform_int_distribution<int> distX(barriers.getMinX() + 1, barriers.getMaxX() - 1);
-    std::uniform_int_distribution<int> distY(barriers.getMinY() + 1, barriers.getMaxY() - 1);
-
+    // Spawn a common Gomu fruit where the snake can reach it
     Fruit f;
-    bool valid = false;
-    int attempts = 0;
-    while (!valid && attempts < 100) {
-        f.x = distX(rng);
-        f.y = distY(rng);
-        valid = true;
-        for (const auto &cell : snake.getBody()) {
-            if (cell.x == f.x && cell.y == f.y) { valid = false; break; }
-        }
-        for (const auto &of : fruits) {
-            if (of.x == f.x && of.y == f.y) { valid = false; break; }
-        }
-        if (barriers.checkCollision({f.x, f.y})) valid = false;
-        attempts++;
-    }
-    if (!valid) return;
+    Cell c;
+    if (!randomOpenCell(c)) return;
+    f.x = c.x;
+    f.y = c.y;
     f.type = Fruit::Type::Gomu;
     f.spawnTime = startClock.getElapsedTime().asSeconds() - pausedAccumSeconds;
     f.duration = 0.f;
     fruits.push_back(f);
 }
 #include "GameLogic.hpp"
+#include "AssetManager.hpp"
 #include <iostream>
 #include <ctime>
 #include <algorithm>
@@ -56,79 +50,59 @@ GameLogic::GameLogic(int gridWidth, int gridHeight, int blockSize)
     : gridWidth(gridWidth), gridHeight(gridHeight), blockSize(blockSize),
       snake(gridWidth/2, gridHeight/2, sf::Color::Green),
       barriers(2, 2, gridWidth-3, gridHeight-3),
-      score(0), gameOver(false)
+      wallView(2, 2, gridWidth-3, gridHeight-3),
+      score(0), gameOver(false),
+      traps(gridWidth, gridHeight)
 {
-    // Definir lambda para buscar archivos en assets
-    auto findAssetPath = [&](const std::string &p)->std::string {
-        std::ifstream f(p);
-        if (f.good()) { f.close(); return p; }
-        if (p.rfind("../", 0) == 0) {
-            std::string alt = p.substr(3);
-            std::ifstream f2(alt);
-            if (f2.good()) { f2.close(); return alt; }
-        } else {
-            std::string alt = std::string("../") + p;
-            std::ifstream f2(alt);
-            if (f2.good()) { f2.close(); return alt; }
-        }
-        return std::string();
-    };
+    AssetManager& assets = AssetManager::instance();
+    rng.seed((unsigned)time(nullptr));
+
+    // Images are decoded in parallel by the AssetManager: first what the menu
+    // shows (walls, key icons), then the gameplay sprites in the background.
+    wallView.loadTexture("assets/images/muro.jpeg");
+    loadFruitTextures();
 
     // Cargar textura de portal
-    std::string portalPath = findAssetPath("assets/images/portal.png");
-    if (!portalPath.empty()) {
-        if (portalTexture.loadFromFile(portalPath)) {
-            std::cout << "Loaded portal texture: " << portalPath << "\n";
-        } else {
-            std::cerr << "Failed to load portal texture from: " << portalPath << "\n";
-        }
-    } else {
-        std::cerr << "portal.png not found in candidates\n";
-    }
-    rng.seed((unsigned)time(nullptr));
+    portalTexture = assets.textureAsync("images/portal.png", LoadPriority::Background);
 
-    // Load weedle sprites (head, body_1-4, tail)
-    if (renderer.loadSprites()) {
-        std::cout << "Weedle sprites loaded successfully\n";
-    } else {
-        std::cout << "Failed to load some weedle sprites\n";
+    // Load weedle sprites (head, body, tail)
+    if (!renderer.loadSprites()) {
+        std::cout << "Failed to find some weedle sprites\n";
     }
 
     // Set sprite scale for renderer
     renderer.setSpriteScale(spriteScale);
 
-    // Load wall texture for barriers
-    barriers.loadTexture("assets/images/muro.jpeg");
-
-    std::string fontPath = findAssetPath("assets/fonts/Minecraft.ttf");
-    if (fontPath.empty()) fontPath = findAssetPath("assets/fonts/HOMOARAK.TTF");
-    if (!fontPath.empty() && uiFont.loadFromFile(fontPath)) {
-        std::cout << "Loaded UI font: " << fontPath << "\n";
-    } else {
-        std::cerr << "Failed to load UI font from assets/fonts\n";
-    }
-    scoreText.setFont(uiFont);
+    uiFont = assets.font(assets.exists("fonts/Minecraft.ttf") ? "fonts/Minecraft.ttf" : "fonts/HOMOARAK.TTF");
+    scoreText.setFont(*uiFont);
     scoreText.setFillColor(sf::Color::White);
     scoreText.setOutlineColor(sf::Color::Black);
     scoreText.setOutlineThickness(2.f);
     scoreText.setCharacterSize(std::max(24, (int)(blockSize * 1.25f)));
     scoreText.setStyle(sf::Text::Bold);
 
-    timerText.setFont(uiFont);
+    timerText.setFont(*uiFont);
     timerText.setFillColor(sf::Color::White);
     timerText.setOutlineColor(sf::Color::Black);
     timerText.setOutlineThickness(2.f);
     timerText.setCharacterSize(std::max(24, (int)(blockSize * 1.25f)));
     timerText.setStyle(sf::Text::Bold);
 
-    fruitTimerText.setFont(uiFont);
+    fruitTimerText.setFont(*uiFont);
     fruitTimerText.setFillColor(sf::Color::White);
     fruitTimerText.setOutlineColor(sf::Color::Black);
     fruitTimerText.setOutlineThickness(2.f);
     fruitTimerText.setCharacterSize(std::max(20, (int)(blockSize * 1.0f)));
     fruitTimerText.setStyle(sf::Text::Bold);
-
-    countdownText.setFont(uiFont);
+    trappedText.setFont(*uiFont);
+    trappedText.setString("Trapped!");
+    trappedText.setFillColor(sf::Color(255, 80, 80));
+    trappedText.setOutlineColor(sf::Color::Black);
+    trappedText.setOutlineThickness(2.f);
+    trappedText.setCharacterSize(std::max(20, (int)(blockSize * 1.0f)));
+    trappedText.setStyle(sf::Text::Bold);
+
+    countdownText.setFont(*uiFont);
     countdownText.setFillColor(sf::Color::Yellow);
     countdownText.setOutlineColor(sf::Color::Black);
     countdownText.setOutlineThickness(3.f);
@@ -140,47 +114,275 @@ GameLogic::GameLogic(int gridWidth, int gridHeight, int blockSize)
     paused = false;
     state = State::Menu;
 
-    // Load title font (HOMOARAK) separately (try both)
-    std::string titlePath = findAssetPath("assets/fonts/HOMOARAK.TTF");
-    if (!titlePath.empty() && titleFont.loadFromFile(titlePath)) {
-        std::cout << "Loaded title font: " << titlePath << "\n";
-    } else {
-        std::cerr << "Failed to load title font (HOMOARAK)\n";
-    }
+    // Load title font (HOMOARAK) separately
+    titleFont = assets.font("fonts/HOMOARAK.TTF");
+
+    // Background music is opened by startMusic() once the first frame is up
+    // initialize fruit countdown and update tracker
+    fruitCountdown = 20.f;
+    lastUpdateSeconds = 0.f;
+
+    // A session suspended on the last exit can be continued from the menu
+    suspendedSession = std::ifstream(SESSION_FILE, std::ios::binary).good();
+
+    // The render thread needs a snapshot before the simulation starts
+    publishSnapshot();
+    consumeSnapshot();
+}
 
-    // Load background music if present
-    // Load music using findAssetPath helper
-    std::string musicPath = findAssetPath("assets/music/snow_city.mp3");
-    if (!musicPath.empty() && music.openFromFile(musicPath)) {
+void GameLogic::startMusic() {
+    if (music.getStatus() == sf::SoundSource::Playing) return;
+    // Load background music if present (streamed from the pack or the loose file)
+    if (AssetManager::instance().openMusic(music, "music/snow_city.mp3")) {
         music.setLoop(true);
         music.setVolume(50.f);
         music.play();
-        std::cout << "Background music loaded and playing: " << musicPath << "\n";
+        std::cout << "Background music loaded and playing\n";
     } else {
         std::cout << "Background music not found or failed to load\n";
     }
-    // Load fruit textures and high score
-    loadFruitTextures();
-    loadHighScore();
-    // initialize fruit countdown and update tracker
-    fruitCountdown = 20.f;
-    lastUpdateSeconds = 0.f;
+}
+
+void GameLogic::runSimulation(float tickSeconds, const std::atomic<bool>& running) {
+    using SimClock = std::chrono::steady_clock;
+    const auto tick = std::chrono::duration_cast<SimClock::duration>(std::chrono::duration<float>(tickSeconds));
+    auto nextTick = SimClock::now() + tick;
+    while (true) {
+        // Read the flag first so input queued before shutdown is still applied
+        bool stop = !running.load(std::memory_order_acquire);
+        InputCommand cmd;
+        while (inputQueue.pop(cmd)) applyInput(cmd);
+        if (stop) break;
+
+        auto now = SimClock::now();
+        if (now >= nextTick) {
+            update();
+            if (broadcaster) recordCast();
+            nextTick += tick;
+            // Stalled (debugger, suspended laptop): don't replay the backlog
+            if (now - nextTick > tick * 5) nextTick = now + tick;
+        }
+        advanceScoreAnimation();
+        if (revision != publishedRevision) publishSnapshot();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    if (revision != publishedRevision) publishSnapshot();
+}
+
+void GameLogic::applyInput(const InputCommand& cmd) {
+    if (cmd.type == InputCommand::Type::Steer) {
+        if (state == State::Playing && !showCountdown && !autopilot) {
+            // Only the queued direction changes; nothing to republish
+            snake.changeDirection(cmd.dx, cmd.dy);
+        }
+        return;
+    }
+
+    const sf::Event& event = cmd.event;
+    revision++;
+    // Give game a chance to process events (text input for name entry)
+    processEvent(event);
+
+    if (event.type == sf::Event::Closed) {
+        // Suspend the running session so it can be continued next launch
+        if (hasSession()) suspendToFile(SESSION_FILE);
+        return;
+    }
+    if (event.type != sf::Event::KeyPressed) return;
+    if (event.key.code == sf::Keyboard::R && canRestart()) {
+        reset();
+    }
+    if (event.key.code == sf::Keyboard::Escape) {
+        if (hasSession()) suspendToFile(SESSION_FILE);
+    }
+    if (event.key.code == sf::Keyboard::P) {
+        togglePause();
+    }
+    if (event.key.code == sf::Keyboard::Enter) {
+        if (isMenu()) {
+            startGame();
+        } else if (isGameOver()) {
+            reset();
+            startGame();
+        } else if (isPaused()) {
+            // allow Enter to resume from pause
+            togglePause();
+        }
+    }
+}
+
+// Game over count-up: base score + time bonus, one point every 20 ms
+void GameLogic::advanceScoreAnimation() {
+    if (state != State::GameOver || scoreAnimationDone) return;
+    if (scoreAnimClock.getElapsedTime().asSeconds() < 0.02f) return;
+    scoreAnimClock.restart();
+    revision++;
+    if (timeBonusRemaining > 0) {
+        // increment animated score by 1 and decrement bonus
+        animatedScore += 1;
+        timeBonusRemaining -= 1;
+        return;
+    }
+    // animation finished
+    scoreAnimationDone = true;
+    score = animatedScore; // commit final score
+    // if record, start name entry
+    if (qualifiesForLeaderboard(score)) {
+        awaitingNameEntry = true;
+        nameBuffer.clear();
+    }
+}
+
+void GameLogic::publishSnapshot() {
+    PROFILE_ZONE("publish snapshot");
+    WorldSnapshot& w = snapshots.write();
+    w.revision = revision;
+    w.state = state;
+    snake.getBody().copyTo(w.body);
+    w.direction = snake.getDirection();
+    w.fruits = fruits;
+    w.portalEntrance = portalEntrance;
+    w.portalExit = portalExit;
+    w.portalShowCountdown = portalShowCountdown;
+    if (w.wallsVersion != barriers.getVersion()) {
+        w.walls = barriers.getWalls();
+        w.wallsVersion = barriers.getVersion();
+    }
+
+    w.score = score;
+    w.displayElapsed = state == State::GameOver ? finalElapsedSeconds : currentPlaySeconds();
+    w.fruitCountdown = fruitCountdown;
+    w.trapped = trapped;
+    w.showCountdown = showCountdown;
+    w.countdownNumber = countdownNumber;
+
+    w.animatedScore = animatedScore;
+    w.timeBonusRemaining = timeBonusRemaining;
+    w.scoreAnimationDone = scoreAnimationDone;
+    w.finalElapsedSeconds = finalElapsedSeconds;
+    w.awaitingNameEntry = awaitingNameEntry;
+    w.nameBuffer = nameBuffer;
+    w.bestScore = leaderboard.bestScore();
+    w.bestName = leaderboard.bestName();
+    w.scoreRank = leaderboard.rankOf(score);
+    w.suspendedSession = suspendedSession;
+
+    snapshots.publish();
+    publishedRevision = revision;
+}
+
+void GameLogic::recordCast() {
+    PROFILE_ZONE("broadcast record");
+    castTick++;
+    castSinceKeyframe++;
+    cast::Replica& now = castNow;
+    now.tick = castTick;
+    now.gridWidth = gridWidth;
+    now.gridHeight = gridHeight;
+    now.state = state;
+    now.showCountdown = showCountdown;
+    now.portalShowCountdown = portalShowCountdown;
+    now.countdownNumber = countdownNumber;
+    now.score = state == State::GameOver ? animatedScore : score;
+    now.elapsed = state == State::GameOver ? finalElapsedSeconds : currentPlaySeconds();
+    now.fruitCountdown = fruitCountdown;
+    now.fruits = fruits;
+    now.portalEntrance = portalEntrance;
+    now.portalExit = portalExit;
+
+    // Where the motion says the snake is; anything else (new game, loaded
+    // session) changed it outside update() and needs a keyframe
+    const PackedBody& body = snake.getBody();
+    Cell head = castHead;
+    std::size_t length = castLength;
+    unsigned wallsVersion = castWallsVersion;
+    if (castMotion.teleport) {
+        head = {castMotion.exit.x, castMotion.exit.y - 1};
+        length = (std::size_t)castMotion.exitLength;
+        wallsVersion++;
+    } else if (castMotion.moved) {
+        head = {castHead.x + castMotion.direction.x, castHead.y + castMotion.direction.y};
+        if (castMotion.regrow) length++;
+    }
+    length += (std::size_t)castMotion.grown;
+    bool broken = castBroken || !(head == snake.getHead()) || length != body.size() ||
+                  wallsVersion != barriers.getVersion();
+    castHead = snake.getHead();
+    castLength = body.size();
+    castWallsVersion = barriers.getVersion();
+
+    if (!broken) {
+        net::ByteWriter w(castChange);
+        cast::writeChange(w, castTick, castMotion, castSeen, now);
+        // Ring full means the broadcaster is stuck: viewers resync from a keyframe
+        if (castChange.size() > (std::size_t)cast::RECORD_BYTES || !broadcaster->pushChange(castChange)) broken = true;
+    }
+    if (broken || castSinceKeyframe >= cast::KEYFRAME_TICKS) {
+        body.copyTo(now.body);
+        now.walls = barriers;
+        net::ByteWriter w(castKeyframe);
+        cast::writeKeyframe(w, now);
+        if (broadcaster->offerKeyframe(castKeyframe)) {
+            castSinceKeyframe = 0;
+            broken = false;
+        }
+    }
+    castBroken = broken;
+    std::swap(castSeen, castNow);
+}
+
+bool GameLogic::postEvent(const sf::Event& event) {
+    InputCommand cmd;
+    cmd.type = InputCommand::Type::Event;
+    cmd.event = event;
+    cmd.dx = cmd.dy = 0;
+    return inputQueue.push(cmd);
+}
+
+bool GameLogic::consumeSnapshot() {
+    if (!snapshots.update()) return false;
+    const WorldSnapshot& w = snapshots.read();
+    viewRevision = w.revision;
+    if (w.state != viewState) {
+        viewState = w.state;
+        viewStateClock.restart();
+        // Gameplay sprites normally finished decoding while the menu was
+        // shown; GL uploads have to happen here, on the render thread
+        if (viewState != State::Menu && AssetManager::instance().isLoading()) {
+            AssetManager::instance().finishLoading();
+        }
+    }
+    if (w.wallsVersion != viewWallsVersion) {
+        wallView.setWalls(w.walls);
+        viewWallsVersion = w.wallsVersion;
+    }
+    redrawRequested = true;
+    return true;
 }
 
 void GameLogic::handleInput() {
-    // Only process movement input while playing and not during any countdown
-    if (state == State::Playing && !showCountdown) {
+    // Movement keys are sent as steer commands; the simulation ignores them
+    // outside of play or during a countdown
+    const WorldSnapshot& w = snapshots.read();
+    if (w.state == State::Playing && !w.showCountdown) {
+        auto steer = [this](int dx, int dy) {
+            InputCommand cmd;
+            cmd.type = InputCommand::Type::Steer;
+            cmd.dx = dx;
+            cmd.dy = dy;
+            inputQueue.push(cmd);
+        };
         if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up) || sf::Keyboard::isKeyPressed(sf::Keyboard::W)) {
-            snake.changeDirection(0, -1);
+            steer(0, -1);
         }
         if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down) || sf::Keyboard::isKeyPressed(sf::Keyboard::S)) {
-            snake.changeDirection(0, 1);
+            steer(0, 1);
         }
         if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left) || sf::Keyboard::isKeyPressed(sf::Keyboard::A)) {
-            snake.changeDirection(-1, 0);
+            steer(-1, 0);
         }
         if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right) || sf::Keyboard::isKeyPressed(sf::Keyboard::D)) {
-            snake.changeDirection(1, 0);
+            steer(1, 0);
         }
     }
 
@@ -188,17 +390,22 @@ void GameLogic::handleInput() {
     if (sf::Keyboard::isKeyPressed(sf::Keyboard::LBracket)) {
         spriteScale = std::max(0.5f, spriteScale - 0.02f);
         renderer.setSpriteScale(spriteScale);
+        invalidate();
     }
     if (sf::Keyboard::isKeyPressed(sf::Keyboard::RBracket)) {
         spriteScale = std::min(3.0f, spriteScale + 0.02f);
         renderer.setSpriteScale(spriteScale);
+        invalidate();
     }
 }
 
 void GameLogic::update() {
+    PROFILE_ZONE("GameLogic::update");
+    castMotion = cast::TickMotion();
     if (gameOver) return;
     if (state == State::Menu) return;
     if (state == State::Paused) return;
+    revision++;
 
     // Handle countdown display (3-2-1-START) and portal-specific (2-1-START)
     if (showCountdown) {
@@ -231,6 +438,12 @@ void GameLogic::update() {
                 countdownNumber = 3;
             }
         }
+        // Beep on every new number, a different sound for START
+        if (showCountdown && countdownNumber != lastCountdownSound) {
+            sfx.trigger(countdownNumber == 0 ? Sfx::CountdownGo : Sfx::CountdownTick);
+            lastCountdownSound = countdownNumber;
+        }
+        if (!showCountdown) lastCountdownSound = -1;
         // Don't update game while countdown is showing
         return;
     }
@@ -258,6 +471,7 @@ void GameLogic::update() {
             if (portalRegrowAccum >= portalRegrowInterval) {
                 portalRegrowAccum -= portalRegrowInterval;
                 snake.grow();
+                castMotion.regrow = true;
                 portalRegrowPlaced++;
             }
         } else {
@@ -266,62 +480,35 @@ void GameLogic::update() {
         }
     }
 
+    if (autopilot) steerAutopilot();
     snake.update();
+    castMotion.moved = true;
+    castMotion.direction = snake.getDirection();
     Cell head = snake.getHead();
     // If stepped on a portal entrance, trigger map change and teleport
     if (portalEntrance.active && head.x == portalEntrance.x && head.y == portalEntrance.y) {
+        PROFILE_ZONE("portal transition");
         // record old length
         int oldLen = (int)snake.getBody().size();
         // deactivate entrance
         portalEntrance.active = false;
+        sfx.trigger(Sfx::PortalTeleport);
 
         // Elegir primero la ubicación de salida segura y reservar área
-        std::uniform_int_distribution<int> distX(barriers.getMinX() + 3, barriers.getMaxX() - 3);
-        std::uniform_int_distribution<int> distY(barriers.getMinY() + 3, barriers.getMaxY() - 3);
-        bool found = false;
         std::vector<Cell> safeArea;
-        int ex = gridWidth / 2, ey = gridHeight / 2;
-        for (int tries = 0; tries < 500 && !found; ++tries) {
-            ex = distX(rng);
-            ey = distY(rng);
-            // Verificar que haya espacio para toda la serpiente hacia arriba
-            bool ok = true;
-            std::vector<Cell> tempSafe;
-            for (int i = 0; i < oldLen; ++i) {
-                Cell c{ex, ey - i};
-                tempSafe.push_back(c);
-                // Reservar también un área de 1 bloque alrededor de cada segmento
-                for (int dx = -1; dx <= 1; ++dx) {
-                    for (int dy = -1; dy <= 1; ++dy) {
-                        Cell adj{c.x + dx, c.y + dy};
-                        if (adj.x >= 0 && adj.x < gridWidth && adj.y >= 0 && adj.y < gridHeight)
-                            tempSafe.push_back(adj);
-                    }
-                }
-            }
-            // Quitar duplicados
-            std::sort(tempSafe.begin(), tempSafe.end(), [](const Cell&a, const Cell&b){ return a.x==b.x?a.y<b.y:a.x<b.x; });
-            tempSafe.erase(std::unique(tempSafe.begin(), tempSafe.end(), [](const Cell&a, const Cell&b){ return a.x==b.x && a.y==b.y; }), tempSafe.end());
-            // Comprobar que no hay paredes en el área
-            for (const auto& c : tempSafe) {
-                if (barriers.checkCollision(c)) { ok = false; break; }
-            }
-            if (ok) {
-                safeArea = tempSafe;
-                found = true;
-            }
-        }
-        if (!found) {
-            // Fallback: solo la cabeza y su alrededor
-            ex = gridWidth / 2; ey = gridHeight / 2;
-            safeArea.clear();
-            for (int dx = -1; dx <= 1; ++dx)
-                for (int dy = -1; dy <= 1; ++dy)
-                    safeArea.push_back({ex + dx, ey + dy});
-        }
-
-        // Regenerar barreras evitando el área segura
-        barriers.generateRandom(rng, gridWidth, gridHeight, safeArea);
+        int ex, ey;
+        bool column = findPortalExit(oldLen, ex, ey, safeArea);
+
+        // Regenerar barreras evitando el área segura. The map comes from its
+        // own seed so spectators can rebuild it from the few bytes below
+        std::uint32_t mapSeed = (std::uint32_t)rng();
+        std::mt19937 mapRng(mapSeed);
+        barriers.generateRandom(mapRng, gridWidth, gridHeight, safeArea);
+        castMotion.teleport = true;
+        castMotion.mapSeed = mapSeed;
+        castMotion.exit = {ex, ey};
+        castMotion.exitLength = oldLen;
+        castMotion.exitColumn = column;
 
         // Colocar la serpiente: la cabeza asoma 1 bloque arriba del portal (ey-1)
         // y el resto del cuerpo queda dentro del portal (ey, ey+1, ...).
@@ -330,9 +517,12 @@ void GameLogic::update() {
         for (int i = 1; i < oldLen; ++i) nb.push_back({ex, ey - 1 + i});
         snake.setBody(nb);
         snake.changeDirection(0, -1);
-        std::cout << "[DEBUG] Teleported to exit (" << ex << "," << ey << ") oldLen=" << oldLen << " body:";
-        for (const auto &c : snake.getBody()) std::cout << " (" << c.x << "," << c.y << ")";
-        std::cout << std::endl;
+        // The new cycle is ready before the countdown ends
+        if (autopilot) rebuildAutopilot();
+        LOG_DEBUG("Teleported to exit ({},{}) oldLen={}", ex, ey, oldLen);
+        if (LOG_ENABLED(Trace)) {
+            for (const auto &c : snake.getBody()) LOG_TRACE("  body ({},{})", c.x, c.y);
+        }
         portalExit.x = ex; portalExit.y = ey; portalExit.active = true; portalExit.isExit = true;
         portalTargetLength = oldLen;
         portalRegrowAccum = 0.f;
@@ -362,9 +552,10 @@ void GameLogic::update() {
     if (!portalShowCountdown && portalGraceTicks <= 0) {
         // Comprobar colisión con barreras
         if (barriers.checkCollision(head)) {
-            std::cout << "[DEBUG] Collision with barrier at head (" << head.x << "," << head.y << ")" << std::endl;
+            LOG_DEBUG("Collision with barrier at head ({},{})", head.x, head.y);
             gameOver = true;
             state = State::GameOver;
+            sfx.trigger(Sfx::GameOver);
             finalElapsedSeconds = startClock.getElapsedTime().asSeconds() - pausedAccumSeconds;
             baseScoreOnGameOver = score;
             timeBonusRemaining = (int)finalElapsedSeconds;
@@ -386,9 +577,10 @@ void GameLogic::update() {
         }
         bool skipSelf = portalShowCountdown || portalGraceTicks > 0 || hasSegmentInsidePortal;
         if (!skipSelf && snake.checkSelfCollision()) {
-            std::cout << "[DEBUG] Self collision detected. Head: (" << head.x << "," << head.y << ")" << std::endl;
+            LOG_DEBUG("Self collision detected. Head: ({},{})", head.x, head.y);
             gameOver = true;
             state = State::GameOver;
+            sfx.trigger(Sfx::GameOver);
             finalElapsedSeconds = startClock.getElapsedTime().asSeconds() - pausedAccumSeconds;
             baseScoreOnGameOver = score;
             timeBonusRemaining = (int)finalElapsedSeconds;
@@ -406,8 +598,10 @@ void GameLogic::update() {
             // handle eating by type
             switch (fruits[i].type) {
                 case Fruit::Type::Gomu:
+                    sfx.trigger(Sfx::EatGomu);
                     score += 1;
                     snake.grow();
+                    castMotion.grown = 1;
                     // grant time for gomu
                     fruitCountdown += 5.f;
                     // classic: when gomu eaten, spawn another gomu elsewhere
@@ -415,19 +609,23 @@ void GameLogic::update() {
                     spawnFood();
                     break;
                 case Fruit::Type::Mera:
+                    sfx.trigger(Sfx::EatMera);
                     score += 5;
                     // grow 2 segments
                     snake.grow();
                     snake.grow();
+                    castMotion.grown = 2;
                     fruitCountdown += 10.f;
                     fruits.erase(fruits.begin() + (int)i);
                     break;
                 case Fruit::Type::Ope:
+                    sfx.trigger(Sfx::EatOpe);
                     score += 10;
                     // grow 3 segments
                     snake.grow();
                     snake.grow();
                     snake.grow();
+                    castMotion.grown = 3;
                     fruitCountdown += 15.f;
                     fruits.erase(fruits.begin() + (int)i);
                     break;
@@ -452,19 +650,11 @@ void GameLogic::update() {
     if (score >= nextPortalScore && !portalEntrance.active && !portalExit.active && !portalShowCountdown && !portalRegrowingActive) {
         // Clear all existing fruits when portal appears
         fruits.clear();
-        // place entrance at random free cell
-        std::uniform_int_distribution<int> distX(barriers.getMinX() + 1, barriers.getMaxX() - 1);
-        std::uniform_int_distribution<int> distY(barriers.getMinY() + 1, barriers.getMaxY() - 1);
-        for (int tries = 0; tries < 200; ++tries) {
-            int px = distX(rng);
-            int py = distY(rng);
-            Cell c{px, py};
-            bool ok = true;
-            for (const auto &bcell : snake.getBody()) if (bcell == c) { ok = false; break; }
-            if (ok && !barriers.checkCollision(c)) {
-                portalEntrance.x = px; portalEntrance.y = py; portalEntrance.active = true; portalEntrance.isExit = false;
-                break;
-            }
+        // place entrance at a random free cell the snake can reach
+        Cell c;
+        if (randomOpenCell(c)) {
+            portalEntrance.x = c.x; portalEntrance.y = c.y; portalEntrance.active = true; portalEntrance.isExit = false;
+            sfx.trigger(Sfx::PortalSpawn);
         }
     }
 
@@ -483,12 +673,16 @@ void GameLogic::update() {
         }
     }
 
+    checkTrapped();
+    followSpawnMap();
+
     // if fruit countdown expired -> game over
     if (fruitCountdown <= 0.f) {
         gameOver = true;
         state = State::GameOver;
+        sfx.trigger(Sfx::GameOver);
         finalElapsedSeconds = startClock.getElapsedTime().asSeconds() - pausedAccumSeconds;
-        std::cout << "Game Over! Fruit timer reached zero. Score: " << score << std::endl;
+        LOG_INFO("Game Over! Fruit timer reached zero. Score: {}", score);
         // Setup animated scoring like collision GameOver: add time bonus animation
         baseScoreOnGameOver = score;
         timeBonusRemaining = (int)finalElapsedSeconds;
@@ -496,7 +690,7 @@ void GameLogic::update() {
         scoreAnimationDone = false;
         scoreAnimClock.restart();
         // If beat high score, defer name entry until after animation finishes
-        if (score > highScore) {
+        if (qualifiesForLeaderboard(score)) {
             awaitingNameEntry = true;
             nameBuffer.clear();
         } else {
@@ -506,25 +700,174 @@ void GameLogic::update() {
     }
 }
 
-void GameLogic::draw(sf::RenderWindow& window) {
+// One head cell and one or two tail cells change per tick; a new map or a
+// body that jumped (portal, restored session) is taken from scratch
+void GameLogic::checkTrapped() {
+    PROFILE_ZONE("trap check");
+    const PackedBody& body = snake.getBody();
+    if (barriers.getVersion() != trapsWallsVersion) {
+        trapsWallsVersion = barriers.getVersion();
+        traps.reset(barriers.getWalls(), body);
+    } else {
+        traps.follow(body);
+    }
+    // Coming out of the exit portal part of the body is not on the board yet
+    bool was = trapped;
+    trapped = false;
+    if (!portalExit.active && !portalShowCountdown && !body.empty()) {
+        Cell head = body.front();
+        trapped = traps.isTrapped(head, body.back(), (int)body.size())
+                  && !(portalEntrance.active && traps.canReach(head, {portalEntrance.x, portalEntrance.y}));
+    }
+    if (trapped && !was) {
+        LOG_INFO("Trapped: {} free cells left for {} segments", traps.reachableArea(body.front()), body.size());
+    }
+}
+
+// The areas are relabelled once per map; after that only the cells the
+// head and tail changed move in or out of the free lists
+void GameLogic::followSpawnMap() {
+    if (barriers.getVersion() != spawnMapVersion) {
+        spawnMap.build(barriers.getWalls(), gridWidth, gridHeight, barriers.getMinX(), barriers.getMinY(),
+                       barriers.getMaxX(), barriers.getMaxY());
+        spawnMapVersion = barriers.getVersion();
+    }
+    spawnMap.follow(snake.getBody());
+}
+
+// Drawn from the free cells off the body; fruit and portals are few enough
+// to reject
+bool GameLogic::randomOpenCell(Cell& out) {
+    followSpawnMap();
+    auto taken = [&](int cell) {
+        int x = cell % gridWidth, y = cell / gridWidth;
+        for (const Fruit& f : fruits) {
+            if (f.x == x && f.y == y) return true;
+        }
+        return (portalEntrance.active && portalEntrance.x == x && portalEntrance.y == y)
+               || (portalExit.active && portalExit.x == x && portalExit.y == y);
+    };
+
+    // The head's area; the largest one if the head is not on an open cell
+    int area = spawnMap.areaOf(snake.getHead());
+    if (area < 0) area = spawnMap.getLargestArea();
+    return spawnMap.pick(area, rng, taken, out);
+}
+
+// Pick a portal exit with room for the whole snake (body straight up from the
+// exit plus a 1-cell margin); falls back to the grid centre after 500 tries.
+// safeArea receives the cells the next map must keep free.
+bool GameLogic::findPortalExit(int oldLen, int& ex, int& ey, std::vector<Cell>& safeArea) {
+    std::uniform_int_distribution<int> distX(barriers.getMinX() + 3, barriers.getMaxX() - 3);
+    std::uniform_int_distribution<int> distY(barriers.getMinY() + 3, barriers.getMaxY() - 3);
+    bool found = false;
+    safeArea.clear();
+    ex = gridWidth / 2; ey = gridHeight / 2;
+    for (int tries = 0; tries < 500 && !found; ++tries) {
+        ex = distX(rng);
+        ey = distY(rng);
+        // Verificar que haya espacio para toda la serpiente hacia arriba
+        Barrier::portalSafeArea(ex, ey, oldLen, true, gridWidth, gridHeight, safeArea);
+        // Comprobar que no hay paredes en el área
+        found = true;
+        for (const auto& c : safeArea) {
+            if (barriers.checkCollision(c)) { found = false; break; }
+        }
+    }
+    if (!found) {
+        // Fallback: solo la cabeza y su alrededor
+        ex = gridWidth / 2; ey = gridHeight / 2;
+        Barrier::portalSafeArea(ex, ey, oldLen, false, gridWidth, gridHeight, safeArea);
+    }
+    return found;
+}
+
+void GameLogic::setAutopilot(bool on) {
+    if (!on) {
+        autopilot.reset();
+        return;
+    }
+    autopilot.reset(new HamiltonSolver(gridWidth, gridHeight));
+    autopilotBody.assign((std::size_t)(gridWidth * gridHeight), 0);
+    autopilotGoals.reserve(8);
+    autopilotWallsVersion = barriers.getVersion() - 1; // build on the first tick
+}
+
+void GameLogic::rebuildAutopilot() {
+    autopilotWallsVersion = barriers.getVersion();
+    HamiltonSolver::Status status = autopilot->build(barriers.getWalls(), snake.getHead());
+    static const char* const STATUS[] = {"none", "complete", "partial", "no full cycle exists"};
+    LOG_DEBUG("Autopilot cycle {} of {} free cells ({})", autopilot->getCycleLength(), autopilot->getFreeCells(),
+              STATUS[(int)status]);
+}
+
+// Segments still inside the exit portal and the copies grow() left on the
+// tail are growth to come: the tail stays put while they come out
+void GameLogic::steerAutopilot() {
+    PROFILE_ZONE("autopilot");
+    // New walls from startGame, reset or a restored session
+    if (barriers.getVersion() != autopilotWallsVersion) rebuildAutopilot();
+
+    const PackedBody& body = snake.getBody();
+    auto hidden = [&](const Cell& c) {
+        return portalExit.active && c.x == portalExit.x && c.y >= portalExit.y;
+    };
+    std::size_t length = body.size();
+    while (length > 1 && (hidden(body[length - 1]) || body[length - 1] == body[length - 2])) length--;
+
+    std::fill(autopilotBody.begin(), autopilotBody.end(), 0);
+    for (std::size_t i = 0; i < length; ++i) {
+        Cell c = body[i];
+        if (c.x >= 0 && c.y >= 0 && c.x < gridWidth && c.y < gridHeight) {
+            autopilotBody[(std::size_t)(c.y * gridWidth + c.x)] = 1;
+        }
+    }
+
+    autopilotGoals.clear();
+    bool teleport = portalEntrance.active;
+    if (teleport) autopilotGoals.push_back({portalEntrance.x, portalEntrance.y});
+    else for (const Fruit& f : fruits) autopilotGoals.push_back({f.x, f.y});
+
+    HamiltonSolver::SnakeState state;
+    state.head = snake.getHead();
+    state.tail = body[length - 1];
+    state.direction = snake.getDirection();
+    state.length = (int)length;
+    state.growPending = (int)(body.size() - length);
+    Cell next = autopilot->nextMove(state, autopilotGoals, teleport, [this](const Cell& c) {
+        if (c.x < 0 || c.y < 0 || c.x >= gridWidth || c.y >= gridHeight) return true;
+        return autopilotBody[(std::size_t)(c.y * gridWidth + c.x)] != 0;
+    });
+    snake.changeDirection(next.x - state.head.x, next.y - state.head.y);
+}
+
+void GameLogic::draw(sf::RenderTarget& window) {
+    PROFILE_ZONE("GameLogic::draw");
+    // Remember what this frame shows so static screens can skip identical frames.
+    // Animated frames keep the flag set so the first idle frame is always drawn.
+    lastDrawnKey = idleFrameKey();
+    redrawRequested = !isIdleScreen();
+    // Everything below reads the published snapshot, never the live state
+    const WorldSnapshot& w = snapshots.read();
+
     // Dibujar barreras
-    barriers.draw(window, blockSize);
+    wallView.draw(window, blockSize);
 
     // If in menu, draw title and prompt and return
-    if (state == State::Menu) {
-        if (titleFont.getInfo().family.size()) {
+    if (w.state == State::Menu) {
+        if (titleFont->getInfo().family.size()) {
             std::string s = "Mecha-Snake";
             int fontSize = std::max(64, blockSize * 2);
             float totalWidth = 0.f;
             std::vector<sf::Text> letters;
             for (char c : s) {
-                sf::Text t( std::string(1, c), titleFont, fontSize);
+                sf::Text t( std::string(1, c), *titleFont, fontSize);
                 sf::FloatRect bb = t.getLocalBounds();
                 totalWidth += bb.width;
                 letters.push_back(t);
             }
             float startX = ((float)gridWidth * blockSize - totalWidth) / 2.f;
-            float ttime = startClock.getElapsedTime().asSeconds();
+            float ttime = idleAnimTime();
             float x = startX;
             for (size_t i = 0; i < letters.size(); ++i) {
                 sf::Text &lt = letters[i];
@@ -540,16 +883,24 @@ void GameLogic::draw(sf::RenderWindow& window) {
                 x += bb.width;
             }
         }
-        sf::Text prompt("Press Enter to Play", titleFont.getInfo().family.size() ? titleFont : uiFont, std::max(18, blockSize));
+        sf::Text prompt("Press Enter to Play", titleFont->getInfo().family.size() ? *titleFont : *uiFont, std::max(18, blockSize));
         prompt.setFillColor(sf::Color::White);
         sf::FloatRect pb = prompt.getLocalBounds();
         prompt.setOrigin(pb.width / 2.f, pb.height / 2.f);
         prompt.setPosition((float)(gridWidth * blockSize) / 2.f, (float)(gridHeight * blockSize) / 2.f);
         window.draw(prompt);
+        if (w.suspendedSession) {
+            sf::Text cont("Press C to Continue", titleFont->getInfo().family.size() ? *titleFont : *uiFont, std::max(16, blockSize * 3 / 4));
+            cont.setFillColor(sf::Color(255, 230, 120));
+            sf::FloatRect cb = cont.getLocalBounds();
+            cont.setOrigin(cb.width / 2.f, cb.height / 2.f);
+            cont.setPosition((float)(gridWidth * blockSize) / 2.f, (float)(gridHeight * blockSize) / 2.f + 48.f);
+            window.draw(cont);
+        }
         // Show highest score and name using second font if available
-        if (titleFont.getInfo().family.size()) {
-            std::string scoreStr = std::to_string(highScore);
-            sf::Text hs(std::string("Highest score: ") + scoreStr + std::string(" - \"") + highName + std::string("\""), titleFont, std::max(16, blockSize / 2));
+        if (titleFont->getInfo().family.size()) {
+            std::string scoreStr = std::to_string(w.bestScore);
+            sf::Text hs(std::string("Highest score: ") + scoreStr + std::string(" - \"") + w.bestName + std::string("\""), *titleFont, std::max(16, blockSize / 2));
             hs.setFillColor(sf::Color::White);
             sf::FloatRect hb = hs.getLocalBounds();
             hs.setOrigin(hb.width / 2.f, hb.height / 2.f);
@@ -560,10 +911,10 @@ void GameLogic::draw(sf::RenderWindow& window) {
             {
                 // Position controls panel inside the play frame (to the left side, but not overlapping walls)
                 // Use the left inner cell (minX + 1) and add a small padding
-                float left = (float)(barriers.getMinX() + 1) * (float)blockSize + (float)blockSize * 0.25f;
+                float left = (float)(wallView.getMinX() + 1) * (float)blockSize + (float)blockSize * 0.25f;
                 float bottom = (float)(gridHeight * blockSize) - (float)blockSize * 12.0f;
 
-                sf::Text ctrlTitle("Controls:", uiFont, std::max(18, blockSize / 2));
+                sf::Text ctrlTitle("Controls:", *uiFont, std::max(18, blockSize / 2));
                 ctrlTitle.setFillColor(sf::Color::White);
                 // Raise the Controls: title slightly higher so it doesn't overlap the key images
                 // Apply same vertical offset as the control block
@@ -600,20 +951,20 @@ void GameLogic::draw(sf::RenderWindow& window) {
                         s.setPosition(keySpriteX, y);
                         window.draw(s);
 
-                        sf::Text lab(std::string(" -> ") + label, uiFont, std::max(16, blockSize / 2));
+                        sf::Text lab(std::string(" -> ") + label, *uiFont, std::max(16, blockSize / 2));
                         lab.setFillColor(sf::Color::White);
                         float labelX = keySpriteX + ((float)ts.x * kscale) * 0.5f + (float)blockSize * 0.2f;
                         lab.setPosition(labelX, y - (float)blockSize * 0.15f);
                         window.draw(lab);
                     } else {
-                        sf::Text keyTxt(letterFallback, uiFont, std::max(20, blockSize / 2));
+                        sf::Text keyTxt(letterFallback, *uiFont, std::max(20, blockSize / 2));
                         keyTxt.setFillColor(sf::Color::White);
                         sf::FloatRect kb = keyTxt.getLocalBounds();
                         keyTxt.setOrigin(kb.width / 2.f, kb.height / 2.f);
                         keyTxt.setPosition(keySpriteX, y);
                         window.draw(keyTxt);
 
-                        sf::Text lab(std::string(" -> ") + label, uiFont, std::max(16, blockSize / 2));
+                        sf::Text lab(std::string(" -> ") + label, *uiFont, std::max(16, blockSize / 2));
                         lab.setFillColor(sf::Color::White);
                         lab.setPosition(keySpriteX + (float)blockSize * 1.0f, y - (float)blockSize * 0.15f);
                         window.draw(lab);
@@ -621,16 +972,16 @@ void GameLogic::draw(sf::RenderWindow& window) {
                 };
 
                 // Draw W, A, S, D lines
-                drawKeyLine(texW, "W", "Up", yW);
-                drawKeyLine(texA, "A", "Left", yA);
-                drawKeyLine(texS, "S", "Down", yS);
-                drawKeyLine(texD, "D", "Right", yD);
+                drawKeyLine(*texW, "W", "Up", yW);
+                drawKeyLine(*texA, "A", "Left", yA);
+                drawKeyLine(*texS, "S", "Down", yS);
+                drawKeyLine(*texD, "D", "Right", yD);
 
                 // P pause key: show sprite then label; fallback to text if missing
-                if (texP.getSize().x > 0 && texP.getSize().y > 0) {
+                if (texP->getSize().x > 0 && texP->getSize().y > 0) {
                     sf::Sprite pSprite;
-                    pSprite.setTexture(texP);
-                    sf::Vector2u pts = texP.getSize();
+                    pSprite.setTexture(*texP);
+                    sf::Vector2u pts = texP->getSize();
                     // Use the same `keySize` as other key sprites, so P matches W/A/S/D
                     float pscale = keySize / (float)pts.x;
                     // Use uniform scale to preserve aspect ratio
@@ -641,21 +992,21 @@ void GameLogic::draw(sf::RenderWindow& window) {
                     pSprite.setPosition(pSpriteX, yP);
                     window.draw(pSprite);
                     // Show arrow plus Pause label, positioned to the right of P sprite
-                    sf::Text pLabel(" -> Pause", uiFont, std::max(16, blockSize / 2));
+                    sf::Text pLabel(" -> Pause", *uiFont, std::max(16, blockSize / 2));
                     pLabel.setFillColor(sf::Color::White);
                     float pLabelX = pSpriteX + ((float)pts.x * pscale) * 0.5f + (float)blockSize * 0.2f;
                     pLabel.setPosition(pLabelX, yP - (float)blockSize * 0.2f);
                     window.draw(pLabel);
                 } else {
-                    sf::Text pText("P -> Pause", uiFont, std::max(16, blockSize / 2));
+                    sf::Text pText("P -> Pause", *uiFont, std::max(16, blockSize / 2));
                     pText.setFillColor(sf::Color::White);
                     pText.setPosition(left + (float)blockSize * 0.6f, yP);
                     window.draw(pText);
                 }
             }
         // Show Ctrl+R reset hint in lower right corner (larger)
-        if (titleFont.getInfo().family.size()) {
-            sf::Text hint("Ctrl + R to erase all data", titleFont, std::max(14, blockSize / 2));
+        if (titleFont->getInfo().family.size()) {
+            sf::Text hint("Ctrl + R to erase all data", *titleFont, std::max(14, blockSize / 2));
             hint.setFillColor(sf::Color::White);
             sf::FloatRect hintBounds = hint.getLocalBounds();
             hint.setPosition((float)(gridWidth * blockSize) - hintBounds.width - (float)blockSize * 0.5f, (float)(gridHeight * blockSize) - hintBounds.height - (float)blockSize * 0.5f);
@@ -665,16 +1016,17 @@ void GameLogic::draw(sf::RenderWindow& window) {
     }
 
     // Dibujar serpiente con sprites Weedle
-    const auto& bodyCells = snake.getBody();
-    Cell dir = snake.getDirection();
+    const auto& bodyCells = w.body;
+    Cell dir = w.direction;
     
     if (renderer.isLoaded() && !bodyCells.empty()) {
+        PROFILE_ZONE("snake + fruit sprites");
         // Draw body segments and tail first, then draw head over them
         for (size_t i = 1; i < bodyCells.size(); ++i) {
             // If there's an active exit portal, hide any body segments that are
             // still inside it (y >= portalExit.y) so they aren't rendered
             // until they emerge above the portal.
-            if (portalExit.active && bodyCells[i].y >= portalExit.y) continue;
+            if (w.portalExit.active && bodyCells[i].y >= w.portalExit.y) continue;
             if (i == bodyCells.size() - 1) {
                 // tail: orientation determined by vector from tail to previous cell
                 const Cell& prev = bodyCells[i - 1];
@@ -710,11 +1062,11 @@ void GameLogic::draw(sf::RenderWindow& window) {
         renderer.drawHead(window, bodyCells[0].x, bodyCells[0].y, blockSize, dir.x, dir.y);
 
         // Draw all fruits using textures
-        for (const auto &f : fruits) {
+        for (const auto &f : w.fruits) {
             sf::Sprite s;
-            if (f.type == Fruit::Type::Gomu) s.setTexture(texGomu);
-            else if (f.type == Fruit::Type::Mera) s.setTexture(texMera);
-            else s.setTexture(texOpe);
+            if (f.type == Fruit::Type::Gomu) s.setTexture(*texGomu);
+            else if (f.type == Fruit::Type::Mera) s.setTexture(*texMera);
+            else s.setTexture(*texOpe);
             sf::Vector2u ts = s.getTexture()->getSize();
             float texW = (float)ts.x;
             float texH = (float)ts.y;
@@ -729,10 +1081,10 @@ void GameLogic::draw(sf::RenderWindow& window) {
 
         // Dibujar portal entrance y exit usando sprite si la textura está cargada
         auto drawPortalSprite = [&](int px, int py, bool semiTransparent) {
-            if (portalTexture.getSize().x > 0 && portalTexture.getSize().y > 0) {
-                sf::Sprite portalSprite(portalTexture);
-                float texW = (float)portalTexture.getSize().x;
-                float texH = (float)portalTexture.getSize().y;
+            if (portalTexture->getSize().x > 0 && portalTexture->getSize().y > 0) {
+                sf::Sprite portalSprite(*portalTexture);
+                float texW = (float)portalTexture->getSize().x;
+                float texH = (float)portalTexture->getSize().y;
                 float sizeInPixels = (float)blockSize * renderer.getSpriteScale();
                 float scaleX = sizeInPixels / texW;
                 float scaleY = sizeInPixels / texH;
@@ -749,29 +1101,30 @@ void GameLogic::draw(sf::RenderWindow& window) {
                 window.draw(portal);
             }
         };
-        if (portalEntrance.active) {
-            drawPortalSprite(portalEntrance.x, portalEntrance.y, false);
+        if (w.portalEntrance.active) {
+            drawPortalSprite(w.portalEntrance.x, w.portalEntrance.y, false);
         }
-        if (portalExit.active) {
-            drawPortalSprite(portalExit.x, portalExit.y, portalShowCountdown);
+        if (w.portalExit.active) {
+            drawPortalSprite(w.portalExit.x, w.portalExit.y, w.portalShowCountdown);
         }
     // Al final del archivo, agregar la textura de portal como miembro
 
     // --- Agregar miembro de textura de portal ---
     } else {
+        PROFILE_ZONE("snake + fruit fallback");
         // Fallback: dibujar rectángulos sólidos
-        if (showCountdown && portalShowCountdown) {
+        if (w.showCountdown && w.portalShowCountdown) {
             // During portal countdown show only the head so the body can emerge
             // from the portal tile when movement resumes.
-            Cell h = snake.getHead();
+            Cell h = w.body.front();
             sf::RectangleShape rect({(float)blockSize, (float)blockSize});
             rect.setFillColor(sf::Color::Green);
             rect.setPosition((float)(h.x * blockSize), (float)(h.y * blockSize));
             window.draw(rect);
         } else {
-            snake.draw(window, blockSize);
+            Snake::drawCells(window, w.body, blockSize, sf::Color::Green);
         }
-        for (const auto &f : fruits) {
+        for (const auto &f : w.fruits) {
             float sizeInPixels = (float)blockSize * renderer.getSpriteScale();
             sf::RectangleShape fs({sizeInPixels, sizeInPixels});
             if (f.type == Fruit::Type::Gomu) fs.setFillColor(sf::Color(180,200,255));
@@ -783,8 +1136,9 @@ void GameLogic::draw(sf::RenderWindow& window) {
         }
     }
 
-    // UI: score + timer (draw on top)
-    scoreText.setString("Score: " + std::to_string(score));
+    // UI: score + timer (draw on top); everything below is HUD and overlays
+    PROFILE_ZONE("HUD");
+    scoreText.setString("Score: " + std::to_string(w.score));
     // Leave larger padding from the border for score display
     scoreText.setPosition((float)blockSize * 1.5f, 5.f);
     // Background for score
@@ -797,11 +1151,8 @@ void GameLogic::draw(sf::RenderWindow& window) {
     }
     window.draw(scoreText);
 
-    // compute elapsed shown to user excluding paused time
-    float currentElapsed = startClock.getElapsedTime().asSeconds() - pausedAccumSeconds;
-    float displayElapsed = currentElapsed;
-    if (state == State::GameOver) displayElapsed = finalElapsedSeconds;
-    int totalSeconds = (int)std::max(0.f, displayElapsed);
+    // elapsed shown to user excluding paused time (computed by the simulation)
+    int totalSeconds = (int)std::max(0.f, w.displayElapsed);
     int minutes = totalSeconds / 60;
     int seconds = totalSeconds % 60;
     char buf[16];
@@ -821,7 +1172,7 @@ void GameLogic::draw(sf::RenderWindow& window) {
     window.draw(timerText);
 
     // Fruit countdown display (below main timer)
-    int fsecs = (int)std::max(0.f, fruitCountdown);
+    int fsecs = (int)std::max(0.f, w.fruitCountdown);
     int fm = fsecs / 60;
     int fs = fsecs % 60;
     char fbuf[16];
@@ -839,13 +1190,20 @@ void GameLogic::draw(sf::RenderWindow& window) {
     }
     window.draw(fruitTimerText);
 
+    // Warning below the fruit timer once the snake has sealed itself in
+    if (w.trapped && w.state == State::Playing) {
+        float ttextW = trappedText.getLocalBounds().width;
+        trappedText.setPosition(winW - ttextW - (float)blockSize * 0.5f, fruitTimerText.getPosition().y + fruitTimerText.getCharacterSize() + 6.f);
+        window.draw(trappedText);
+    }
+
     // Draw countdown (3-2-1-START) if active
-    if (showCountdown) {
+    if (w.showCountdown) {
         std::string countdownStr;
-        if (countdownNumber == 0) {
+        if (w.countdownNumber == 0) {
             countdownStr = "START!";
         } else {
-            countdownStr = std::to_string(countdownNumber);
+            countdownStr = std::to_string(w.countdownNumber);
         }
         countdownText.setString(countdownStr);
         sf::FloatRect cbounds = countdownText.getLocalBounds();
@@ -859,12 +1217,12 @@ void GameLogic::draw(sf::RenderWindow& window) {
     // Portal countdown is rendered by the central `showCountdown` block.
 
     // If paused, draw blinking PAUSE text in center using titleFont and show resume keys
-    if (state == State::Paused) {
-        if (titleFont.getInfo().family.size()) {
-            float t = pauseClock.getElapsedTime().asSeconds();
+    if (w.state == State::Paused) {
+        if (titleFont->getInfo().family.size()) {
+            float t = viewStateClock.getElapsedTime().asSeconds();
             bool visible = (fmod(t, 1.0f) < 0.5f);
                 if (visible) {
-                sf::Text ptext("PAUSE", titleFont, std::max(48, blockSize * 2));
+                sf::Text ptext("PAUSE", *titleFont, std::max(48, blockSize * 2));
                 ptext.setFillColor(sf::Color::White);
                 ptext.setOutlineColor(sf::Color::Black);
                 ptext.setOutlineThickness(3.f);
@@ -879,7 +1237,7 @@ void GameLogic::draw(sf::RenderWindow& window) {
                 window.draw(ptext);
 
                 // Show resume instructions separated on multiple lines with titleFont
-                sf::Text resumeText("Resume: Enter or P", titleFont, std::max(20, blockSize));
+                sf::Text resumeText("Resume: Enter or P", *titleFont, std::max(20, blockSize));
                 resumeText.setFillColor(sf::Color::White);
                 sf::FloatRect rb = resumeText.getLocalBounds();
                 resumeText.setOrigin(rb.width / 2.f, rb.height / 2.f);
@@ -888,7 +1246,7 @@ void GameLogic::draw(sf::RenderWindow& window) {
                 window.draw(resumeText);
 
                 // Show exit instruction on separate line below with more space
-                sf::Text menuText("Backspace: Menu", titleFont, std::max(20, blockSize));
+                sf::Text menuText("Backspace: Menu", *titleFont, std::max(20, blockSize));
                 menuText.setFillColor(sf::Color::White);
                 sf::FloatRect mb = menuText.getLocalBounds();
                 menuText.setOrigin(mb.width / 2.f, mb.height / 2.f);
@@ -900,26 +1258,26 @@ void GameLogic::draw(sf::RenderWindow& window) {
     }
 
     // If game over, show frozen overlay with final score and time
-    if (state == State::GameOver) {
+    if (w.state == State::GameOver) {
         // darken the scene slightly
         sf::RectangleShape overlay({(float)gridWidth * blockSize, (float)gridHeight * blockSize});
         overlay.setFillColor(sf::Color(0, 0, 0, 140));
         window.draw(overlay);
 
         // Big 'GAME OVER' title
-        if (titleFont.getInfo().family.size()) {
+        if (titleFont->getInfo().family.size()) {
             std::string s = "GAME OVER";
             int fontSize = std::max(48, blockSize * 2);
             float totalWidth = 0.f;
             std::vector<sf::Text> letters;
             for (char c : s) {
-                sf::Text t( std::string(1, c), titleFont, fontSize);
+                sf::Text t( std::string(1, c), *titleFont, fontSize);
                 sf::FloatRect bb = t.getLocalBounds();
                 totalWidth += bb.width;
                 letters.push_back(t);
             }
             float startX = ((float)gridWidth * blockSize - totalWidth) / 2.f;
-            float ttime = startClock.getElapsedTime().asSeconds();
+            float ttime = idleAnimTime();
             float x = startX;
             for (size_t i = 0; i < letters.size(); ++i) {
                 sf::Text &lt = letters[i];
@@ -936,37 +1294,18 @@ void GameLogic::draw(sf::RenderWindow& window) {
             }
         }
 
-        // Animated scoring: base score + time bonus counts up (Mario-style)
-        if (!scoreAnimationDone) {
-            // advance animation at fixed tick
-            float saTick = 0.02f;
-            if (scoreAnimClock.getElapsedTime().asSeconds() >= saTick) {
-                scoreAnimClock.restart();
-                if (timeBonusRemaining > 0) {
-                    // increment animated score by 1 and decrement bonus
-                    animatedScore += 1;
-                    timeBonusRemaining -= 1;
-                } else {
-                    // animation finished
-                    scoreAnimationDone = true;
-                    score = animatedScore; // commit final score
-                    // if record, start name entry
-                    if (score > highScore) {
-                        awaitingNameEntry = true;
-                        nameBuffer.clear();
-                    }
-                }
-            }
-
+        // Animated scoring: base score + time bonus counts up (Mario-style);
+        // advanced by the simulation in advanceScoreAnimation()
+        if (!w.scoreAnimationDone) {
             // draw animated score and remaining time bonus
-            sf::Text finalScore(std::string("Score: ") + std::to_string(animatedScore), uiFont, scoreText.getCharacterSize());
+            sf::Text finalScore(std::string("Score: ") + std::to_string(w.animatedScore), *uiFont, scoreText.getCharacterSize());
             finalScore.setFillColor(sf::Color::White);
             sf::FloatRect sb = finalScore.getLocalBounds();
             finalScore.setOrigin(sb.width / 2.f, sb.height / 2.f);
             finalScore.setPosition((float)(gridWidth * blockSize) / 2.f, (float)(gridHeight * blockSize) / 2.f - 40.f);
             window.draw(finalScore);
 
-            sf::Text bonusText(std::string("Time Bonus: ") + std::to_string(timeBonusRemaining) + std::string(" s"), uiFont, timerText.getCharacterSize());
+            sf::Text bonusText(std::string("Time Bonus: ") + std::to_string(w.timeBonusRemaining) + std::string(" s"), *uiFont, timerText.getCharacterSize());
             bonusText.setFillColor(sf::Color::White);
             sf::FloatRect bt = bonusText.getLocalBounds();
             bonusText.setOrigin(bt.width / 2.f, bt.height / 2.f);
@@ -974,7 +1313,7 @@ void GameLogic::draw(sf::RenderWindow& window) {
             window.draw(bonusText);
         } else {
             // final static display
-            sf::Text finalScore(std::string("Score: ") + std::to_string(score), uiFont, scoreText.getCharacterSize());
+            sf::Text finalScore(std::string("Score: ") + std::to_string(w.score), *uiFont, scoreText.getCharacterSize());
             finalScore.setFillColor(sf::Color::White);
             sf::FloatRect sb = finalScore.getLocalBounds();
             finalScore.setOrigin(sb.width / 2.f, sb.height / 2.f);
@@ -982,12 +1321,12 @@ void GameLogic::draw(sf::RenderWindow& window) {
             window.draw(finalScore);
 
             // Time played (frozen at moment of GameOver)
-            int totalSeconds = (int)finalElapsedSeconds;
+            int totalSeconds = (int)w.finalElapsedSeconds;
             int minutes = totalSeconds / 60;
             int seconds = totalSeconds % 60;
             char buf[16];
             snprintf(buf, sizeof(buf), "%02d:%02d", minutes, seconds);
-            sf::Text finalTime(timerText.getString(), uiFont, timerText.getCharacterSize());
+            sf::Text finalTime(timerText.getString(), *uiFont, timerText.getCharacterSize());
             finalTime.setString(std::string("Time: ") + buf);
             finalTime.setFillColor(sf::Color::White);
             sf::FloatRect tb = finalTime.getLocalBounds();
@@ -996,9 +1335,9 @@ void GameLogic::draw(sf::RenderWindow& window) {
             window.draw(finalTime);
 
             // High score info (only show if not entering name)
-            if (!awaitingNameEntry) {
-                std::string hsStr = std::string("Best Score: ") + std::to_string(highScore) + std::string(" - \"") + highName + std::string("\"");
-                sf::Text highScoreText(hsStr, uiFont, scoreText.getCharacterSize());
+            if (!w.awaitingNameEntry) {
+                std::string hsStr = std::string("Best Score: ") + std::to_string(w.bestScore) + std::string(" - \"") + w.bestName + std::string("\"");
+                sf::Text highScoreText(hsStr, *uiFont, scoreText.getCharacterSize());
                 highScoreText.setFillColor(sf::Color::Yellow);
                 sf::FloatRect hsb = highScoreText.getLocalBounds();
                 highScoreText.setOrigin(hsb.width / 2.f, hsb.height / 2.f);
@@ -1007,8 +1346,10 @@ void GameLogic::draw(sf::RenderWindow& window) {
             }
 
             // Restart prompt or name entry if new record
-            if (awaitingNameEntry && titleFont.getInfo().family.size()) {
-                sf::Text prompt("You broke the record! Enter your name:", titleFont, std::max(18, blockSize/1));
+            if (w.awaitingNameEntry && titleFont->getInfo().family.size()) {
+                const char* promptStr = w.scoreRank == 1 ? "You broke the record! Enter your name:"
+                                                                       : "Top 10! Enter your name:";
+                sf::Text prompt(promptStr, *titleFont, std::max(18, blockSize/1));
                 prompt.setFillColor(sf::Color::White);
                 sf::FloatRect pb = prompt.getLocalBounds();
                 prompt.setOrigin(pb.width / 2.f, pb.height / 2.f);
@@ -1016,14 +1357,14 @@ void GameLogic::draw(sf::RenderWindow& window) {
                 window.draw(prompt);
 
                 // show current typed name
-                sf::Text nameText(nameBuffer.empty() ? std::string("_") : nameBuffer, titleFont, std::max(18, blockSize/1));
+                sf::Text nameText(w.nameBuffer.empty() ? std::string("_") : w.nameBuffer, *titleFont, std::max(18, blockSize/1));
                 nameText.setFillColor(sf::Color::White);
                 sf::FloatRect nb = nameText.getLocalBounds();
                 nameText.setOrigin(nb.width / 2.f, nb.height / 2.f);
                 nameText.setPosition((float)(gridWidth * blockSize) / 2.f, (float)(gridHeight * blockSize) / 2.f + 100.f);
                 window.draw(nameText);
             } else {
-                sf::Text prompt("Press Enter to Restart", uiFont, std::max(18, blockSize));
+                sf::Text prompt("Press Enter to Restart", *uiFont, std::max(18, blockSize));
                 prompt.setFillColor(sf::Color::White);
                 sf::FloatRect pb = prompt.getLocalBounds();
                 prompt.setOrigin(pb.width / 2.f, pb.height / 2.f);
@@ -1032,8 +1373,8 @@ void GameLogic::draw(sf::RenderWindow& window) {
             }
         }
         // Show Ctrl+R reset hint in lower right corner even on game over (larger)
-        if (titleFont.getInfo().family.size()) {
-            sf::Text hint("Ctrl + R to erase all data", titleFont, std::max(14, blockSize / 2));
+        if (titleFont->getInfo().family.size()) {
+            sf::Text hint("Ctrl + R to erase all data", *titleFont, std::max(14, blockSize / 2));
             hint.setFillColor(sf::Color::White);
             sf::FloatRect hintBounds = hint.getLocalBounds();
             hint.setPosition((float)(gridWidth * blockSize) - hintBounds.width - (float)blockSize * 0.5f, (float)(gridHeight * blockSize) - hintBounds.height - (float)blockSize * 0.5f);
@@ -1049,7 +1390,9 @@ void GameLogic::reset() {
     lastSpawnCheck = 0.f;
     fruits.clear();
     // generate initial random internal walls (avoid snake start cells)
-    barriers.generateRandom(rng, gridWidth, gridHeight, snake.getBody());
+    std::vector<Cell> start;
+    snake.getBody().copyTo(start);
+    barriers.generateRandom(rng, gridWidth, gridHeight, start);
     spawnFood();
     // reset fruit timer and portals
     fruitCountdown = 20.f;
@@ -1060,6 +1403,7 @@ void GameLogic::reset() {
     nextPortalScore = 30;
     portalExitCountdownActive = false;
     portalExitCountdown = 0.f;
+    trapped = false;
     portalShowCountdown = false;
     portalRegrowingActive = false;
     portalRegrowPlaced = 0;
@@ -1101,7 +1445,9 @@ void GameLogic::startGame() {
     snake.reset(gridWidth / 2, gridHeight / 2);
     fruits.clear();
     // generate initial random internal walls and place food
-    barriers.generateRandom(rng, gridWidth, gridHeight, snake.getBody());
+    std::vector<Cell> start;
+    snake.getBody().copyTo(start);
+    barriers.generateRandom(rng, gridWidth, gridHeight, start);
     spawnFood();
     score = 0;
     gameOver = false;
@@ -1115,6 +1461,7 @@ void GameLogic::startGame() {
     nextPortalScore = 30;
     portalExitCountdownActive = false;
     portalExitCountdown = 0.f;
+    trapped = false;
     portalShowCountdown = false;
     portalRegrowingActive = false;
     portalRegrowPlaced = 0;
@@ -1129,72 +1476,68 @@ void GameLogic::toggleTailRotate() {
     renderer.setTailRotate180(!renderer.getTailRotate180());
 }
 
-void GameLogic::loadFruitTextures() {
-    auto findAssetPath = [&](const std::string &p)->std::string {
-        std::ifstream f(p);
-        if (f.good()) { f.close(); return p; }
-        if (p.rfind("../", 0) == 0) {
-            std::string alt = p.substr(3);
-            std::ifstream f2(alt);
-            if (f2.good()) { f2.close(); return alt; }
-        } else {
-            std::string alt = std::string("../") + p;
-            std::ifstream f2(alt);
-            if (f2.good()) { f2.close(); return alt; }
-        }
-        return std::string();
-    };
+bool GameLogic::isIdleScreen() const {
+    const WorldSnapshot& w = snapshots.read();
+    if (w.state == State::Menu || w.state == State::Paused) return true;
+    // GameOver is static once the score count-up has finished
+    return w.state == State::GameOver && w.scoreAnimationDone;
+}
+
+bool GameLogic::isInPlay() const {
+    const WorldSnapshot& w = snapshots.read();
+    return w.state == State::Playing && !w.showCountdown;
+}
+
+// Time used by the waving titles. On static screens it advances in discrete
+// steps (one redraw per step) and stops once nobody has touched the game for
+// a while, so an unattended kiosk settles on a single frame.
+float GameLogic::idleAnimTime() const {
+    float t = animClock.getElapsedTime().asSeconds();
+    if (!isIdleScreen()) return t;
+    float idle = inputIdleClock.getElapsedTime().asSeconds();
+    if (idle > idleAnimTimeout) t -= idle - idleAnimTimeout;
+    return std::floor(t * idleAnimHz) / idleAnimHz;
+}
 
-    std::string p;
-    p = findAssetPath("assets/images/gomu_gomu.png");
-    if (!p.empty()) {
-        if (texGomu.loadFromFile(p)) std::cout << "Loaded texture: " << p << "\n";
-        else std::cerr << "Failed to load texture file (even though found): " << p << "\n";
-    } else std::cerr << "gomu_gomu.png not found in candidates\n";
-
-    p = findAssetPath("assets/images/mera_mera.png");
-    if (!p.empty()) {
-        if (texMera.loadFromFile(p)) std::cout << "Loaded texture: " << p << "\n";
-        else std::cerr << "Failed to load texture file (even though found): " << p << "\n";
-    } else std::cerr << "mera_mera.png not found in candidates\n";
-
-    p = findAssetPath("assets/images/ope_ope.png");
-    if (!p.empty()) {
-        if (texOpe.loadFromFile(p)) std::cout << "Loaded texture: " << p << "\n";
-        else std::cerr << "Failed to load texture file (even though found): " << p << "\n";
-    } else std::cerr << "ope_ope.png not found in candidates\n";
-
-    // Load UI control key textures (W/A/S/D and P)
-    // Load individual key images W/A/S/D
-    p = findAssetPath("assets/images/W.png");
-    if (!p.empty()) {
-        if (texW.loadFromFile(p)) std::cout << "Loaded texture: " << p << "\n";
-        else std::cerr << "Failed to load texture file (even though found): " << p << "\n";
-    } else std::cerr << "W.png not found in candidates\n";
-
-    p = findAssetPath("assets/images/A.png");
-    if (!p.empty()) {
-        if (texA.loadFromFile(p)) std::cout << "Loaded texture: " << p << "\n";
-        else std::cerr << "Failed to load texture file (even though found): " << p << "\n";
-    } else std::cerr << "A.png not found in candidates\n";
-
-    p = findAssetPath("assets/images/S.png");
-    if (!p.empty()) {
-        if (texS.loadFromFile(p)) std::cout << "Loaded texture: " << p << "\n";
-        else std::cerr << "Failed to load texture file (even though found): " << p << "\n";
-    } else std::cerr << "S.png not found in candidates\n";
-
-    p = findAssetPath("assets/images/D.png");
-    if (!p.empty()) {
-        if (texD.loadFromFile(p)) std::cout << "Loaded texture: " << p << "\n";
-        else std::cerr << "Failed to load texture file (even though found): " << p << "\n";
-    } else std::cerr << "D.png not found in candidates\n";
-
-    p = findAssetPath("assets/images/P.png");
-    if (!p.empty()) {
-        if (texP.loadFromFile(p)) std::cout << "Loaded texture: " << p << "\n";
-        else std::cerr << "Failed to load texture file (even though found): " << p << "\n";
-    } else std::cerr << "P.png not found in candidates\n";
+// Identifies the picture a static screen would draw right now: two equal keys
+// mean two identical frames.
+long GameLogic::idleFrameKey() const {
+    if (viewState == State::Paused) {
+        // PAUSE text blinks every half second
+        return (long)(viewStateClock.getElapsedTime().asSeconds() * 2.f);
+    }
+    return (long)std::lround(idleAnimTime() * idleAnimHz);
+}
+
+bool GameLogic::needsRedraw() const {
+    if (!isIdleScreen() || redrawRequested) return true;
+    return idleFrameKey() != lastDrawnKey;
+}
+
+sf::Time GameLogic::timeUntilNextRedraw() const {
+    if (needsRedraw()) return sf::Time::Zero;
+    float wait = 0.5f; // upper bound; any event wakes the loop earlier
+    if (viewState == State::Paused) {
+        wait = 0.5f - std::fmod(viewStateClock.getElapsedTime().asSeconds(), 0.5f);
+    } else if (inputIdleClock.getElapsedTime().asSeconds() <= idleAnimTimeout) {
+        float step = 1.f / idleAnimHz;
+        wait = step - std::fmod(animClock.getElapsedTime().asSeconds(), step);
+    }
+    return sf::seconds(wait);
+}
+
+void GameLogic::loadFruitTextures() {
+    AssetManager& assets = AssetManager::instance();
+    // UI control key textures (W/A/S/D and P) are shown on the menu
+    texW = assets.textureAsync("images/W.png", LoadPriority::Critical);
+    texA = assets.textureAsync("images/A.png", LoadPriority::Critical);
+    texS = assets.textureAsync("images/S.png", LoadPriority::Critical);
+    texD = assets.textureAsync("images/D.png", LoadPriority::Critical);
+    texP = assets.textureAsync("images/P.png", LoadPriority::Critical);
+
+    texGomu = assets.textureAsync("images/gomu_gomu.png", LoadPriority::Background);
+    texMera = assets.textureAsync("images/mera_mera.png", LoadPriority::Background);
+    texOpe = assets.textureAsync("images/ope_ope.png", LoadPriority::Background);
 }
 
 void GameLogic::spawnCheck(float nowSeconds) {
@@ -1206,25 +1549,11 @@ void GameLogic::spawnCheck(float nowSeconds) {
         // don't spawn this type if one already exists
         for (const auto &of : fruits) if (of.type == t) return;
 
-        std::uniform_int_distribution<int> distX(barriers.getMinX() + 1, barriers.getMaxX() - 1);
-        std::uniform_int_distribution<int> distY(barriers.getMinY() + 1, barriers.getMaxY() - 1);
         Fruit f;
-        bool valid = false;
-        int attempts = 0;
-        while (!valid && attempts < 30) {
-            f.x = distX(rng);
-            f.y = distY(rng);
-            valid = true;
-            for (const auto &cell : snake.getBody()) {
-                if (cell.x == f.x && cell.y == f.y) { valid = false; break; }
-            }
-            for (const auto &of : fruits) {
-                if (of.x == f.x && of.y == f.y) { valid = false; break; }
-            }
-                if (barriers.checkCollision({f.x, f.y})) valid = false;
-            attempts++;
-        }
-        if (valid) {
+        Cell c;
+        if (randomOpenCell(c)) {
+            f.x = c.x;
+            f.y = c.y;
             f.type = t;
             f.spawnTime = nowSeconds;
             f.duration = duration;
@@ -1254,9 +1583,21 @@ void GameLogic::processEvent(const sf::Event& event) {
         if (!awaitingNameEntry) {
             // Ctrl+R to reset stats
             if (event.key.code == sf::Keyboard::R && event.key.control) {
-                highScore = 0;
-                highName = "Nobody";
-                saveHighScore();
+                leaderboard.clear();
+                return;
+            }
+
+            // F5 checkpoint, F9 load checkpoint, C continue a suspended session
+            if (event.key.code == sf::Keyboard::F5 && hasSession()) {
+                suspendToFile(SESSION_FILE);
+                return;
+            }
+            if (event.key.code == sf::Keyboard::F9 && suspendedSession && state != State::Menu) {
+                resumeFromFile(SESSION_FILE, false);
+                return;
+            }
+            if (event.key.code == sf::Keyboard::C && state == State::Menu && suspendedSession) {
+                resumeFromFile(SESSION_FILE, true);
                 return;
             }
 
@@ -1281,52 +1622,243 @@ void GameLogic::processEvent(const sf::Event& event) {
         if (event.key.code == sf::Keyboard::Enter) {
             // finalize name
             if (!nameBuffer.empty()) {
-                highScore = score;
-                // store name uppercase
-                std::string up = nameBuffer;
-                for (char &c : up) c = (char)std::toupper((unsigned char)c);
-                highName = up;
-                saveHighScore();
+                // queued for the leaderboard's writer thread; stored uppercase
+                leaderboard.submit(score, nameBuffer);
             }
             awaitingNameEntry = false;
         }
     }
 }
 
-void GameLogic::loadHighScore() {
-    std::vector<std::string> candidates = {"../assets/highscore.txt", "assets/highscore.txt", "highscore.txt"};
-    for (const auto &p : candidates) {
-        std::ifstream in(p);
-        if (!in) continue;
-        int s = 0;
-        std::string name;
-        if (in >> s) {
-            std::getline(in, name); // consume rest of line
-            std::string line;
-            if (std::getline(in, line)) {
-                // second line could be name
-                name = line;
-            }
-            highScore = s;
-            if (!name.empty()) {
-                // trim leading spaces
-                size_t pos = name.find_first_not_of(" \t\r\n");
-                if (pos != std::string::npos) name = name.substr(pos);
-                highName = name;
-            }
-            return;
-        }
+bool GameLogic::qualifiesForLeaderboard(int s) const {
+    return s > 0 && leaderboard.rankOf(s) <= LEADERBOARD_ENTRY_RANK;
+}
+
+// Play time right now, excluding pauses and the running countdown
+float GameLogic::currentPlaySeconds() const {
+    float t = startClock.getElapsedTime().asSeconds() - pausedAccumSeconds;
+    if (state == State::Paused) t -= pauseClock.getElapsedTime().asSeconds();
+    else if (showCountdown) t -= countdownClock.getElapsedTime().asSeconds();
+    return t;
+}
+
+static savestate::SavedPortal packPortal(int x, int y, bool active, bool isExit) {
+    savestate::SavedPortal p{};
+    p.x = x; p.y = y;
+    p.active = active ? 1 : 0;
+    p.isExit = isExit ? 1 : 0;
+    return p;
+}
+
+void GameLogic::captureSnapshot(std::vector<unsigned char>& out) const {
+    using namespace savestate;
+    const PackedBody& body = snake.getBody();
+    const std::vector<Cell>& walls = barriers.getWalls();
+
+    // The body is encoded straight into place after the header and core
+    out.resize(sizeof(Header) + sizeof(Core));
+    bodycodec::encode(body, out);
+
+    Header h{};
+    std::memcpy(h.magic, MAGIC, sizeof(h.magic));
+    h.version = VERSION;
+    h.bodyCount = (std::uint32_t)body.size();
+    h.wallCount = (std::uint32_t)walls.size();
+    h.fruitCount = (std::uint32_t)fruits.size();
+    h.bodyBytes = (std::uint32_t)(out.size() - sizeof(Header) - sizeof(Core));
+    h.totalSize = (std::uint32_t)(out.size() + walls.size() * sizeof(PackedCell) + fruits.size() * sizeof(SavedFruit));
+
+    Core c{};
+    c.gridWidth = gridWidth;
+    c.gridHeight = gridHeight;
+    c.state = (std::int32_t)state;
+    c.score = score;
+    c.direction = snake.getDirection();
+    c.nextDirection = snake.getNextDirection();
+    c.elapsedPlaySeconds = currentPlaySeconds();
+    c.fruitCountdown = fruitCountdown;
+    c.lastUpdateSeconds = lastUpdateSeconds;
+    c.lastSpawnCheck = lastSpawnCheck;
+    c.portalRegrowAccum = portalRegrowAccum;
+    c.portalExitCountdown = portalExitCountdown;
+    c.portalEntrance = packPortal(portalEntrance.x, portalEntrance.y, portalEntrance.active, portalEntrance.isExit);
+    c.portalExit = packPortal(portalExit.x, portalExit.y, portalExit.active, portalExit.isExit);
+    c.portalTargetLength = portalTargetLength;
+    c.nextPortalScore = nextPortalScore;
+    c.portalRegrowPlaced = portalRegrowPlaced;
+    c.portalRegrowNeeded = portalRegrowNeeded;
+    c.portalGraceTicks = portalGraceTicks;
+    c.portalShowCountdown = portalShowCountdown ? 1 : 0;
+    c.portalRegrowingActive = portalRegrowingActive ? 1 : 0;
+    c.portalExitCountdownActive = portalExitCountdownActive ? 1 : 0;
+    c.showCountdown = showCountdown ? 1 : 0;
+    c.countdownNumber = countdownNumber;
+    std::memcpy(c.rng, &rng, sizeof(c.rng));
+
+    // One contiguous buffer: header, core, then the variable-length arrays
+    std::size_t wallsAt = out.size();
+    out.resize(h.totalSize);
+    std::memcpy(out.data() + sizeof(Header), &c, sizeof(Core));
+    unsigned char* p = out.data() + wallsAt;
+    for (const Cell& w : walls) {
+        PackedCell pc = PackedCell::of(w);
+        std::memcpy(p, &pc, sizeof(PackedCell));
+        p += sizeof(PackedCell);
     }
-    highScore = 0;
-    highName = "Nobody";
+    for (const Fruit& f : fruits) {
+        SavedFruit sf{(std::int32_t)f.type, f.x, f.y, f.spawnTime, f.duration};
+        std::memcpy(p, &sf, sizeof(SavedFruit));
+        p += sizeof(SavedFruit);
+    }
+    h.checksum = checksum(out.data() + sizeof(Header), out.size() - sizeof(Header));
+    std::memcpy(out.data(), &h, sizeof(Header));
 }
 
-void GameLogic::saveHighScore() {
-    // ensure highName is uppercase before saving
-    std::string up = highName;
-    for (char &c : up) c = (char)std::toupper((unsigned char)c);
-    std::ofstream out("highscore.txt");
-    if (!out) return;
-    out << highScore << "\n";
-    out << up << "\n";
+bool GameLogic::restoreSnapshot(const std::vector<unsigned char>& in) {
+    using namespace savestate;
+    Header h;
+    if (in.size() < sizeof(Header) + sizeof(Core)) return false;
+    std::memcpy(&h, in.data(), sizeof(Header));
+    if (std::memcmp(h.magic, MAGIC, sizeof(h.magic)) != 0 || h.version != VERSION) return false;
+    std::size_t expected = sizeof(Header) + sizeof(Core) + (std::size_t)h.bodyBytes + (std::size_t)h.wallCount * sizeof(PackedCell) + (std::size_t)h.fruitCount * sizeof(SavedFruit);
+    if (h.totalSize != in.size() || expected != in.size() || h.bodyCount == 0) return false;
+    if (checksum(in.data() + sizeof(Header), in.size() - sizeof(Header)) != h.checksum) return false;
+
+    Core c;
+    const unsigned char* p = in.data() + sizeof(Header);
+    std::memcpy(&c, p, sizeof(Core)); p += sizeof(Core);
+    // A snapshot from a different board size would put cells off-screen
+    if (c.gridWidth != gridWidth || c.gridHeight != gridHeight) return false;
+    if (c.state != (std::int32_t)State::Playing && c.state != (std::int32_t)State::Paused) return false;
+    if (c.countdownNumber < 0 || c.countdownNumber > 3) return false;
+
+    // The checksum only catches corruption: everything that later indexes the
+    // grid is range-checked too, so a hand-edited file can't reach it
+    auto inGrid = [&](int x, int y) { return x >= 0 && x < gridWidth && y >= 0 && y < gridHeight; };
+    auto isStep = [](Cell d) { return std::abs(d.x) + std::abs(d.y) == 1; };
+    if (!isStep(c.direction) || !isStep(c.nextDirection)) return false;
+    if (c.portalEntrance.active && !inGrid(c.portalEntrance.x, c.portalEntrance.y)) return false;
+    if (c.portalExit.active && !inGrid(c.portalExit.x, c.portalExit.y)) return false;
+
+    std::vector<Cell> body;
+    if (bodycodec::decode(p, h.bodyBytes, h.bodyCount, body) != h.bodyBytes || body.size() != h.bodyCount) return false;
+    p += h.bodyBytes;
+    // Right after a teleport the tail hangs straight down inside the exit
+    // portal and may run past the bottom edge; any other cell must be on the grid
+    if (!inGrid(body[0].x, body[0].y)) return false;
+    for (const Cell& b : body) {
+        bool insideExit = c.portalExit.active && b.x == c.portalExit.x && b.y >= c.portalExit.y
+                          && b.y < c.portalExit.y + (int)h.bodyCount;
+        if (!inGrid(b.x, b.y) && !insideExit) return false;
+    }
+    std::vector<Cell> walls(h.wallCount);
+    for (Cell& w : walls) {
+        PackedCell pc;
+        std::memcpy(&pc, p, sizeof(PackedCell));
+        p += sizeof(PackedCell);
+        w = pc.cell();
+        if (!inGrid(w.x, w.y)) return false;
+    }
+    std::vector<Fruit> restored;
+    restored.reserve(h.fruitCount);
+    for (std::uint32_t i = 0; i < h.fruitCount; ++i) {
+        SavedFruit sf;
+        std::memcpy(&sf, p, sizeof(SavedFruit));
+        p += sizeof(SavedFruit);
+        if (sf.type < (std::int32_t)Fruit::Type::Gomu || sf.type > (std::int32_t)Fruit::Type::Ope) return false;
+        if (!inGrid(sf.x, sf.y)) return false;
+        Fruit f;
+        f.type = (Fruit::Type)sf.type;
+        f.x = sf.x; f.y = sf.y;
+        f.spawnTime = sf.spawnTime;
+        f.duration = sf.duration;
+        restored.push_back(f);
+    }
+    fruits.swap(restored);
+
+    snake.setBody(body);
+    snake.setDirection(c.direction, c.nextDirection);
+    barriers.setWalls(walls);
+    score = c.score;
+    gameOver = false;
+    awaitingNameEntry = false;
+    fruitCountdown = c.fruitCountdown;
+    lastUpdateSeconds = c.lastUpdateSeconds;
+    lastSpawnCheck = c.lastSpawnCheck;
+    portalRegrowAccum = c.portalRegrowAccum;
+    portalExitCountdown = c.portalExitCountdown;
+    portalEntrance.x = c.portalEntrance.x; portalEntrance.y = c.portalEntrance.y;
+    portalEntrance.active = c.portalEntrance.active != 0; portalEntrance.isExit = c.portalEntrance.isExit != 0;
+    portalExit.x = c.portalExit.x; portalExit.y = c.portalExit.y;
+    portalExit.active = c.portalExit.active != 0; portalExit.isExit = c.portalExit.isExit != 0;
+    portalTargetLength = c.portalTargetLength;
+    nextPortalScore = c.nextPortalScore;
+    portalRegrowPlaced = c.portalRegrowPlaced;
+    portalRegrowNeeded = c.portalRegrowNeeded;
+    portalGraceTicks = c.portalGraceTicks;
+    portalShowCountdown = c.portalShowCountdown != 0;
+    portalRegrowingActive = c.portalRegrowingActive != 0;
+    portalExitCountdownActive = c.portalExitCountdownActive != 0;
+    std::memcpy(&rng, c.rng, sizeof(c.rng));
+
+    // Timers are stored in play seconds: rebase the clocks so play time
+    // continues from the saved value, and always come back paused
+    startClock.restart();
+    pausedAccumSeconds = -c.elapsedPlaySeconds;
+    elapsedPlaySeconds = c.elapsedPlaySeconds;
+    pauseClock.restart();
+    // A countdown that was running shows its number under the pause screen;
+    // resuming restarts it like any other unpause
+    showCountdown = c.showCountdown != 0;
+    countdownNumber = c.countdownNumber;
+    lastCountdownSound = -1;
+    state = State::Paused;
+    revision++;
+    return true;
+}
+
+bool GameLogic::suspendToFile(const std::string& path) {
+    if (!hasSession()) return false;
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<unsigned char> bytes;
+    captureSnapshot(bytes);
+    auto t1 = std::chrono::steady_clock::now();
+    if (!savestate::writeFile(path, bytes)) {
+        std::cerr << "Failed to write save state " << path << "\n";
+        return false;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    suspendedSession = true;
+    std::cout << "Session saved to " << path << " (" << bytes.size() << " bytes, capture "
+              << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us, write "
+              << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us)\n";
+    return true;
+}
+
+bool GameLogic::resumeFromFile(const std::string& path, bool consume) {
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<unsigned char> bytes;
+    if (!savestate::readFile(path, bytes)) {
+        std::cerr << "No save state at " << path << "\n";
+        suspendedSession = false;
+        return false;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    bool ok = restoreSnapshot(bytes);
+    auto t2 = std::chrono::steady_clock::now();
+    if (!ok) {
+        // Corrupt, truncated or from another version/board: drop it
+        std::cerr << "Save state " << path << " is invalid, discarding\n";
+        std::remove(path.c_str());
+        suspendedSession = false;
+        return false;
+    }
+    if (consume) {
+        std::remove(path.c_str());
+        suspendedSession = false;
+    }
+    std::cout << "Session restored from " << path << " (read "
+              << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us, restore "
+              << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us)\n";
+    return true;
 }
@@ -1,13 +1,217 @@
 #include <SFML/Graphics.hpp>
 #include "GameLogic.hpp"
+#include "AssetManager.hpp"
+#include "StartupTimeline.hpp"
+#include "Profiler.hpp"
+#include "Log.hpp"
+#include "Arena.hpp"
+#include "NetClient.hpp"
+#include "Spectator.hpp"
 #include <iostream>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
 
 const int BLOCKS = 60;
 const int BLOCK_SIZE = 32;
+const char* const TRACE_FILE = "trace.json";
+
+// SFML 2 has no timed waitEvent: poll, then sleep in short slices until an
+// event arrives, the timeout expires or wake() reports new simulation state.
+// Used while a static screen is shown.
+template <typename Wake>
+static bool waitEventFor(sf::RenderWindow& window, sf::Event& event, sf::Time timeout, Wake wake) {
+    sf::Clock waited;
+    while (!window.pollEvent(event)) {
+        sf::Time left = timeout - waited.getElapsedTime();
+        if (left <= sf::Time::Zero || wake()) return false;
+        sf::sleep(std::min(left, sf::milliseconds(10)));
+    }
+    return true;
+}
+
+// Largest block that fits a board `side` cells across on the desktop, for
+// the flat-colour views (arena, LAN client, spectator)
+static int blockSizeFor(int side) {
+    sf::VideoMode desktopMode = sf::VideoMode::getDesktopMode();
+    int maxSide = std::max(600, (int)std::min(desktopMode.width - 50, desktopMode.height - 100));
+    return std::max(2, maxSide / side);
+}
+
+// "host[:port]": strips the port off `host`; `port` keeps its default if absent
+static void splitHostPort(std::string& host, unsigned short& port) {
+    std::size_t colon = host.rfind(':');
+    if (colon != std::string::npos) {
+        port = (unsigned short)std::atoi(host.c_str() + colon + 1);
+        host.resize(colon);
+    }
+}
+
+// Stress mode (SNAKE_ARENA=<snakes>): AI snakes only, ticked on this thread.
+// R restarts with a new seed, F3 shows the profiler overlay.
+static int runArena(int snakeCount) {
+    int side = Arena::boardSideFor(snakeCount);
+    int blockSize = blockSizeFor(side);
+    sf::RenderWindow window(sf::VideoMode(side * blockSize, side * blockSize), "Snake - Arena", sf::Style::Default);
+    window.setFramerateLimit(60);
+    std::shared_ptr<sf::Font> overlayFont = AssetManager::instance().font(
+        AssetManager::instance().exists("fonts/Minecraft.ttf") ? "fonts/Minecraft.ttf" : "fonts/HOMOARAK.TTF");
+
+    const float TICK = 0.08f;
+    unsigned seed = (unsigned)std::time(nullptr);
+    std::unique_ptr<Arena> arena(new Arena(side, side, snakeCount, seed, TICK));
+    std::cout << "Arena: " << snakeCount << " snakes on " << side << "x" << side << ", seed " << seed << std::endl;
+
+    sf::Clock clock, titleClock;
+    float accum = 0.f, tickMs = 0.f;
+    while (window.isOpen()) {
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed) window.close();
+            if (event.type != sf::Event::KeyPressed) continue;
+            if (event.key.code == sf::Keyboard::Escape) window.close();
+            if (event.key.code == sf::Keyboard::F3) Profiler::toggleOverlay();
+            if (event.key.code == sf::Keyboard::R) {
+                arena.reset(new Arena(side, side, snakeCount, ++seed, TICK));
+            }
+        }
+        // Fixed-rate ticks; after a stall, skip ahead instead of catching up
+        accum = std::min(accum + clock.restart().asSeconds(), TICK * 5);
+        while (accum >= TICK) {
+            accum -= TICK;
+            sf::Clock tickClock;
+            arena->tick();
+            tickMs = tickMs * 0.9f + tickClock.getElapsedTime().asSeconds() * 100.f; // smoothed, ms
+        }
+        if (titleClock.getElapsedTime().asSeconds() >= 0.5f) {
+            titleClock.restart();
+            char title[128];
+            std::snprintf(title, sizeof(title), "Snake - Arena: %d/%d alive, best %d, tick %.2f ms",
+                          arena->getAliveCount(), arena->getSnakeCount(), arena->getBestScore(), tickMs);
+            window.setTitle(title);
+        }
+        window.clear(sf::Color(20, 20, 20));
+        arena->draw(window, blockSize);
+        Profiler::drawOverlay(window, *overlayFont);
+        window.display();
+        Profiler::endFrame();
+    }
+    return 0;
+}
+
+// LAN client (SNAKE_CONNECT=host[:port][/room]) for bin/SnakeServer.exe. The
+// server owns the game; this window only sends directions and draws.
+static int runClient(const std::string& address) {
+    std::string host = address;
+    unsigned short port = net::DEFAULT_PORT;
+    int room = 0;
+    std::size_t slash = host.rfind('/');
+    if (slash != std::string::npos) {
+        room = std::atoi(host.c_str() + slash + 1);
+        host.resize(slash);
+    }
+    splitHostPort(host, port);
+    NetClient client;
+    if (!client.connect(host, port, room)) return 1;
+
+    int blockSize = blockSizeFor(std::max(client.getGridWidth(), client.getGridHeight()));
+    sf::RenderWindow window(sf::VideoMode(client.getGridWidth() * blockSize, client.getGridHeight() * blockSize),
+                            "Snake - LAN", sf::Style::Default);
+    window.setFramerateLimit(60);
+
+    sf::Clock titleClock;
+    while (window.isOpen() && client.isConnected()) {
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed) window.close();
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape) window.close();
+        }
+        client.update();
+        if (titleClock.getElapsedTime().asSeconds() >= 0.5f) {
+            titleClock.restart();
+            char title[128];
+            std::snprintf(title, sizeof(title), "Snake - LAN: player %d, score %d, best %d, rtt %.0f ms, %u B/snapshot",
+                          client.getPlayerId(), client.getScore(), client.getBestScore(), client.getRttMs(),
+                          (unsigned)client.getLastSnapshotBytes());
+            window.setTitle(title);
+        }
+        window.clear(sf::Color(20, 20, 20));
+        client.draw(window, blockSize);
+        window.display();
+    }
+    client.disconnect();
+    return 0;
+}
+
+// Spectator (SNAKE_WATCH=host[:port]) of a game started with SNAKE_BROADCAST
+static int runSpectator(const std::string& address) {
+    std::string host = address;
+    unsigned short port = cast::DEFAULT_PORT;
+    splitHostPort(host, port);
+    Spectator spectator;
+    if (!spectator.connect(host, port)) return 1;
+
+    const cast::Replica& game = spectator.getReplica();
+    int blockSize = blockSizeFor(std::max(game.gridWidth, game.gridHeight));
+    sf::RenderWindow window(sf::VideoMode(game.gridWidth * blockSize, game.gridHeight * blockSize),
+                            "Snake - watching", sf::Style::Default);
+    window.setFramerateLimit(60);
+
+    static const char* const STATES[] = {"menu", "playing", "paused", "game over"};
+    sf::Clock titleClock;
+    while (window.isOpen() && spectator.isConnected()) {
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed) window.close();
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape) window.close();
+        }
+        spectator.update();
+        if (titleClock.getElapsedTime().asSeconds() >= 0.5f) {
+            titleClock.restart();
+            char title[160];
+            std::snprintf(title, sizeof(title), "Snake - watching: %s, score %d, time %.0f s, fruit timer %.0f s%s | %.1f KB/s, %d resyncs",
+                          STATES[(int)game.state], game.score, game.elapsed, game.fruitCountdown,
+                          game.synced ? "" : " (resyncing)", spectator.getBytesPerSecond() / 1024.f,
+                          spectator.getResyncCount());
+            window.setTitle(title);
+        }
+        window.clear(sf::Color(20, 20, 20));
+        spectator.draw(window, blockSize);
+        window.display();
+    }
+    spectator.disconnect();
+    return 0;
+}
 
 int main() {
+    // Game-thread logging goes through the async writer (SNAKE_LOG=debug for more)
+    Log::start();
+
+    if (const char* arenaEnv = std::getenv("SNAKE_ARENA")) {
+        int rc = runArena(std::atoi(arenaEnv) > 0 ? std::atoi(arenaEnv) : 500);
+        Log::stop();
+        return rc;
+    }
+    if (const char* connectEnv = std::getenv("SNAKE_CONNECT")) {
+        int rc = runClient(connectEnv);
+        Log::stop();
+        return rc;
+    }
+    if (const char* watchEnv = std::getenv("SNAKE_WATCH")) {
+        int rc = runSpectator(watchEnv);
+        Log::stop();
+        return rc;
+    }
+
+    // Start decoding the background while the window is being created
+    std::shared_ptr<sf::Texture> backgroundTexture = AssetManager::instance().textureAsync("images/fondo.png", LoadPriority::Critical);
+
     // Get desktop resolution and compute window size that fits the game grid
     sf::VideoMode desktopMode = sf::VideoMode::getDesktopMode();
     const int marginWidth = 50; // leave some space at sides
@@ -35,24 +239,31 @@ int main() {
     sf::RenderWindow window(sf::VideoMode(windowWidth, windowHeight), "Snake - Classic", sf::Style::Default);
     window.setFramerateLimit(60);
     std::cout << "Window: " << windowWidth << "x" << windowHeight << ", blockSize: " << usedBlockSize << std::endl;
+    StartupTimeline::mark("window created");
+
+    GameLogic game(BLOCKS, BLOCKS, usedBlockSize);
+    StartupTimeline::mark("game constructed");
+
+    // The first frame needs the menu assets; gameplay sprites keep decoding
+    AssetManager::instance().finishLoading(LoadPriority::Critical);
+    StartupTimeline::mark("menu assets uploaded");
 
     // Cargar imagen de fondo
-    sf::Texture backgroundTexture;
-    if (!backgroundTexture.loadFromFile("assets/images/fondo.png")) {
+    if (backgroundTexture->getSize().x == 0) {
         std::cerr << "No se pudo cargar assets/images/fondo.png, se usará color sólido\n";
     }
     sf::Sprite backgroundSprite;
-    if (backgroundTexture.getSize().x > 0 && backgroundTexture.getSize().y > 0) {
-        backgroundSprite.setTexture(backgroundTexture);
-        float scaleX = (float)windowWidth / backgroundTexture.getSize().x;
-        float scaleY = (float)windowHeight / backgroundTexture.getSize().y;
+    if (backgroundTexture->getSize().x > 0 && backgroundTexture->getSize().y > 0) {
+        backgroundSprite.setTexture(*backgroundTexture);
+        float scaleX = (float)windowWidth / backgroundTexture->getSize().x;
+        float scaleY = (float)windowHeight / backgroundTexture->getSize().y;
         backgroundSprite.setScale(scaleX, scaleY);
     }
 
-    GameLogic game(BLOCKS, BLOCKS, usedBlockSize);
+    std::shared_ptr<sf::Font> overlayFont = AssetManager::instance().font(
+        AssetManager::instance().exists("fonts/Minecraft.ttf") ? "fonts/Minecraft.ttf" : "fonts/HOMOARAK.TTF");
 
-    sf::Clock clock;
-    float moveTimer = 0.0f;
+    long framesShown = 0;
     const float MOVE_INTERVAL = 0.08f; // Tiempo entre movimientos
 
     std::cout << "=== SNAKE GAME ===" << std::endl;
@@ -62,65 +273,133 @@ int main() {
     std::cout << "Press P to pause/resume" << std::endl;
     std::cout << "Avoid white walls and don't hit yourself" << std::endl;
     std::cout << "Press [ / ] to change sprite scale" << std::endl;
+    std::cout << "F3 toggles the profiler overlay, F4 starts/stops a trace (make PROFILE=1)" << std::endl;
+    std::cout << "F5 saves the session, F9 loads it, C continues from the menu" << std::endl;
     std::cout << "==================" << std::endl;
 
+    // The simulation ticks on its own thread; this one polls input and draws
+    // the newest snapshot it published
+    std::atomic<bool> simRunning{true};
+    // Live stream for spectators (SNAKE_BROADCAST=[port]), sent from its own thread
+    std::unique_ptr<Broadcaster> broadcaster;
+    if (const char* castEnv = std::getenv("SNAKE_BROADCAST")) {
+        int castPort = std::atoi(castEnv);
+        broadcaster.reset(new Broadcaster(castPort > 0 ? (unsigned short)castPort : cast::DEFAULT_PORT));
+        if (broadcaster->start()) game.setBroadcaster(broadcaster.get());
+        else broadcaster.reset();
+    }
+    // The snake drives itself along a Hamiltonian cycle (SNAKE_AUTOPILOT=1).
+    // The allocation check always uses it and starts the game on its own, so
+    // `make alloc-check` runs without anyone at the keyboard.
+    const char* autoEnv = std::getenv("SNAKE_AUTOPILOT");
+    const bool allocCheck = Profiler::allocCheckEnabled();
+    if ((autoEnv && std::atoi(autoEnv) != 0) || allocCheck) {
+        game.setAutopilot(true);
+        std::cout << "Autopilot on: the keys no longer steer" << std::endl;
+    }
+    if (allocCheck) {
+        sf::Event start;
+        start.type = sf::Event::KeyPressed;
+        start.key = sf::Event::KeyEvent{};
+        start.key.code = sf::Keyboard::Enter;
+        game.postEvent(start);
+    }
+    bool allocCheckPlayed = false;
+    std::thread simThread([&] { game.runSimulation(MOVE_INTERVAL, simRunning); });
+
+    auto handleEvent = [&](const sf::Event& event) {
+        // Any input or window event may change what is on screen
+        game.invalidate();
+        bool isKey = event.type == sf::Event::KeyPressed;
+        // Purely visual keys stay here; everything else is game input
+        if (isKey && event.key.code == sf::Keyboard::T) {
+            game.toggleTailRotate();
+            return;
+        }
+        if (isKey && event.key.code == sf::Keyboard::F3) {
+            Profiler::toggleOverlay();
+            return;
+        }
+        if (isKey && event.key.code == sf::Keyboard::F4) {
+            // Start recording, or stop and dump what was captured
+            if (Profiler::isTracing()) Profiler::writeTrace(TRACE_FILE);
+            Profiler::toggleTrace();
+            return;
+        }
+        game.postEvent(event);
+        // The simulation suspends the session when it sees the close event
+        if (event.type == sf::Event::Closed || (isKey && event.key.code == sf::Keyboard::Escape)) {
+            window.close();
+        }
+    };
+
     while (window.isOpen()) {
         sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                window.close();
-            }
-            // Give game a chance to process events (text input for name entry)
-            game.processEvent(event);
-
-            if (event.type == sf::Event::KeyPressed) {
-                if (event.key.code == sf::Keyboard::R && game.canRestart()) {
-                    game.reset();
-                }
-                if (event.key.code == sf::Keyboard::Escape) {
-                    window.close();
-                }
-                if (event.key.code == sf::Keyboard::P) {
-                    game.togglePause();
-                }
-                if (event.key.code == sf::Keyboard::T) {
-                    game.toggleTailRotate();
-                }
-                if (event.key.code == sf::Keyboard::Enter) {
-                    if (game.isMenu()) {
-                        game.startGame();
-                    } else if (game.isGameOver()) {
-                        game.reset();
-                        game.startGame();
-                    } else if (game.isPaused()) {
-                        // allow Enter to resume from pause
-                        game.togglePause();
-                    }
-                }
+        // Static screen with nothing new to show: block instead of redrawing
+        if (!game.needsRedraw()) {
+            if (waitEventFor(window, event, game.timeUntilNextRedraw(), [&] { return game.consumeSnapshot(); })) {
+                handleEvent(event);
             }
         }
+        while (window.pollEvent(event)) {
+            handleEvent(event);
+        }
+
+        // Upload gameplay textures as the workers finish decoding them
+        if (AssetManager::instance().pumpUploads() > 0) {
+            game.invalidate();
+        }
+        if (!StartupTimeline::wasReported() && framesShown > 0 && !AssetManager::instance().isLoading()) {
+            StartupTimeline::mark("all assets uploaded");
+            StartupTimeline::report();
+        }
 
         // Manejo de entrada continuo
         game.handleInput();
 
-        // Actualizar lógica del juego
-        sf::Time elapsed = clock.restart();
-        moveTimer += elapsed.asSeconds();
+        // Newest state from the simulation thread (no-op if nothing changed)
+        game.consumeSnapshot();
+        // Play whatever the ticks queued (eat, portal, countdown, game over)
+        game.pumpAudio();
 
-        if (moveTimer >= MOVE_INTERVAL) {
-            moveTimer = 0.0f;
-            game.update();
-        }
+        // The profiler overlay is live data: keep redrawing while it is shown
+        if (Profiler::overlayVisible()) game.invalidate();
+        if (!window.isOpen() || !game.needsRedraw()) continue;
 
         // Renderizar fondo
-        if (backgroundTexture.getSize().x > 0 && backgroundTexture.getSize().y > 0) {
+        if (backgroundTexture->getSize().x > 0 && backgroundTexture->getSize().y > 0) {
             window.draw(backgroundSprite);
         } else {
             window.clear(sf::Color(34, 139, 34));
         }
         game.draw(window);
+        Profiler::drawOverlay(window, *overlayFont);
         window.display();
+        Profiler::setSteadyState(game.isInPlay());
+        Profiler::endFrame();
+
+        // Unattended check: stop after enough checked frames, or when the run
+        // ends on its own. Closing directly skips the session suspend.
+        if (allocCheck) {
+            allocCheckPlayed = allocCheckPlayed || game.isInPlay();
+            if (Profiler::allocCheckDone() || (allocCheckPlayed && game.isIdleScreen())) window.close();
+        }
+
+        if (framesShown++ == 0) {
+            StartupTimeline::mark("first frame");
+            game.startMusic();
+            StartupTimeline::mark("music started");
+        }
     }
 
-    return 0;
+    // Lets the simulation apply the final close event (session suspend) first
+    simRunning = false;
+    simThread.join();
+    if (broadcaster) broadcaster->stop();
+
+    if (Profiler::isTracing()) Profiler::writeTrace(TRACE_FILE);
+
+    Log::stop();
+    // Non-zero when SNAKE_ALLOC_CHECK is set and steady gameplay allocated
+    return Profiler::allocCheckExitCode();
 }
@@ -1,67 +1,45 @@
 #include "SnakeRenderer.hpp"
+#include "AssetManager.hpp"
 #include <iostream>
-#include <fstream>
 
 SnakeRenderer::SnakeRenderer() = default;
 
-bool SnakeRenderer::loadTexture(sf::Texture& tex, const std::string& path) {
-    auto findAsset = [&](const std::string &p)->std::string {
-        // try exact
-        std::ifstream f(p);
-        if (f.good()) { f.close(); return p; }
-        // if starts with ../ try without it
-        if (p.rfind("../", 0) == 0) {
-            std::string alt = p.substr(3);
-            std::ifstream f2(alt);
-            if (f2.good()) { f2.close(); return alt; }
-        }
-        // try with ../ prefix if not present
-        if (p.rfind("../", 0) != 0) {
-            std::string alt = std::string("../") + p;
-            std::ifstream f2(alt);
-            if (f2.good()) { f2.close(); return alt; }
-        }
-        return std::string();
-    };
-
-    std::string candidate = findAsset(path);
-    if (candidate.empty()) {
-        std::cerr << "Failed to find texture file: " << path << '\n';
-        return false;
-    }
-    if (!tex.loadFromFile(candidate)) {
-        std::cerr << "Failed to load texture from: " << candidate << '\n';
-        return false;
-    }
-    return true;
+bool SnakeRenderer::loadTexture(std::shared_ptr<sf::Texture>& tex, const std::string& path) {
+    AssetManager& assets = AssetManager::instance();
+    // Only needed once a game starts, so they decode in the background
+    tex = assets.textureAsync(path, LoadPriority::Background);
+    return assets.exists(path);
 }
 
 bool SnakeRenderer::loadSprites() {
-    bool allLoaded = true;
+    bool allFound = true;
 
     // Load head
-    if (!loadTexture(headTexture, "../assets/images/weedle_head.png")) {
-        allLoaded = false;
+    if (!loadTexture(headTexture, "images/weedle_head.png")) {
+        allFound = false;
     }
 
     // Load body (single sprite)
-    if (!loadTexture(bodyTexture, "../assets/images/weedle_body.png")) {
-        allLoaded = false;
+    if (!loadTexture(bodyTexture, "images/weedle_body.png")) {
+        allFound = false;
     }
 
     // Load tail
-    if (!loadTexture(tailTexture, "../assets/images/weedle_tail.png")) {
-        allLoaded = false;
+    if (!loadTexture(tailTexture, "images/weedle_tail.png")) {
+        allFound = false;
     }
 
-    if (allLoaded) {
-        std::cout << "SnakeRenderer: All sprites loaded successfully\n";
-    }
-    loaded = allLoaded;
-    return allLoaded;
+    return allFound;
+}
+
+bool SnakeRenderer::isLoaded() const {
+    // Sprites are usable once all three textures have been uploaded
+    return headTexture && headTexture->getSize().x > 0 &&
+           bodyTexture && bodyTexture->getSize().x > 0 &&
+           tailTexture && tailTexture->getSize().x > 0;
 }
 
-static void drawSprite(sf::RenderWindow& window, const sf::Texture& tex, int x, int y, int blockSize, float spriteScale) {
+static void drawSprite(sf::RenderTarget& window, const sf::Texture& tex, int x, int y, int blockSize, float spriteScale) {
     sf::Sprite sprite(tex);
     float texW = (float)tex.getSize().x;
     float texH = (float)tex.getSize().y;
@@ -74,7 +52,7 @@ static void drawSprite(sf::RenderWindow& window, const sf::Texture& tex, int x,
     window.draw(sprite);
 }
 
-static void drawSpriteWithRotation(sf::RenderWindow& window, const sf::Texture& tex, int x, int y, int blockSize, int dirX, int dirY, float spriteScale, float extraRotation = 0.f) {
+static void drawSpriteWithRotation(sf::RenderTarget& window, const sf::Texture& tex, int x, int y, int blockSize, int dirX, int dirY, float spriteScale, float extraRotation = 0.f) {
     sf::Sprite sprite(tex);
     float texW = (float)tex.getSize().x;
     float texH = (float)tex.getSize().y;
@@ -113,21 +91,35 @@ static void drawSpriteWithRotation(sf::RenderWindow& window, const sf::Texture&
     window.draw(sprite);
 }
 
-void SnakeRenderer::drawHead(sf::RenderWindow& window, int x, int y, int blockSize, int dirX, int dirY) {
-    if (!loaded) return;
-    drawSpriteWithRotation(window, headTexture, x, y, blockSize, dirX, dirY, spriteScale);
+void SnakeRenderer::drawHead(sf::RenderTarget& window, int x, int y, int blockSize, int dirX, int dirY) {
+    if (!isLoaded()) return;
+    drawSpriteWithRotation(window, *headTexture, x, y, blockSize, dirX, dirY, spriteScale);
 }
 
-void SnakeRenderer::drawBody(sf::RenderWindow& window, int x, int y, int blockSize, int dirX, int dirY) {
-    if (!loaded) return;
+void SnakeRenderer::drawBody(sf::RenderTarget& window, int x, int y, int blockSize, int dirX, int dirY) {
+    if (!isLoaded()) return;
     // Rotate the body sprite according to the local direction between neighboring segments.
     // This will make horizontal segments display correctly (they were appearing vertical).
-    drawSpriteWithRotation(window, bodyTexture, x, y, blockSize, dirX, dirY, spriteScale);
+    drawSpriteWithRotation(window, *bodyTexture, x, y, blockSize, dirX, dirY, spriteScale);
 }
 
-void SnakeRenderer::drawTail(sf::RenderWindow& window, int x, int y, int blockSize, int dirX, int dirY) {
-    if (!loaded) return;
+void SnakeRenderer::drawTail(sf::RenderTarget& window, int x, int y, int blockSize, int dirX, int dirY) {
+    if (!isLoaded()) return;
     // Draw tail with configurable extra rotation (180 if enabled)
     float extra = tailRotate180 ? 180.f : 0.f;
-    drawSpriteWithRotation(window, tailTexture, x, y, blockSize, dirX, dirY, spriteScale, extra);
+    drawSpriteWithRotation(window, *tailTexture, x, y, blockSize, dirX, dirY, spriteScale, extra);
+}
+
+void cellquad::append(sf::VertexArray& vertices, int x, int y, float blockSize, sf::Color color, float inset) {
+    float x0 = (float)x * blockSize + inset, y0 = (float)y * blockSize + inset;
+    float x1 = (float)(x + 1) * blockSize - inset, y1 = (float)(y + 1) * blockSize - inset;
+    vertices.append(sf::Vertex(sf::Vector2f(x0, y0), color));
+    vertices.append(sf::Vertex(sf::Vector2f(x1, y0), color));
+    vertices.append(sf::Vertex(sf::Vector2f(x1, y1), color));
+    vertices.append(sf::Vertex(sf::Vector2f(x0, y1), color));
+}
+
+sf::Color cellquad::fruitColor(Fruit::Type type) {
+    return type == Fruit::Type::Gomu ? sf::Color::Red
+         : type == Fruit::Type::Mera ? sf::Color(255, 140, 0) : sf::Color(255, 0, 255);
 }
@@ -0,0 +1,263 @@
+#include "AssetManager.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+AssetManager& AssetManager::instance() {
+    static AssetManager manager;
+    return manager;
+}
+
+AssetManager::AssetManager() {
+    // The game may be launched from the repo root or from bin/.
+    // A packed archive wins over the loose tree: one mapping, no directory walk.
+    const char* packCandidates[] = {"assets.pak", "../assets.pak"};
+    for (const char* c : packCandidates) {
+        if (archive.open(c)) {
+            root = c;
+            std::cout << "AssetManager: mapped " << archive.size() << " packed assets from " << root << "\n";
+            return;
+        }
+    }
+
+    // Development fallback: loose files under assets/
+    const char* candidates[] = {"assets", "../assets"};
+    for (const char* c : candidates) {
+        std::error_code ec;
+        if (fs::is_directory(c, ec)) { root = c; break; }
+    }
+    if (root.empty()) {
+        std::cerr << "AssetManager: assets directory not found\n";
+        return;
+    }
+    indexAssets();
+    std::cout << "AssetManager: indexed " << index.size() << " files under " << root << "\n";
+}
+
+AssetManager::~AssetManager() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (auto& w : workers) w.join();
+}
+
+void AssetManager::indexAssets() {
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec)) continue;
+        std::string rel = fs::relative(it->path(), root, ec).generic_string();
+        if (ec) continue;
+        index[rel] = it->path().generic_string();
+    }
+}
+
+std::string AssetManager::normalize(const std::string& name) {
+    std::string n = name;
+    if (n.rfind("../", 0) == 0) n = n.substr(3);
+    if (n.rfind("assets/", 0) == 0) n = n.substr(7);
+    return n;
+}
+
+std::string AssetManager::resolve(const std::string& name) const {
+    auto it = index.find(normalize(name));
+    return it == index.end() ? std::string() : it->second;
+}
+
+bool AssetManager::exists(const std::string& name) const {
+    std::string key = normalize(name);
+    return archive.find(key) != nullptr || index.count(key) > 0;
+}
+
+// Fonts, sound buffers and encoded images read straight from the mapping
+template <typename T>
+static bool loadPacked(T& res, const AssetArchive& archive, const pak::Entry& e) {
+    return res.loadFromMemory(archive.data(e), (std::size_t)e.size);
+}
+
+// Pre-decoded sprites skip the decoder and go to the GPU from the mapped pixels
+static bool loadPacked(sf::Texture& tex, const AssetArchive& archive, const pak::Entry& e) {
+    if (e.format != (std::uint32_t)pak::Format::RGBA8) {
+        return tex.loadFromMemory(archive.data(e), (std::size_t)e.size);
+    }
+    if (!pak::sizeMatches(e) || !tex.create(e.width, e.height)) return false;
+    tex.update((const sf::Uint8*)archive.data(e));
+    return true;
+}
+
+template <typename T>
+std::shared_ptr<T> AssetManager::acquire(std::unordered_map<std::string, std::weak_ptr<T>>& cache,
+                                         const std::string& name, const char* kind) {
+    std::string key = normalize(name);
+    std::string slot = std::string(kind) + ":" + key;
+    std::shared_ptr<T> res;
+    {
+        // A caller asking for what another one is loading waits for it;
+        // everything else goes ahead
+        std::unique_lock<std::mutex> lock(cacheMutex);
+        cacheLoaded.wait(lock, [&] { return loading.count(slot) == 0; });
+        if (auto existing = cache[key].lock()) return existing;
+        res = std::make_shared<T>();
+        cache[key] = res;
+        loading.insert(slot);
+    }
+
+    {
+        PROFILE_ZONE("asset load");
+        if (const pak::Entry* e = archive.find(key)) {
+            if (loadPacked(*res, archive, *e)) std::cout << "Loaded " << kind << ": " << root << ":" << key << "\n";
+            else std::cerr << "Failed to load " << kind << " from: " << root << ":" << key << "\n";
+        } else {
+            std::string path = resolve(key);
+            if (path.empty()) {
+                std::cerr << kind << " not found in assets: " << key << "\n";
+            } else if (res->loadFromFile(path)) {
+                std::cout << "Loaded " << kind << ": " << path << "\n";
+            } else {
+                std::cerr << "Failed to load " << kind << " from: " << path << "\n";
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    loading.erase(slot);
+    cacheLoaded.notify_all();
+    return res;
+}
+
+std::shared_ptr<sf::Texture> AssetManager::texture(const std::string& name) {
+    return acquire(textures, name, "texture");
+}
+
+std::shared_ptr<sf::Font> AssetManager::font(const std::string& name) {
+    return acquire(fonts, name, "font");
+}
+
+std::shared_ptr<sf::SoundBuffer> AssetManager::soundBuffer(const std::string& name) {
+    return acquire(soundBuffers, name, "sound");
+}
+
+std::shared_ptr<sf::Texture> AssetManager::textureAsync(const std::string& name, LoadPriority priority) {
+    std::string key = normalize(name);
+    std::shared_ptr<sf::Texture> tex;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (auto existing = textures[key].lock()) return existing;
+        tex = std::make_shared<sf::Texture>();
+        textures[key] = tex;
+    }
+    DecodeJob job;
+    job.target = tex;
+    job.priority = priority;
+    job.packed = archive.find(key);
+    job.path = job.packed ? root + ":" + key : resolve(key);
+    if (job.path.empty()) {
+        std::cerr << "texture not found in assets: " << key << "\n";
+        return tex;
+    }
+
+    std::lock_guard<std::mutex> lock(jobMutex);
+    outstanding[(int)priority]++;
+    if (job.packed && job.packed->format == (std::uint32_t)pak::Format::RGBA8) {
+        // Nothing to decode: hand it straight to the next upload
+        job.decoded = true;
+        decoded.push_back(std::move(job));
+        jobDone.notify_all();
+        return tex;
+    }
+    if (workers.empty()) startWorkers();
+    queued[(int)priority].push_back(std::move(job));
+    jobReady.notify_one();
+    return tex;
+}
+
+void AssetManager::startWorkers() {
+    unsigned n = std::thread::hardware_concurrency();
+    n = std::max(1u, std::min(4u, n > 1 ? n - 1 : 1u)); // leave a core to the render thread
+    for (unsigned i = 0; i < n; ++i) workers.emplace_back(&AssetManager::workerLoop, this);
+}
+
+void AssetManager::workerLoop() {
+    std::unique_lock<std::mutex> lock(jobMutex);
+    while (true) {
+        jobReady.wait(lock, [&] { return stopping || !queued[0].empty() || !queued[1].empty(); });
+        if (stopping) return;
+        // Critical (menu) images always go first
+        auto& q = !queued[0].empty() ? queued[0] : queued[1];
+        DecodeJob job = std::move(q.front());
+        q.pop_front();
+
+        lock.unlock();
+        {
+            PROFILE_ZONE("asset decode");
+            if (job.packed) job.decoded = job.image.loadFromMemory(archive.data(*job.packed), (std::size_t)job.packed->size);
+            else job.decoded = job.image.loadFromFile(job.path);
+        }
+        lock.lock();
+
+        decoded.push_back(std::move(job));
+        jobDone.notify_all();
+    }
+}
+
+int AssetManager::pumpUploads() {
+    std::vector<DecodeJob> ready;
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        if (decoded.empty()) return 0;
+        ready.swap(decoded);
+    }
+    PROFILE_ZONE("asset upload");
+    // Textures are only touched here, on the thread that owns the GL context
+    for (auto& job : ready) {
+        bool ok = job.decoded;
+        if (ok && job.packed && job.packed->format == (std::uint32_t)pak::Format::RGBA8) {
+            ok = loadPacked(*job.target, archive, *job.packed);
+        } else if (ok) {
+            ok = job.target->loadFromImage(job.image);
+        }
+        if (ok) {
+            std::cout << "Loaded texture: " << job.path << "\n";
+        } else {
+            std::cerr << "Failed to load texture from: " << job.path << "\n";
+        }
+    }
+    std::lock_guard<std::mutex> lock(jobMutex);
+    for (auto& job : ready) outstanding[(int)job.priority]--;
+    return (int)ready.size();
+}
+
+void AssetManager::finishLoading(LoadPriority upTo) {
+    auto pending = [&] {
+        int n = 0;
+        for (int p = 0; p <= (int)upTo; ++p) n += outstanding[p];
+        return n;
+    };
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            if (pending() == 0) return;
+            jobDone.wait(lock, [&] { return !decoded.empty(); });
+        }
+        pumpUploads();
+    }
+}
+
+bool AssetManager::isLoading() const {
+    std::lock_guard<std::mutex> lock(jobMutex);
+    return outstanding[0] + outstanding[1] > 0;
+}
+
+bool AssetManager::openMusic(sf::Music& music, const std::string& name) {
+    std::string key = normalize(name);
+    // Streams from the mapping, which outlives any sf::Music
+    if (const pak::Entry* e = archive.find(key)) {
+        return music.openFromMemory(archive.data(*e), (std::size_t)e->size);
+    }
+    std::string path = resolve(key);
+    return !path.empty() && music.openFromFile(path);
+}
@@ -0,0 +1,26 @@
+#include "StartupTimeline.hpp"
+#include <cstdio>
+
+// Started during static initialization, i.e. as close to process start as we get
+sf::Clock StartupTimeline::clock;
+std::vector<StartupTimeline::Entry> StartupTimeline::entries;
+bool StartupTimeline::reported = false;
+
+void StartupTimeline::mark(const std::string& label) {
+    entries.push_back({label, elapsedMs()});
+}
+
+float StartupTimeline::elapsedMs() {
+    return clock.getElapsedTime().asMicroseconds() / 1000.f;
+}
+
+void StartupTimeline::report() {
+    reported = true;
+    std::printf("=== Startup timeline ===\n");
+    float prev = 0.f;
+    for (const auto& e : entries) {
+        std::printf("%8.1f ms  (+%7.1f)  %s\n", e.ms, e.ms - prev, e.label.c_str());
+        prev = e.ms;
+    }
+    std::printf("========================\n");
+}
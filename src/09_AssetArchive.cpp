@@ -0,0 +1,96 @@
+#include "AssetArchive.hpp"
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+AssetArchive::~AssetArchive() {
+    close();
+}
+
+bool AssetArchive::open(const std::string& path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fsize;
+    if (!GetFileSizeEx(file, &fsize) || fsize.QuadPart == 0) { CloseHandle(file); return false; }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) { CloseHandle(file); return false; }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) { CloseHandle(mapping); CloseHandle(file); return false; }
+    fileHandle = file;
+    mappingHandle = mapping;
+    base = (const unsigned char*)view;
+    mappedSize = (std::size_t)fsize.QuadPart;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); return false; }
+    void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (view == MAP_FAILED) return false;
+    base = (const unsigned char*)view;
+    mappedSize = (std::size_t)st.st_size;
+#endif
+
+    // Validate before trusting any offset in the file
+    const pak::Header* h = (const pak::Header*)base;
+    bool ok = mappedSize >= sizeof(pak::Header) &&
+              std::memcmp(h->magic, pak::MAGIC, 4) == 0 &&
+              h->version == pak::VERSION &&
+              h->fileSize == mappedSize &&
+              h->indexOffset + (std::uint64_t)h->entryCount * sizeof(pak::Entry) <= mappedSize;
+    if (ok) {
+        entries = (const pak::Entry*)(base + h->indexOffset);
+        count = h->entryCount;
+        for (std::uint32_t i = 0; i < count && ok; ++i) {
+            const pak::Entry& e = entries[i];
+            ok = e.offset + e.size <= mappedSize && e.name[pak::NAME_SIZE - 1] == '\0' && pak::sizeMatches(e);
+        }
+    }
+    if (!ok) {
+        std::cerr << "AssetArchive: " << path << " is corrupt or from another version\n";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void AssetArchive::close() {
+    if (!base) return;
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle((HANDLE)mappingHandle);
+    CloseHandle((HANDLE)fileHandle);
+    mappingHandle = fileHandle = nullptr;
+#else
+    munmap((void*)base, mappedSize);
+#endif
+    base = nullptr;
+    mappedSize = 0;
+    entries = nullptr;
+    count = 0;
+}
+
+const pak::Entry* AssetArchive::find(const std::string& name) const {
+    std::uint32_t lo = 0, hi = count;
+    while (lo < hi) {
+        std::uint32_t mid = (lo + hi) / 2;
+        int c = std::strcmp(entries[mid].name, name.c_str());
+        if (c == 0) return &entries[mid];
+        if (c < 0) lo = mid + 1; else hi = mid;
+    }
+    return nullptr;
+}
@@ -0,0 +1,129 @@
+#include "SoundEffects.hpp"
+#include "AssetManager.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+std::int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// File name, priority (higher steals lower) and a fallback tone: a sine sweep
+// from f0 to f1 Hz with a short attack and exponential decay.
+struct SfxDesc { const char* file; int priority; float f0, f1, seconds; };
+
+const SfxDesc SFX_TABLE[(size_t)Sfx::Count] = {
+    {"sfx/eat_gomu.wav",        1, 660.f,  880.f,  0.08f},
+    {"sfx/eat_mera.wav",        2, 520.f,  1040.f, 0.14f},
+    {"sfx/eat_ope.wav",         2, 440.f,  1320.f, 0.20f},
+    {"sfx/portal_spawn.wav",    3, 220.f,  660.f,  0.35f},
+    {"sfx/portal_teleport.wav", 3, 880.f,  180.f,  0.45f},
+    {"sfx/countdown_tick.wav",  2, 440.f,  440.f,  0.10f},
+    {"sfx/countdown_go.wav",    3, 880.f,  880.f,  0.25f},
+    {"sfx/game_over.wav",       4, 392.f,  98.f,   0.80f},
+};
+
+bool synthesize(sf::SoundBuffer& buf, const SfxDesc& d) {
+    const unsigned rate = 44100;
+    const std::size_t n = (std::size_t)(d.seconds * rate);
+    std::vector<sf::Int16> samples(n);
+    double phase = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        float t = (float)i / (float)n;
+        float freq = d.f0 + (d.f1 - d.f0) * t;
+        phase += 2.0 * 3.14159265358979 * freq / rate;
+        float env = std::min(1.f, (float)i / (rate * 0.005f)) * std::exp(-4.f * t);
+        samples[i] = (sf::Int16)(std::sin(phase) * env * 12000.f);
+    }
+    return buf.loadFromSamples(samples.data(), samples.size(), 1, rate);
+}
+
+} // namespace
+
+SoundEffects::SoundEffects() {
+    loadBuffers();
+}
+
+SoundEffects::~SoundEffects() {
+    LatencyStats s = getLatencyStats();
+    if (s.count > 0 || s.dropped > 0 || s.outranked > 0) {
+        std::printf("SFX: %llu sounds, trigger->play avg %.1f us, max %.1f us, %llu voices stolen, %llu dropped, %llu outranked\n",
+                    (unsigned long long)s.count, s.avgUs, s.maxUs, (unsigned long long)s.stolen,
+                    (unsigned long long)s.dropped, (unsigned long long)s.outranked);
+    }
+    for (auto& v : voices) v.sound.stop();
+}
+
+void SoundEffects::loadBuffers() {
+    AssetManager& assets = AssetManager::instance();
+    for (size_t i = 0; i < (size_t)Sfx::Count; ++i) {
+        const SfxDesc& d = SFX_TABLE[i];
+        if (assets.exists(d.file)) {
+            buffers[i] = assets.soundBuffer(d.file);
+        } else {
+            buffers[i] = std::make_shared<sf::SoundBuffer>();
+            if (!synthesize(*buffers[i], d)) std::cerr << "Failed to synthesize " << d.file << "\n";
+        }
+    }
+}
+
+void SoundEffects::trigger(Sfx id) {
+    if (!queue.push({id, nowNs()})) droppedEvents.fetch_add(1, std::memory_order_relaxed);
+}
+
+SoundEffects::Voice* SoundEffects::pickVoice(int priority) {
+    Voice* victim = nullptr;
+    for (auto& v : voices) {
+        if (v.sound.getStatus() != sf::SoundSource::Playing) return &v;
+        // Steal the oldest voice among those with the lowest priority
+        if (!victim || v.priority < victim->priority ||
+            (v.priority == victim->priority && v.startedNs < victim->startedNs)) {
+            victim = &v;
+        }
+    }
+    if (victim && victim->priority <= priority) {
+        stolenVoices++;
+        return victim;
+    }
+    return nullptr;
+}
+
+void SoundEffects::pump() {
+    Event e;
+    while (queue.pop(e)) {
+        const SfxDesc& d = SFX_TABLE[(size_t)e.id];
+        Voice* v = pickVoice(d.priority);
+        if (!v) {
+            outrankedEvents++;
+            continue;
+        }
+        v->sound.stop();
+        v->sound.setBuffer(*buffers[(size_t)e.id]);
+        v->sound.setVolume(volume);
+        v->sound.play();
+        v->priority = d.priority;
+        v->startedNs = nowNs();
+
+        double us = (v->startedNs - e.triggeredNs) / 1000.0;
+        latencyCount++;
+        latencySumUs += us;
+        if (us > latencyMaxUs) latencyMaxUs = us;
+    }
+}
+
+SoundEffects::LatencyStats SoundEffects::getLatencyStats() const {
+    LatencyStats s;
+    s.count = latencyCount;
+    s.avgUs = latencyCount ? latencySumUs / (double)latencyCount : 0.0;
+    s.maxUs = latencyMaxUs;
+    s.stolen = stolenVoices;
+    s.dropped = droppedEvents.load(std::memory_order_relaxed);
+    s.outranked = outrankedEvents;
+    return s;
+}
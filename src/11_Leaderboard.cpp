@@ -0,0 +1,295 @@
+#include "Leaderboard.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char* SNAPSHOT_MAGIC = "MSLB";
+const int SNAPSHOT_VERSION = 1;
+const std::size_t COMPACT_EVERY = 32; // log lines between compactions
+
+std::uint32_t crc32(const std::string& s) {
+    std::uint32_t c = 0xFFFFFFFFu;
+    for (unsigned char ch : s) {
+        c ^= ch;
+        for (int k = 0; k < 8; ++k) c = (c >> 1) ^ (0xEDB88320u & (0u - (c & 1u)));
+    }
+    return ~c;
+}
+
+// "<seq> <score> <time> <name>" is what the checksum covers
+std::string payload(const Leaderboard::Record& r) {
+    return std::to_string(r.seq) + " " + std::to_string(r.score) + " " + std::to_string(r.time) + " " + r.name;
+}
+
+std::string formatLine(const Leaderboard::Record& r) {
+    char crc[9];
+    std::snprintf(crc, sizeof(crc), "%08x", crc32(payload(r)));
+    return std::string(crc) + " " + payload(r) + "\n";
+}
+
+// "<crc> <seq> clear": every record before seq is gone
+std::string formatTombstone(std::uint64_t seq) {
+    std::string body = std::to_string(seq) + " clear";
+    char crc[9];
+    std::snprintf(crc, sizeof(crc), "%08x", crc32(body));
+    return std::string(crc) + " " + body + "\n";
+}
+
+bool parseTombstone(const std::string& line, std::uint64_t& seq) {
+    std::istringstream in(line);
+    std::string crc, word;
+    if (!(in >> crc >> seq >> word) || word != "clear") return false;
+    char expect[9];
+    std::snprintf(expect, sizeof(expect), "%08x", crc32(std::to_string(seq) + " clear"));
+    return crc == expect;
+}
+
+// Rejects torn or corrupted lines: the checksum must match the rest
+bool parseLine(const std::string& line, Leaderboard::Record& r) {
+    std::istringstream in(line);
+    std::string crc;
+    if (!(in >> crc >> r.seq >> r.score >> r.time)) return false;
+    in.get(); // single separator before the name
+    std::getline(in, r.name);
+    char expect[9];
+    std::snprintf(expect, sizeof(expect), "%08x", crc32(payload(r)));
+    return crc == expect;
+}
+
+// Push the bytes through the OS cache before we rely on them (rename, truncate)
+bool syncAndClose(std::FILE* f) {
+    bool ok = std::fflush(f) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(f)) == 0;
+#else
+    ok = ok && fsync(fileno(f)) == 0;
+#endif
+    return std::fclose(f) == 0 && ok;
+}
+
+std::string sanitizeName(const std::string& name) {
+    std::string out;
+    for (char c : name) {
+        if (c >= 32 && c < 127) out.push_back((char)std::toupper((unsigned char)c));
+    }
+    return out.empty() ? std::string("NOBODY") : out;
+}
+
+} // namespace
+
+Leaderboard::Leaderboard(const std::string& basePath, std::size_t capacity)
+    : logPath(basePath + ".log"), dataPath(basePath + ".dat"), tmpPath(basePath + ".tmp"),
+      capacity(capacity) {
+    std::error_code ec;
+    bool firstRun = !std::filesystem::exists(dataPath, ec) && !std::filesystem::exists(logPath, ec);
+    load();
+    writer = std::thread(&Leaderboard::writerLoop, this);
+    if (firstRun) importLegacyHighScore();
+}
+
+Leaderboard::~Leaderboard() {
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    writer.join();
+}
+
+void Leaderboard::load() {
+    std::uint64_t snapshotSeq = 0;
+    std::ifstream data(dataPath);
+    std::string line;
+    if (data && std::getline(data, line)) {
+        std::istringstream head(line);
+        std::string magic;
+        int version = 0;
+        if (head >> magic >> version >> snapshotSeq && magic == SNAPSHOT_MAGIC && version == SNAPSHOT_VERSION) {
+            Record r;
+            while (std::getline(data, line)) {
+                if (parseLine(line, r)) insertSorted(r);
+            }
+        } else {
+            std::cerr << "Leaderboard: ignoring unreadable " << dataPath << "\n";
+            snapshotSeq = 0;
+        }
+    }
+    nextSeq = snapshotSeq + 1;
+
+    // Replay everything appended after the snapshot was taken
+    std::ifstream log(logPath);
+    Record r;
+    while (log && std::getline(log, line)) {
+        std::uint64_t clearSeq;
+        if (parseTombstone(line, clearSeq)) {
+            if (clearSeq <= snapshotSeq) continue;
+            records.clear();
+            appendsSinceCompact++;
+            nextSeq = std::max(nextSeq, clearSeq + 1);
+            continue;
+        }
+        if (!parseLine(line, r)) continue; // torn tail from a crash
+        if (r.seq <= snapshotSeq) continue; // already compacted
+        insertSorted(r);
+        appendsSinceCompact++;
+        nextSeq = std::max(nextSeq, r.seq + 1);
+    }
+}
+
+// One-time migration from the old single-record highscore.txt, looked for
+// where the old loader did (first readable file wins)
+void Leaderboard::importLegacyHighScore() {
+    const char* candidates[] = {"../assets/highscore.txt", "assets/highscore.txt", "highscore.txt"};
+    for (const char* path : candidates) {
+        std::ifstream in(path);
+        int s = 0;
+        if (!(in >> s)) continue;
+        if (s <= 0) return;
+        std::string name;
+        std::getline(in, name);
+        std::getline(in, name);
+        std::size_t start = name.find_first_not_of(" \t\r\n");
+        submit(s, start == std::string::npos ? std::string() : name.substr(start));
+        return;
+    }
+}
+
+void Leaderboard::insertSorted(const Record& r) {
+    auto pos = std::upper_bound(records.begin(), records.end(), r, [](const Record& a, const Record& b) {
+        return a.score != b.score ? a.score > b.score : a.seq < b.seq;
+    });
+    records.insert(pos, r);
+    if (records.size() > capacity) records.pop_back();
+}
+
+int Leaderboard::submit(int score, const std::string& name) {
+    Record r{nextSeq++, score, (std::int64_t)std::time(nullptr), sanitizeName(name)};
+    int rank = rankOf(score);
+    insertSorted(r);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.appended.push_back(r);
+    if (++appendsSinceCompact >= COMPACT_EVERY) {
+        pending.compactRequested = true;
+        pending.snapshot = records;
+        pending.snapshotSeq = r.seq;
+        appendsSinceCompact = 0;
+    }
+    wake.notify_one();
+    return rank;
+}
+
+void Leaderboard::clear() {
+    records.clear();
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.appended.clear();
+    pending.compactRequested = true;
+    pending.snapshot.clear();
+    pending.clearSeq = nextSeq++;
+    pending.snapshotSeq = pending.clearSeq;
+    appendsSinceCompact = 0;
+    wake.notify_one();
+}
+
+std::vector<Leaderboard::Record> Leaderboard::top(std::size_t n) const {
+    return std::vector<Record>(records.begin(), records.begin() + (long)std::min(n, records.size()));
+}
+
+int Leaderboard::rankOf(int score) const {
+    // records are sorted descending: count those that stay ahead
+    auto pos = std::partition_point(records.begin(), records.end(), [&](const Record& r) { return r.score >= score; });
+    return (int)(pos - records.begin()) + 1;
+}
+
+void Leaderboard::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [&] {
+        return !writerBusy && pending.appended.empty() && !pending.compactRequested;
+    });
+}
+
+void Leaderboard::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&] { return stopping || !pending.appended.empty() || pending.compactRequested; });
+        if (stopping && pending.appended.empty() && !pending.compactRequested) return;
+
+        Pending work;
+        std::swap(work, pending);
+        writerBusy = true;
+        lock.unlock();
+
+        // A failed compaction leaves the old snapshot and log in place (log
+        // lines the new snapshot already holds are skipped on load), so the
+        // batch, and a clear as a tombstone, still go to the log
+        bool compacted = work.compactRequested && compact(work.snapshot, work.snapshotSeq, work.appended);
+        if (work.compactRequested && !compacted) std::cerr << "Leaderboard: compaction failed, appending instead\n";
+        if (!compacted && (!work.appended.empty() || work.clearSeq != 0)) appendToLog(work.appended, work.clearSeq);
+
+        lock.lock();
+        writerBusy = false;
+        idle.notify_all();
+    }
+}
+
+bool Leaderboard::appendToLog(const std::vector<Record>& batch, std::uint64_t clearSeq) {
+    std::FILE* f = std::fopen(logPath.c_str(), "ab");
+    if (!f) {
+        std::cerr << "Leaderboard: cannot append to " << logPath << "\n";
+        return false;
+    }
+    std::string buf = clearSeq != 0 ? formatTombstone(clearSeq) : std::string();
+    for (const auto& r : batch) buf += formatLine(r);
+    bool ok = std::fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+    return syncAndClose(f) && ok;
+}
+
+bool Leaderboard::compact(const std::vector<Record>& snapshot, std::uint64_t lastSeq,
+                          const std::vector<Record>& appended) {
+    std::FILE* f = std::fopen(tmpPath.c_str(), "wb");
+    if (!f) {
+        std::cerr << "Leaderboard: cannot write " << tmpPath << "\n";
+        return false;
+    }
+    std::string buf = std::string(SNAPSHOT_MAGIC) + " " + std::to_string(SNAPSHOT_VERSION) + " " + std::to_string(lastSeq) + "\n";
+    for (const auto& r : snapshot) buf += formatLine(r);
+    bool ok = std::fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+    if (!syncAndClose(f) || !ok) return false;
+
+    // Atomic swap: readers see either the old or the new snapshot, never half
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, dataPath, ec);
+    if (ec) {
+        std::cerr << "Leaderboard: rename failed: " << ec.message() << "\n";
+        return false;
+    }
+    // Lines up to lastSeq now live in the snapshot; start a fresh log with the
+    // records submitted after it was taken. If we crash before the log is
+    // replaced, the old lines are simply skipped on the next load.
+    std::vector<Record> carry;
+    for (const auto& r : appended) {
+        if (r.seq > lastSeq) carry.push_back(r);
+    }
+    f = std::fopen(tmpPath.c_str(), "wb");
+    if (!f) return false;
+    buf.clear();
+    for (const auto& r : carry) buf += formatLine(r);
+    ok = std::fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+    if (!syncAndClose(f) || !ok) return false;
+    std::filesystem::rename(tmpPath, logPath, ec);
+    return !ec;
+}
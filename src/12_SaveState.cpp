@@ -0,0 +1,45 @@
+#include "SaveState.hpp"
+#include <cstdio>
+
+namespace savestate {
+
+std::uint32_t checksum(const unsigned char* data, std::size_t size) {
+    std::uint32_t h = 2166136261u;
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+bool writeFile(const std::string& path, const std::vector<unsigned char>& bytes) {
+    // Write to a side file and rename, so a crash never leaves half a save
+    std::string tmp = path + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    std::remove(path.c_str()); // rename does not replace on Windows
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+bool readFile(const std::string& path, std::vector<unsigned char>& bytes) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    bool ok = size > 0;
+    if (ok) {
+        bytes.resize((std::size_t)size);
+        ok = std::fread(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    }
+    std::fclose(f);
+    return ok;
+}
+
+} // namespace savestate
@@ -0,0 +1,448 @@
+#include "Profiler.hpp"
+
+#ifdef SNAKE_PROFILE
+
+#include "SpscQueue.hpp"
+#include "AllocTracker.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+const int MAX_ZONES = 64;
+const int MAX_DEPTH = 32;
+const int HISTORY = 240;      // frames kept per zone for min/avg/p99
+const int STRIP_FRAMES = 120; // columns in the frame-time strip
+const int STRIP_PARTS = 8;
+const std::size_t TRACE_CAPACITY = 1 << 18; // events; about 6 MB, never grows
+
+struct Sample {
+    std::uint16_t zone;
+    std::uint16_t depth;
+    std::uint32_t allocs; // heap allocations inside the zone (inclusive)
+    std::uint64_t start;  // ns
+    std::uint64_t end;
+    std::uint64_t bytes;
+};
+
+// One per thread that ever opened a zone. The owning thread is the only
+// producer, the render thread (endFrame) the only consumer.
+struct ThreadBuffer {
+    SpscQueue<Sample, 4096> ring;
+    std::uint64_t starts[MAX_DEPTH];
+    AllocCounters startAllocs[MAX_DEPTH];
+    int depth = 0;
+    int tid = 0;
+};
+
+std::uint64_t nowNs() {
+    return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Taken during static initialization; the first frame spans startup
+const std::uint64_t processStart = nowNs();
+
+std::mutex registryMutex;
+const char* zoneNames[MAX_ZONES];
+std::atomic<int> zoneCount{0};
+// Buffers outlive their threads: worker threads are few and long-lived
+std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+thread_local ThreadBuffer* localBuffer = nullptr;
+
+ThreadBuffer* buffer() {
+    if (!localBuffer) {
+        std::unique_ptr<ThreadBuffer> b(new ThreadBuffer());
+        localBuffer = b.get();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        b->tid = (int)threadBuffers.size() + 1;
+        threadBuffers.push_back(std::move(b));
+    }
+    return localBuffer;
+}
+
+// Render-thread state
+struct ZoneHistory { float ms[HISTORY]; std::uint32_t allocs[HISTORY]; std::uint64_t bytes[HISTORY]; int count = 0; int next = 0; };
+ZoneHistory history[MAX_ZONES];
+float frameAccum[MAX_ZONES];
+std::uint32_t frameAllocs[MAX_ZONES];
+std::uint64_t frameBytes[MAX_ZONES];
+bool frameHit[MAX_ZONES];
+AllocCounters lastFrameCounters;
+
+struct FrameBar {
+    float totalMs = 0.f;
+    int parts = 0;
+    std::uint16_t zone[STRIP_PARTS];
+    float ms[STRIP_PARTS];
+};
+FrameBar strip[STRIP_FRAMES];
+int stripNext = 0;
+
+std::vector<Sample> flame;      // render-thread samples of the last frame
+std::vector<Sample> flameBuild;
+std::uint64_t frameStart = processStart, lastFrameStart = 0, lastFrameEnd = 0;
+int frameZone = -1;
+int overlayZone = -1;
+
+// Allocation check (SNAKE_ALLOC_CHECK=<warm-up frames>): once gameplay has
+// been steady for the warm-up, every frame that allocates is a failure.
+const char* allocCheckEnv = std::getenv("SNAKE_ALLOC_CHECK");
+const int allocCheckWarmup = allocCheckEnv && std::atoi(allocCheckEnv) > 0 ? std::atoi(allocCheckEnv) : 120;
+const char* allocFramesEnv = std::getenv("SNAKE_ALLOC_FRAMES");
+const long allocCheckFrames = allocFramesEnv && std::atol(allocFramesEnv) > 0 ? std::atol(allocFramesEnv) : 600;
+bool steadyState = false;
+long steadyFrames = 0, checkedFrames = 0, failedFrames = 0;
+std::uint64_t failedAllocs[MAX_ZONES];
+
+struct TraceEvent { Sample s; int tid; };
+std::vector<TraceEvent> traceEvents;
+bool tracing = std::getenv("SNAKE_TRACE") != nullptr;
+std::uint64_t traceDropped = 0; // events lost to a full buffer this recording
+int renderTid = 0;
+
+void traceEvent(const Sample& s, int tid) {
+    if (!tracing) return;
+    if (traceEvents.capacity() < TRACE_CAPACITY) traceEvents.reserve(TRACE_CAPACITY);
+    if (traceEvents.size() == TRACE_CAPACITY) {
+        // Keep the recording on so F4 or exit still writes what was captured
+        if (traceDropped++ == 0) {
+            std::printf("Trace buffer full (%zu events), dropping further events until it is written\n", TRACE_CAPACITY);
+        }
+        return;
+    }
+    traceEvents.push_back({s, tid});
+}
+
+sf::Color zoneColor(int zone) {
+    static const sf::Color palette[8] = {
+        sf::Color(230, 120, 70), sf::Color(90, 170, 230), sf::Color(120, 200, 100), sf::Color(220, 190, 70),
+        sf::Color(180, 110, 220), sf::Color(80, 200, 190), sf::Color(230, 100, 150), sf::Color(160, 160, 160)};
+    return palette[zone % 8];
+}
+
+void pushHistory(int zone, float ms, std::uint32_t allocs, std::uint64_t bytes) {
+    ZoneHistory& h = history[zone];
+    h.ms[h.next] = ms;
+    h.allocs[h.next] = allocs;
+    h.bytes[h.next] = bytes;
+    h.next = (h.next + 1) % HISTORY;
+    if (h.count < HISTORY) h.count++;
+}
+
+} // namespace
+
+bool Profiler::overlay = false;
+
+int Profiler::registerZone(const char* name) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    int n = zoneCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < n; ++i) {
+        if (std::strcmp(zoneNames[i], name) == 0) return i;
+    }
+    if (n == MAX_ZONES) return MAX_ZONES - 1; // shares the last slot rather than failing
+    zoneNames[n] = name;
+    zoneCount.store(n + 1, std::memory_order_release);
+    return n;
+}
+
+void Profiler::beginZone() {
+    ThreadBuffer* b = buffer();
+    if (b->depth < MAX_DEPTH) {
+        b->startAllocs[b->depth] = AllocTracker::thisThread();
+        b->starts[b->depth] = nowNs();
+    }
+    b->depth++;
+}
+
+void Profiler::endZone(int zone) {
+    ThreadBuffer* b = localBuffer;
+    b->depth--;
+    if (b->depth >= MAX_DEPTH) return;
+    std::uint64_t end = nowNs();
+    AllocCounters a = AllocTracker::thisThread();
+    const AllocCounters& a0 = b->startAllocs[b->depth];
+    // A full ring drops the sample instead of stalling the hot path
+    b->ring.push({(std::uint16_t)zone, (std::uint16_t)b->depth, (std::uint32_t)(a.allocs - a0.allocs),
+                  b->starts[b->depth], end, a.bytes - a0.bytes});
+}
+
+void Profiler::endFrame() {
+    if (frameZone < 0) frameZone = registerZone("frame");
+    if (overlayZone < 0) overlayZone = registerZone("profiler overlay");
+    std::uint64_t now = nowNs();
+    AllocCounters counters = AllocTracker::thisThread();
+    ThreadBuffer* self = buffer();
+    renderTid = self->tid;
+
+    std::fill(frameAccum, frameAccum + MAX_ZONES, 0.f);
+    std::fill(frameAllocs, frameAllocs + MAX_ZONES, 0u);
+    std::fill(frameBytes, frameBytes + MAX_ZONES, (std::uint64_t)0);
+    std::fill(frameHit, frameHit + MAX_ZONES, false);
+    flameBuild.clear();
+    FrameBar& bar = strip[stripNext];
+    bar.parts = 0;
+    // Top-level zones of the other threads (simulation ticks, snapshot
+    // publishing) also count against the allocation check
+    std::uint32_t otherAllocs = 0;
+    std::uint64_t otherBytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (auto& b : threadBuffers) {
+            Sample s;
+            while (b->ring.pop(s)) {
+                frameAccum[s.zone] += (float)(s.end - s.start) / 1e6f;
+                frameAllocs[s.zone] += s.allocs;
+                frameBytes[s.zone] += s.bytes;
+                frameHit[s.zone] = true;
+                traceEvent(s, b->tid);
+                if (b.get() != self) {
+                    if (s.depth == 0) { otherAllocs += s.allocs; otherBytes += s.bytes; }
+                    continue;
+                }
+                flameBuild.push_back(s);
+                if (s.depth == 0 && bar.parts < STRIP_PARTS) {
+                    bar.zone[bar.parts] = s.zone;
+                    bar.ms[bar.parts] = (float)(s.end - s.start) / 1e6f;
+                    bar.parts++;
+                }
+            }
+        }
+    }
+    // Everything the render thread allocated this frame, minus the overlay itself
+    std::uint32_t allocs = (std::uint32_t)(counters.allocs - lastFrameCounters.allocs) - frameAllocs[overlayZone];
+    std::uint64_t bytes = counters.bytes - lastFrameCounters.bytes - frameBytes[overlayZone];
+    lastFrameCounters = counters;
+    traceEvent({(std::uint16_t)frameZone, 0, allocs, frameStart, now, bytes}, self->tid);
+    frameAccum[frameZone] = (float)(now - frameStart) / 1e6f;
+    frameAllocs[frameZone] = allocs;
+    frameBytes[frameZone] = bytes;
+    frameHit[frameZone] = true;
+    int n = zoneCount.load(std::memory_order_acquire);
+    for (int z = 0; z < n; ++z) {
+        if (frameHit[z]) pushHistory(z, frameAccum[z], frameAllocs[z], frameBytes[z]);
+    }
+
+    if (allocCheckEnv) {
+        steadyFrames = steadyState ? steadyFrames + 1 : 0;
+        if (steadyFrames > allocCheckWarmup) {
+            checkedFrames++;
+            if (allocs + otherAllocs > 0) {
+                failedFrames++;
+                for (int z = 0; z < n; ++z) failedAllocs[z] += frameAllocs[z];
+                if (failedFrames <= 10) {
+                    std::printf("[alloc-check] frame %ld: %u allocs, %llu bytes:", checkedFrames, allocs + otherAllocs,
+                                (unsigned long long)(bytes + otherBytes));
+                    for (int z = 0; z < n; ++z) {
+                        if (z != frameZone && frameAllocs[z] > 0) std::printf(" %s=%u", zoneNames[z], frameAllocs[z]);
+                    }
+                    std::printf("\n");
+                }
+            }
+        }
+    }
+    bar.totalMs = frameAccum[frameZone];
+    stripNext = (stripNext + 1) % STRIP_FRAMES;
+
+    flame.swap(flameBuild);
+    lastFrameStart = frameStart;
+    lastFrameEnd = now;
+    frameStart = now;
+}
+
+void Profiler::setSteadyState(bool steady) {
+    steadyState = steady;
+}
+
+bool Profiler::allocCheckEnabled() {
+    return allocCheckEnv != nullptr;
+}
+
+bool Profiler::allocCheckDone() {
+    return allocCheckEnv && checkedFrames >= allocCheckFrames;
+}
+
+int Profiler::allocCheckExitCode() {
+    if (!allocCheckEnv) return 0;
+    if (checkedFrames == 0) {
+        std::printf("[alloc-check] FAIL: no steady-state frames after the %d-frame warm-up\n", allocCheckWarmup);
+        return 1;
+    }
+    if (failedFrames == 0) {
+        std::printf("[alloc-check] PASS: %ld steady-state frames without heap allocations\n", checkedFrames);
+        return 0;
+    }
+    std::printf("[alloc-check] FAIL: %ld of %ld steady-state frames allocated\n", failedFrames, checkedFrames);
+    int n = zoneCount.load(std::memory_order_acquire);
+    for (int z = 0; z < n; ++z) {
+        if (z != frameZone && failedAllocs[z] > 0) {
+            std::printf("  %-28s %8llu allocs\n", zoneNames[z], (unsigned long long)failedAllocs[z]);
+        }
+    }
+    return 1;
+}
+
+void Profiler::toggleTrace() {
+    tracing = !tracing;
+    if (tracing) {
+        // Each recording starts empty; clear() keeps the reserved capacity
+        traceEvents.clear();
+        traceDropped = 0;
+    }
+    std::printf("Trace recording %s (%zu events so far)\n", tracing ? "on" : "off", traceEvents.size());
+}
+
+bool Profiler::isTracing() {
+    return tracing;
+}
+
+bool Profiler::writeTrace(const char* path) {
+    if (traceEvents.empty()) return false;
+    std::FILE* f = std::fopen(path, "w");
+    if (!f) {
+        std::fprintf(stderr, "Could not write trace to %s\n", path);
+        return false;
+    }
+    // Complete ("X") events carry begin and duration in one record; times in us
+    std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Mecha-Snake\"}}");
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto& b : threadBuffers) {
+            std::fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}",
+                         b->tid, b->tid == renderTid ? "render" : "worker", b->tid);
+        }
+    }
+    for (const TraceEvent& e : traceEvents) {
+        std::fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"allocs\":%u,\"bytes\":%llu}}",
+                     zoneNames[e.s.zone], e.tid,
+                     (double)(e.s.start - processStart) / 1000.0, (double)(e.s.end - e.s.start) / 1000.0,
+                     e.s.allocs, (unsigned long long)e.s.bytes);
+    }
+    std::fprintf(f, "\n]}\n");
+    bool ok = std::fclose(f) == 0;
+    std::printf("Wrote %zu trace events to %s\n", traceEvents.size(), path);
+    if (traceDropped > 0) {
+        std::printf("Trace buffer overflowed: %llu events dropped, the trace ends early\n", (unsigned long long)traceDropped);
+    }
+    return ok;
+}
+
+void Profiler::drawOverlay(sf::RenderWindow& window, const sf::Font& font) {
+    if (!overlay) return;
+    PROFILE_ZONE("profiler overlay");
+    const float x0 = 10.f, y0 = 10.f, width = 660.f, lineH = 18.f;
+    int n = zoneCount.load(std::memory_order_acquire);
+
+    int rows = 0;
+    for (int z = 0; z < n; ++z) if (history[z].count > 0) rows++;
+    float tableH = lineH * (rows + 1);
+    float flameY = y0 + 8.f + tableH + 8.f;
+    float flameH = 14.f * 6;
+    float stripY = flameY + flameH + 8.f;
+    float stripH = 60.f;
+
+    sf::RectangleShape panel({width, stripY + stripH + 8.f - y0});
+    panel.setPosition(x0, y0);
+    panel.setFillColor(sf::Color(0, 0, 0, 190));
+    window.draw(panel);
+
+    auto text = [&](const std::string& s, float x, float y, sf::Color c) {
+        sf::Text t(s, font, 13);
+        t.setFillColor(c);
+        t.setPosition(x, y);
+        window.draw(t);
+    };
+
+    // Table: rolling min / avg / p99 per zone, in milliseconds
+    float y = y0 + 4.f;
+    const float colMin = x0 + 260.f, colAvg = x0 + 345.f, colP99 = x0 + 430.f;
+    const float colAllocs = x0 + 515.f, colBytes = x0 + 585.f;
+    text("zone", x0 + 8.f, y, sf::Color(200, 200, 200));
+    text("min ms", colMin, y, sf::Color(200, 200, 200));
+    text("avg ms", colAvg, y, sf::Color(200, 200, 200));
+    text("p99 ms", colP99, y, sf::Color(200, 200, 200));
+    text("allocs", colAllocs, y, sf::Color(200, 200, 200));
+    text("bytes", colBytes, y, sf::Color(200, 200, 200));
+    std::vector<float> sorted;
+    char buf[32];
+    for (int z = 0; z < n; ++z) {
+        const ZoneHistory& h = history[z];
+        if (h.count == 0) continue;
+        y += lineH;
+        sorted.assign(h.ms, h.ms + h.count);
+        std::sort(sorted.begin(), sorted.end());
+        float sum = 0.f;
+        for (float v : sorted) sum += v;
+        double allocSum = 0.0, byteSum = 0.0;
+        for (int i = 0; i < h.count; ++i) { allocSum += h.allocs[i]; byteSum += (double)h.bytes[i]; }
+        float p99 = sorted[std::min(h.count - 1, (int)(h.count * 0.99f))];
+        sf::RectangleShape swatch({8.f, 8.f});
+        swatch.setFillColor(zoneColor(z));
+        swatch.setPosition(x0 + 8.f, y + 5.f);
+        window.draw(swatch);
+        text(zoneNames[z], x0 + 22.f, y, sf::Color::White);
+        std::snprintf(buf, sizeof(buf), "%.3f", sorted.front());
+        text(buf, colMin, y, sf::Color::White);
+        std::snprintf(buf, sizeof(buf), "%.3f", sum / h.count);
+        text(buf, colAvg, y, sf::Color::White);
+        std::snprintf(buf, sizeof(buf), "%.3f", p99);
+        text(buf, colP99, y, p99 > 16.7f ? sf::Color(255, 120, 120) : sf::Color::White);
+        // Average allocations per frame (per tick for GameLogic::update)
+        std::snprintf(buf, sizeof(buf), "%.1f", allocSum / h.count);
+        text(buf, colAllocs, y, allocSum > 0.0 ? sf::Color(255, 200, 90) : sf::Color::White);
+        std::snprintf(buf, sizeof(buf), "%.0f", byteSum / h.count);
+        text(buf, colBytes, y, sf::Color::White);
+    }
+
+    // Flame graph of the last frame on this thread: one row per nesting level
+    float span = (float)(lastFrameEnd - lastFrameStart);
+    if (span > 0.f) {
+        for (const Sample& s : flame) {
+            if (s.depth >= 6) continue;
+            float a = (float)(s.start - std::min(s.start, lastFrameStart)) / span;
+            float b = (float)(s.end - std::min(s.end, lastFrameStart)) / span;
+            float w = std::max(1.f, (std::min(b, 1.f) - a) * (width - 16.f));
+            sf::RectangleShape box({w, 13.f});
+            box.setPosition(x0 + 8.f + a * (width - 16.f), flameY + 14.f * s.depth);
+            box.setFillColor(zoneColor(s.zone));
+            window.draw(box);
+            if (w > 70.f) text(zoneNames[s.zone], box.getPosition().x + 2.f, box.getPosition().y - 2.f, sf::Color::Black);
+        }
+    }
+
+    // Frame-time strip: top-level zones stacked per frame, 33 ms full scale
+    const float barW = (width - 16.f) / STRIP_FRAMES;
+    const float msToPx = stripH / 33.3f;
+    for (int i = 0; i < STRIP_FRAMES; ++i) {
+        const FrameBar& bar = strip[(stripNext + i) % STRIP_FRAMES];
+        float bx = x0 + 8.f + i * barW;
+        float base = stripY + stripH;
+        float total = std::min(bar.totalMs * msToPx, stripH);
+        sf::RectangleShape back({barW - 1.f, total});
+        back.setPosition(bx, base - total);
+        back.setFillColor(sf::Color(90, 90, 90));
+        window.draw(back);
+        for (int p = 0; p < bar.parts && base > stripY; ++p) {
+            float h = std::min(bar.ms[p] * msToPx, base - stripY);
+            sf::RectangleShape seg({barW - 1.f, h});
+            seg.setPosition(bx, base - h);
+            seg.setFillColor(zoneColor(bar.zone[p]));
+            window.draw(seg);
+            base -= h;
+        }
+    }
+    sf::RectangleShape budget({width - 16.f, 1.f});
+    budget.setPosition(x0 + 8.f, stripY + stripH - 16.7f * msToPx);
+    budget.setFillColor(sf::Color(255, 255, 255, 120));
+    window.draw(budget);
+}
+
+#endif
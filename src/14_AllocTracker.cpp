@@ -0,0 +1,90 @@
+#include "AllocTracker.hpp"
+
+#ifdef SNAKE_PROFILE
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Plain data only: the hooks must not allocate or run constructors
+thread_local AllocCounters counters;
+
+void* countedAlloc(std::size_t size) {
+    if (size == 0) size = 1;
+    void* p = std::malloc(size);
+    if (p) {
+        counters.allocs++;
+        counters.bytes += size;
+    }
+    return p;
+}
+
+void* countedAlignedAlloc(std::size_t size, std::size_t align) {
+    if (size == 0) size = 1;
+    void* p = nullptr;
+#ifdef _WIN32
+    p = _aligned_malloc(size, align);
+#else
+    if (posix_memalign(&p, align < sizeof(void*) ? sizeof(void*) : align, size) != 0) p = nullptr;
+#endif
+    if (p) {
+        counters.allocs++;
+        counters.bytes += size;
+    }
+    return p;
+}
+
+void countedFree(void* p) {
+    if (!p) return;
+    counters.frees++;
+    std::free(p);
+}
+
+void countedAlignedFree(void* p) {
+    if (!p) return;
+    counters.frees++;
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+AllocCounters AllocTracker::thisThread() {
+    return counters;
+}
+
+void* operator new(std::size_t size) {
+    if (void* p = countedAlloc(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) {
+    if (void* p = countedAlloc(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new(std::size_t size, std::align_val_t al) {
+    if (void* p = countedAlignedAlloc(size, (std::size_t)al)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size, std::align_val_t al) {
+    if (void* p = countedAlignedAlloc(size, (std::size_t)al)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { countedAlignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { countedAlignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { countedAlignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { countedAlignedFree(p); }
+
+#endif
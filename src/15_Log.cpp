@@ -0,0 +1,134 @@
+#include "Log.hpp"
+#include "SpscQueue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// One ring per logging thread: that thread produces, the writer consumes
+struct LogBuffer {
+    SpscQueue<LogRecord, 1024> ring;
+    std::atomic<std::uint64_t> dropped{0};
+};
+
+std::mutex buffersMutex;
+std::vector<std::unique_ptr<LogBuffer>> buffers;
+thread_local LogBuffer* localBuffer = nullptr;
+
+std::thread writer;
+std::atomic<bool> running{false};
+std::uint64_t droppedReported = 0;
+
+std::uint64_t nowNs() {
+    return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const std::uint64_t startNs = nowNs();
+
+LogLevel levelFromEnv() {
+    const char* v = std::getenv("SNAKE_LOG");
+    if (!v) return LogLevel::Info;
+    static const char* names[] = {"trace", "debug", "info", "warn", "error"};
+    for (int i = 0; i < 5; ++i) {
+        if (std::strcmp(v, names[i]) == 0) return (LogLevel)i;
+    }
+    return LogLevel::Info;
+}
+
+void appendArg(std::string& out, const LogArg& a) {
+    char buf[32];
+    switch (a.type) {
+    case LogArg::Type::Int:    std::snprintf(buf, sizeof(buf), "%lld", a.i); break;
+    case LogArg::Type::Uint:   std::snprintf(buf, sizeof(buf), "%llu", a.u); break;
+    case LogArg::Type::Double: std::snprintf(buf, sizeof(buf), "%g", a.d); break;
+    case LogArg::Type::Str:    out += a.s ? a.s : "(null)"; return;
+    }
+    out += buf;
+}
+
+void format(std::string& out, const LogRecord& r) {
+    static const char* tags[] = {"TRACE", "DEBUG", "INFO ", "WARN ", "ERROR"};
+    char head[48];
+    std::snprintf(head, sizeof(head), "[%9.3f] %s ", (double)(r.timeNs - startNs) / 1e9, tags[(int)r.level]);
+    out += head;
+    int next = 0;
+    for (const char* p = r.fmt; *p; ++p) {
+        if (p[0] == '{' && p[1] == '}' && next < r.argc) {
+            appendArg(out, r.args[next++]);
+            ++p;
+        } else {
+            out += *p;
+        }
+    }
+    out += '\n';
+}
+
+// Writer side: collect every ring, order by time, print in one write per stream
+bool drain(std::vector<LogRecord>& batch, std::string& outText, std::string& errText) {
+    batch.clear();
+    std::uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (auto& b : buffers) {
+            LogRecord r;
+            while (b->ring.pop(r)) batch.push_back(r);
+            dropped += b->dropped.load(std::memory_order_relaxed);
+        }
+    }
+    if (batch.empty() && dropped == droppedReported) return false;
+    std::stable_sort(batch.begin(), batch.end(), [](const LogRecord& a, const LogRecord& b) { return a.timeNs < b.timeNs; });
+    outText.clear();
+    errText.clear();
+    for (const LogRecord& r : batch) format(r.level >= LogLevel::Warn ? errText : outText, r);
+    if (dropped != droppedReported) {
+        errText += "[log] " + std::to_string(dropped - droppedReported) + " records dropped (queue full)\n";
+        droppedReported = dropped;
+    }
+    if (!outText.empty()) { std::fwrite(outText.data(), 1, outText.size(), stdout); std::fflush(stdout); }
+    if (!errText.empty()) { std::fwrite(errText.data(), 1, errText.size(), stderr); std::fflush(stderr); }
+    return true;
+}
+
+void writerLoop() {
+    std::vector<LogRecord> batch;
+    std::string outText, errText;
+    while (running.load(std::memory_order_acquire)) {
+        if (!drain(batch, outText, errText)) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    while (drain(batch, outText, errText)) {}
+}
+
+} // namespace
+
+std::atomic<int> Log::threshold((int)levelFromEnv());
+
+void Log::start() {
+    if (running.exchange(true)) return;
+    writer = std::thread(writerLoop);
+}
+
+void Log::stop() {
+    if (!running.exchange(false)) return;
+    writer.join();
+}
+
+void Log::submit(LogRecord& r) {
+    if (!localBuffer) {
+        std::unique_ptr<LogBuffer> b(new LogBuffer());
+        localBuffer = b.get();
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffers.push_back(std::move(b));
+    }
+    r.timeNs = nowNs();
+    if (!localBuffer->ring.push(r)) localBuffer->dropped.fetch_add(1, std::memory_order_relaxed);
+}
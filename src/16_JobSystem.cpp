@@ -0,0 +1,147 @@
+#include "JobSystem.hpp"
+#include <algorithm>
+
+struct JobSystem::Job {
+    std::function<void()> fn;
+    std::atomic<int> pending{1}; // unfinished dependencies + the submit() call itself
+    std::atomic<bool> done{false};
+    std::mutex lock;             // guards finished / continuations
+    bool finished = false;
+    std::vector<Handle> continuations;
+};
+
+namespace {
+// Index of the calling thread's queue, -1 outside the pool
+thread_local int workerIndex = -1;
+}
+
+JobSystem& JobSystem::instance() {
+    static JobSystem jobs;
+    return jobs;
+}
+
+JobSystem::JobSystem() {
+    unsigned n = std::thread::hardware_concurrency();
+    n = std::max(1u, std::min(8u, n > 1 ? n - 1 : 1u)); // leave a core to the render thread
+    for (unsigned i = 0; i <= n; ++i) queues.emplace_back(new Queue());
+    for (unsigned i = 0; i < n; ++i) workers.emplace_back(&JobSystem::workerLoop, this, (int)i);
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> guard(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+JobSystem::Handle JobSystem::submit(std::function<void()> fn, std::initializer_list<Handle> after) {
+    Handle job = std::make_shared<Job>();
+    job->fn = std::move(fn);
+    job->pending.store(1 + (int)after.size(), std::memory_order_relaxed);
+    int ready = 1; // the submit token, plus dependencies that already finished
+    for (const Handle& dep : after) {
+        std::lock_guard<std::mutex> guard(dep->lock);
+        if (dep->finished) ready++;
+        else dep->continuations.push_back(job);
+    }
+    if (job->pending.fetch_sub(ready, std::memory_order_acq_rel) == ready) enqueue(job);
+    return job;
+}
+
+bool JobSystem::isDone(const Handle& job) {
+    return job->done.load(std::memory_order_acquire);
+}
+
+void JobSystem::wait(const Handle& job) {
+    while (!isDone(job)) {
+        Handle other = findJob();
+        if (other) execute(other);
+        else std::this_thread::yield();
+    }
+}
+
+void JobSystem::parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body) {
+    if (end <= begin) return;
+    grain = std::max(1, grain);
+    std::vector<Handle> chunks;
+    for (int first = begin + grain; first < end; first += grain) {
+        int last = std::min(end, first + grain);
+        chunks.push_back(submit([&body, first, last] { body(first, last); }));
+    }
+    // The first chunk runs here; then help until the rest are done
+    body(begin, std::min(end, begin + grain));
+    for (const Handle& c : chunks) wait(c);
+}
+
+void JobSystem::enqueue(Handle job) {
+    // Workers keep their own follow-up work; everyone else uses the injection queue
+    Queue& q = workerIndex >= 0 ? *queues[(size_t)workerIndex] : *queues.back();
+    {
+        std::lock_guard<std::mutex> guard(q.lock);
+        q.jobs.push_back(std::move(job));
+    }
+    queued.fetch_add(1, std::memory_order_release);
+    { std::lock_guard<std::mutex> guard(sleepMutex); }
+    wake.notify_one();
+}
+
+JobSystem::Handle JobSystem::findJob() {
+    if (queued.load(std::memory_order_acquire) == 0) return nullptr;
+    int count = (int)queues.size();
+    // Own queue newest-first (still hot in cache), then the injection queue,
+    // then steal the oldest job of another worker
+    if (workerIndex >= 0) {
+        Queue& own = *queues[(size_t)workerIndex];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.jobs.empty()) {
+            Handle job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    int start = workerIndex >= 0 ? workerIndex + 1 : 0;
+    for (int i = 0; i < count; ++i) {
+        int victim = (count - 1 + start + i) % count; // injection queue first
+        if (victim == workerIndex) continue;
+        Queue& q = *queues[(size_t)victim];
+        std::lock_guard<std::mutex> guard(q.lock);
+        if (q.jobs.empty()) continue;
+        Handle job = std::move(q.jobs.front());
+        q.jobs.pop_front();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return job;
+    }
+    return nullptr;
+}
+
+void JobSystem::execute(const Handle& job) {
+    job->fn();
+    job->fn = nullptr; // drop captures now, the handle may live on
+    std::vector<Handle> next;
+    {
+        std::lock_guard<std::mutex> guard(job->lock);
+        job->finished = true;
+        next.swap(job->continuations);
+    }
+    job->done.store(true, std::memory_order_release);
+    for (Handle& c : next) {
+        if (c->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) enqueue(std::move(c));
+    }
+}
+
+void JobSystem::workerLoop(int index) {
+    workerIndex = index;
+    while (true) {
+        Handle job = findJob();
+        if (job) {
+            execute(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(sleepMutex);
+        wake.wait(guard, [this] { return stopping.load() || queued.load(std::memory_order_acquire) > 0; });
+        if (stopping) return;
+    }
+}
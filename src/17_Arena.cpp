@@ -0,0 +1,431 @@
+#include "Arena.hpp"
+#include "Barrier.hpp"
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+#include "SnakeRenderer.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+std::uint32_t xorshift(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+sf::Color hueColor(float h) {
+    float r = std::fabs(h * 6.f - 3.f) - 1.f;
+    float g = 2.f - std::fabs(h * 6.f - 2.f);
+    float b = 2.f - std::fabs(h * 6.f - 4.f);
+    auto channel = [](float v) { return (sf::Uint8)(std::min(1.f, std::max(0.f, v)) * 200.f + 40.f); };
+    return sf::Color(channel(r), channel(g), channel(b));
+}
+
+const Cell DIRS[4] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+
+}
+
+sf::Color Arena::snakeColor(int id) {
+    return hueColor(std::fmod((float)id * 0.618034f, 1.f));
+}
+
+int Arena::boardSideFor(int snakeCount) {
+    return std::max(60, std::min(400, (int)std::sqrt((float)snakeCount * 80.f)));
+}
+
+Arena::Arena(int gridWidth, int gridHeight, int snakeCount, unsigned seed, float tickSeconds)
+    : gridWidth(gridWidth), gridHeight(gridHeight), tickSeconds(tickSeconds), rng(seed),
+      occupancy((size_t)(gridWidth * gridHeight), EMPTY),
+      fruitAt((size_t)(gridWidth * gridHeight), -1),
+      headClaim((size_t)(gridWidth * gridHeight), 0),
+      vertices(sf::Quads)
+{
+    snakeCount = std::max(1, std::min(snakeCount, (int)WALL - 1));
+    bodies.resize((size_t)snakeCount * MAX_LENGTH);
+    snakes.resize((size_t)snakeCount);
+    controlled.assign((size_t)snakeCount, 0);
+    dying.reserve((size_t)snakeCount);
+    gomuTarget = std::max(1, snakeCount / 2);
+    fruits.reserve((size_t)maxFruits(snakeCount));
+
+    // Same generator as single player, with the border on the board edge
+    Barrier walls(0, 0, gridWidth - 1, gridHeight - 1);
+    walls.generateRandom(rng, gridWidth, gridHeight, {});
+    for (const Cell& w : walls.getWalls()) occupancy[(size_t)index(w.x, w.y)] = WALL;
+
+    for (int id = 0; id < snakeCount; ++id) {
+        palette.push_back(snakeColor(id));
+        snakes[(size_t)id].rng = (seed ^ ((std::uint32_t)id * 2654435761u)) | 1u;
+        if (!spawnSnake((std::uint32_t)id)) snakes[(size_t)id].respawnTicks = RESPAWN_TICKS;
+    }
+    for (int i = 0; i < gomuTarget; ++i) spawnFruit(Fruit::Type::Gomu, 0.f);
+}
+
+Cell Arena::cellAt(std::uint32_t snake, std::uint32_t i) const {
+    return bodies[(size_t)snake * MAX_LENGTH + (snakes[snake].head + i) % MAX_LENGTH].cell();
+}
+
+void Arena::steer(int id, int dx, int dy) {
+    ArenaSnake& s = snakes[(size_t)id];
+    // Same rule as Snake::changeDirection: no turning back into the neck
+    if (dx == -s.dir.x && dy == -s.dir.y) return;
+    if (std::abs(dx) + std::abs(dy) != 1) return;
+    s.nextDir = {dx, dy};
+}
+
+void Arena::copyBody(int id, std::vector<Cell>& out) const {
+    const ArenaSnake& s = snakes[(size_t)id];
+    out.resize(s.alive ? s.length : 0);
+    for (std::uint32_t i = 0; i < (std::uint32_t)out.size(); ++i) out[i] = cellAt((std::uint32_t)id, i);
+}
+
+void Arena::copyWalls(std::vector<Cell>& out) const {
+    out.clear();
+    for (int y = 0; y < gridHeight; ++y) {
+        for (int x = 0; x < gridWidth; ++x) {
+            if (occupancy[(size_t)index(x, y)] == WALL) out.push_back({x, y});
+        }
+    }
+}
+
+std::size_t Arena::getMemoryBytes() const {
+    return occupancy.capacity() * sizeof(std::uint16_t) + fruitAt.capacity() * sizeof(std::int32_t) +
+           headClaim.capacity() * sizeof(std::uint16_t) + dying.capacity() * sizeof(std::uint32_t) +
+           bodies.capacity() * sizeof(PackedCell) + snakes.capacity() * sizeof(ArenaSnake) + controlled.capacity() +
+           fruits.capacity() * sizeof(Fruit) + portals.capacity() * sizeof(Portal) +
+           palette.capacity() * sizeof(sf::Color) + vertices.getVertexCount() * sizeof(sf::Vertex);
+}
+
+int Arena::getBestScore() const {
+    int best = 0;
+    for (const auto& s : snakes) best = std::max(best, s.score);
+    return best;
+}
+
+bool Arena::randomFreeCell(int& cell) {
+    std::uniform_int_distribution<int> distX(1, gridWidth - 2);
+    std::uniform_int_distribution<int> distY(1, gridHeight - 2);
+    for (int tries = 0; tries < 64; ++tries) {
+        int x = distX(rng), y = distY(rng);
+        int c = index(x, y);
+        if (occupancy[(size_t)c] != EMPTY || fruitAt[(size_t)c] >= 0) continue;
+        bool onPortal = false;
+        for (const Portal& p : portals) if (p.x == x && p.y == y) { onPortal = true; break; }
+        if (onPortal) continue;
+        cell = c;
+        return true;
+    }
+    return false;
+}
+
+// Length 3, heading up, with a free cell in front
+bool Arena::spawnSnake(std::uint32_t id) {
+    std::uniform_int_distribution<int> distX(1, gridWidth - 2);
+    std::uniform_int_distribution<int> distY(2, gridHeight - 4);
+    for (int tries = 0; tries < 100; ++tries) {
+        int x = distX(rng), y = distY(rng);
+        bool free = true;
+        for (int i = -1; i < 3 && free; ++i) free = occupancy[(size_t)index(x, y + i)] == EMPTY;
+        if (!free) continue;
+
+        ArenaSnake& s = snakes[id];
+        std::uint32_t rngState = s.rng;
+        std::uint32_t epoch = s.epoch;
+        s = ArenaSnake();
+        s.rng = rngState;
+        s.epoch = epoch + 1;
+        s.length = 3;
+        for (int i = 0; i < 3; ++i) {
+            bodies[(size_t)id * MAX_LENGTH + (size_t)i] = PackedCell::of({x, y + i});
+            occupancy[(size_t)index(x, y + i)] = (std::uint16_t)(id + 1);
+        }
+        s.alive = true;
+        aliveCount++;
+        return true;
+    }
+    return false;
+}
+
+void Arena::kill(std::uint32_t id) {
+    ArenaSnake& s = snakes[id];
+    for (std::uint32_t i = 0; i < s.length; ++i) {
+        Cell c = cellAt(id, i);
+        std::uint16_t& o = occupancy[(size_t)index(c.x, c.y)];
+        if (o == id + 1) o = EMPTY; // the tail cell may already belong to someone else
+    }
+    s.alive = false;
+    s.epoch++;
+    s.respawnTicks = RESPAWN_TICKS;
+    aliveCount--;
+}
+
+// Runs on the JobSystem: reads the shared grids, writes only snake `id`
+void Arena::decide(std::uint32_t id) {
+    ArenaSnake& s = snakes[id];
+    if (!s.alive || controlled[id]) return;
+    Cell head = cellAt(id, 0);
+
+    // Keep chasing the same fruit while it is there, otherwise look around
+    if (s.target < 0 || fruitAt[(size_t)s.target] < 0) {
+        s.target = -1;
+        const int R = 12;
+        int best = INT_MAX;
+        for (int y = std::max(0, head.y - R); y <= std::min(gridHeight - 1, head.y + R); ++y) {
+            for (int x = std::max(0, head.x - R); x <= std::min(gridWidth - 1, head.x + R); ++x) {
+                if (fruitAt[(size_t)index(x, y)] < 0) continue;
+                int d = std::abs(x - head.x) + std::abs(y - head.y);
+                if (d < best) { best = d; s.target = index(x, y); }
+            }
+        }
+    }
+    int tx = s.target >= 0 ? s.target % gridWidth : 0;
+    int ty = s.target >= 0 ? s.target / gridWidth : 0;
+
+    int bestScore = INT_MIN;
+    Cell choice = s.dir;
+    for (const Cell& d : DIRS) {
+        if (d.x == -s.dir.x && d.y == -s.dir.y) continue;
+        int nx = head.x + d.x, ny = head.y + d.y;
+        if (nx < 0 || ny < 0 || nx >= gridWidth || ny >= gridHeight) continue;
+        if (occupancy[(size_t)index(nx, ny)] != EMPTY) continue;
+        // Prefer cells with room around them, then the fruit, then going straight
+        int free = 0;
+        for (const Cell& e : DIRS) {
+            int ax = nx + e.x, ay = ny + e.y;
+            if (ax >= 0 && ay >= 0 && ax < gridWidth && ay < gridHeight && occupancy[(size_t)index(ax, ay)] == EMPTY) free++;
+        }
+        int score = free * 8;
+        if (s.target >= 0) score -= 3 * (std::abs(tx - nx) + std::abs(ty - ny));
+        else if (d.x == s.dir.x && d.y == s.dir.y) score += 4;
+        score += (int)(xorshift(s.rng) & 3);
+        if (score > bestScore) { bestScore = score; choice = d; }
+    }
+    s.nextDir = choice;
+}
+
+void Arena::tick() {
+    PROFILE_ZONE("arena tick");
+    tickCount++;
+    const std::uint32_t count = (std::uint32_t)snakes.size();
+    {
+        PROFILE_ZONE("arena decisions");
+        JobSystem::instance().parallelFor(0, (int)count, 64, [this](int first, int last) {
+            for (int id = first; id < last; ++id) decide((std::uint32_t)id);
+        });
+    }
+
+    // Tails leave first, so a head may follow a tail into the cell it frees
+    for (std::uint32_t id = 0; id < count; ++id) {
+        ArenaSnake& s = snakes[id];
+        if (!s.alive) continue;
+        s.dir = s.nextDir;
+        s.headOn = false;
+        Cell h = cellAt(id, 0);
+        int nx = h.x + s.dir.x, ny = h.y + s.dir.y;
+        s.moveTo = (nx < 0 || ny < 0 || nx >= gridWidth || ny >= gridHeight) ? -1 : index(nx, ny);
+        if (s.length >= (std::uint32_t)MAX_LENGTH) s.growPending = 0;
+        if (s.growPending == 0) {
+            Cell t = cellAt(id, s.length - 1);
+            std::uint16_t& o = occupancy[(size_t)index(t.x, t.y)];
+            if (o == id + 1) o = EMPTY;
+        }
+    }
+    // Two heads entering the same cell: both snakes die
+    for (std::uint32_t id = 0; id < count; ++id) {
+        ArenaSnake& s = snakes[id];
+        if (!s.alive || s.moveTo < 0) continue;
+        std::uint16_t& claim = headClaim[(size_t)s.moveTo];
+        if (claim == 0) claim = (std::uint16_t)(id + 1);
+        else { s.headOn = true; snakes[claim - 1u].headOn = true; }
+    }
+    // Move, or crash into a wall or any body (checked against this tick's
+    // bodies: crashed snakes are only removed afterwards)
+    dying.clear();
+    for (std::uint32_t id = 0; id < count; ++id) {
+        ArenaSnake& s = snakes[id];
+        if (!s.alive) continue;
+        if (s.moveTo >= 0) headClaim[(size_t)s.moveTo] = 0;
+        if (s.moveTo < 0 || s.headOn || occupancy[(size_t)s.moveTo] != EMPTY) {
+            dying.push_back(id);
+            continue;
+        }
+        s.head = (s.head + MAX_LENGTH - 1) % MAX_LENGTH;
+        bodies[(size_t)id * MAX_LENGTH + s.head] = PackedCell::of({s.moveTo % gridWidth, s.moveTo / gridWidth});
+        occupancy[(size_t)s.moveTo] = (std::uint16_t)(id + 1);
+        s.moves++;
+        if (s.growPending > 0) {
+            s.growPending--;
+            s.length++;
+        }
+    }
+    for (std::uint32_t id : dying) kill(id);
+
+    // Fruits, portals and the fruit timer, as in single player
+    for (std::uint32_t id = 0; id < count; ++id) {
+        ArenaSnake& s = snakes[id];
+        if (!s.alive) {
+            if (s.respawnTicks > 0 && --s.respawnTicks == 0 && !spawnSnake(id)) s.respawnTicks = RESPAWN_TICKS;
+            continue;
+        }
+        if (fruitAt[(size_t)s.moveTo] >= 0) eat(id, s.moveTo);
+        Cell h = cellAt(id, 0);
+        for (size_t p = 0; p < portals.size(); ++p) {
+            if (portals[p].x != h.x || portals[p].y != h.y) continue;
+            if (teleport(id)) {
+                portals[p] = portals.back();
+                portals.pop_back();
+            }
+            break;
+        }
+        s.fruitCountdown -= tickSeconds;
+        if (s.fruitCountdown <= 0.f) kill(id);
+    }
+
+    float now = (float)tickCount * tickSeconds;
+    for (size_t i = fruits.size(); i-- > 0;) {
+        const Fruit& f = fruits[i];
+        if (f.duration > 0.f && now - f.spawnTime >= f.duration) removeFruit(index(f.x, f.y));
+    }
+    if (now - lastSpawnCheck >= spawnCheckInterval) {
+        spawnCheck();
+        lastSpawnCheck = now;
+    }
+}
+
+void Arena::eat(std::uint32_t id, int cell) {
+    ArenaSnake& s = snakes[id];
+    Fruit::Type type = fruits[(size_t)fruitAt[(size_t)cell]].type;
+    removeFruit(cell);
+    switch (type) {
+        case Fruit::Type::Gomu:
+            s.score += 1;
+            s.growPending += 1;
+            s.fruitCountdown += 5.f;
+            spawnFruit(Fruit::Type::Gomu, 0.f);
+            break;
+        case Fruit::Type::Mera:
+            s.score += 5;
+            s.growPending += 2;
+            s.fruitCountdown += 10.f;
+            break;
+        case Fruit::Type::Ope:
+            s.score += 10;
+            s.growPending += 3;
+            s.fruitCountdown += 15.f;
+            break;
+    }
+    s.target = -1;
+    // Every 30 points a portal opens somewhere on the board
+    if (s.score >= s.nextPortalScore) {
+        s.nextPortalScore += 30;
+        int c;
+        if ((int)portals.size() < MAX_PORTALS && randomFreeCell(c)) {
+            Portal p;
+            p.x = c % gridWidth;
+            p.y = c / gridWidth;
+            p.active = true;
+            portals.push_back(p);
+        }
+    }
+}
+
+// Re-lay the body straight down from a free exit, head first, moving up.
+// Fails (and the portal stays) when the board is too crowded.
+bool Arena::teleport(std::uint32_t id) {
+    ArenaSnake& s = snakes[id];
+    int len = (int)s.length;
+    if (gridHeight - 2 - len < 2) return false;
+    std::uniform_int_distribution<int> distX(1, gridWidth - 2);
+    std::uniform_int_distribution<int> distY(2, gridHeight - 1 - len);
+    for (int tries = 0; tries < 50; ++tries) {
+        int ex = distX(rng), ey = distY(rng);
+        bool free = true;
+        for (int i = -1; i < len && free; ++i) free = occupancy[(size_t)index(ex, ey + i)] == EMPTY;
+        if (!free) continue;
+        for (std::uint32_t i = 0; i < s.length; ++i) {
+            Cell c = cellAt(id, i);
+            occupancy[(size_t)index(c.x, c.y)] = EMPTY;
+        }
+        s.head = 0;
+        for (int i = 0; i < len; ++i) {
+            bodies[(size_t)id * MAX_LENGTH + (size_t)i] = PackedCell::of({ex, ey + i});
+            occupancy[(size_t)index(ex, ey + i)] = (std::uint16_t)(id + 1);
+        }
+        s.dir = s.nextDir = {0, -1};
+        s.target = -1;
+        s.epoch++;
+        s.moves = 0;
+        return true;
+    }
+    return false;
+}
+
+void Arena::spawnFruit(Fruit::Type type, float duration) {
+    int c;
+    if (!randomFreeCell(c)) return;
+    Fruit f;
+    f.type = type;
+    f.x = c % gridWidth;
+    f.y = c / gridWidth;
+    f.spawnTime = (float)tickCount * tickSeconds;
+    f.duration = duration;
+    fruitAt[(size_t)c] = (std::int32_t)fruits.size();
+    fruits.push_back(f);
+    typeCount[(int)type]++;
+}
+
+void Arena::removeFruit(int cell) {
+    std::int32_t i = fruitAt[(size_t)cell];
+    typeCount[(int)fruits[(size_t)i].type]--;
+    fruits[(size_t)i] = fruits.back();
+    fruitAt[(size_t)index(fruits[(size_t)i].x, fruits[(size_t)i].y)] = i;
+    fruits.pop_back();
+    fruitAt[(size_t)cell] = -1;
+}
+
+// Single player rolls once per check for one Mera / one Ope; here the rolls
+// and the caps scale with the number of snakes
+void Arena::spawnCheck() {
+    std::uniform_real_distribution<float> dist01(0.f, 1.f);
+    const float pMera = 0.40f;
+    const float pOpe  = 0.15f;
+    int count = (int)snakes.size();
+    int rolls = std::max(1, count / 10);
+    int cap = std::max(1, count / 20);
+    for (int r = 0; r < rolls; ++r) {
+        if (dist01(rng) < pMera && typeCount[(int)Fruit::Type::Mera] < cap) spawnFruit(Fruit::Type::Mera, 4.f);
+        if (dist01(rng) < pOpe && typeCount[(int)Fruit::Type::Ope] < cap) spawnFruit(Fruit::Type::Ope, 2.f);
+    }
+    // Gomu normally respawns when eaten; top up whatever failed to place
+    for (int i = typeCount[(int)Fruit::Type::Gomu]; i < gomuTarget; ++i) spawnFruit(Fruit::Type::Gomu, 0.f);
+}
+
+void Arena::draw(sf::RenderTarget& target, int blockSize) const {
+    PROFILE_ZONE("arena draw");
+    vertices.clear();
+    const float b = (float)blockSize;
+    auto quad = [&](int x, int y, sf::Color color, float inset) { cellquad::append(vertices, x, y, b, color, inset); };
+
+    // One pass over the occupancy grid draws walls and every body
+    for (int y = 0; y < gridHeight; ++y) {
+        for (int x = 0; x < gridWidth; ++x) {
+            std::uint16_t o = occupancy[(size_t)index(x, y)];
+            if (o == WALL) quad(x, y, sf::Color(150, 150, 150), 0.f);
+            else if (o != EMPTY) quad(x, y, palette[o - 1u], 0.f);
+        }
+    }
+    for (std::uint32_t id = 0; id < snakes.size(); ++id) {
+        if (!snakes[id].alive) continue;
+        Cell h = cellAt(id, 0);
+        quad(h.x, h.y, sf::Color::White, b * 0.2f);
+    }
+    for (const Fruit& f : fruits) {
+        quad(f.x, f.y, cellquad::fruitColor(f.type), b * 0.15f);
+    }
+    for (const Portal& p : portals) quad(p.x, p.y, sf::Color(120, 60, 220), 0.f);
+    target.draw(vertices);
+}
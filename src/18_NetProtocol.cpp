@@ -0,0 +1,179 @@
+#include "NetProtocol.hpp"
+#include <algorithm>
+
+namespace net {
+
+namespace {
+
+const std::uint8_t SNAKE_ALIVE = 1;
+const std::uint8_t SNAKE_FULL = 2;
+
+bool sameFruit(const Fruit& a, const Fruit& b) {
+    return a.x == b.x && a.y == b.y && a.type == b.type;
+}
+
+bool contains(const std::vector<Fruit>& fruits, const Fruit& f) {
+    for (const Fruit& o : fruits) if (sameFruit(o, f)) return true;
+    return false;
+}
+
+bool samePortals(const std::vector<Portal>& a, const std::vector<Portal>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].x != b[i].x || a[i].y != b[i].y) return false;
+    }
+    return true;
+}
+
+}
+
+void writeDelta(ByteWriter& w, const NetWorld& base, const NetWorld& cur, std::uint32_t lastInputSeq) {
+    w.u32(cur.tick);
+    w.u32(base.tick);
+    w.u32(lastInputSeq);
+
+    w.u16((std::uint16_t)cur.snakes.size());
+    std::size_t countAt = w.size();
+    w.u16(0);
+    std::uint16_t changed = 0;
+    static const NetSnake none;
+    for (size_t id = 0; id < cur.snakes.size(); ++id) {
+        const NetSnake& c = cur.snakes[id];
+        const NetSnake& b = id < base.snakes.size() ? base.snakes[id] : none;
+        if (id < base.snakes.size() && c.epoch == b.epoch && c.moves == b.moves &&
+            c.score == b.score && c.alive == b.alive) continue;
+        changed++;
+
+        // Incremental when the body only slid forward since the baseline
+        std::uint32_t newHeads = c.moves - b.moves;
+        long dropped = (long)b.body.size() + (long)newHeads - (long)c.body.size();
+        bool incremental = c.alive && b.alive && c.epoch == b.epoch && c.moves >= b.moves &&
+                           newHeads <= c.body.size() && dropped >= 0 && dropped <= (long)b.body.size();
+
+        w.u16((std::uint16_t)id);
+        w.u8((std::uint8_t)((c.alive ? SNAKE_ALIVE : 0) | (incremental ? 0 : SNAKE_FULL)));
+        w.u16(c.score);
+        if (incremental) {
+            w.u16((std::uint16_t)newHeads);
+            w.u16((std::uint16_t)dropped);
+            for (std::uint32_t i = 0; i < newHeads; ++i) w.cell(c.body[i]);
+        } else {
+            w.u32(c.epoch);
+            w.u32(c.moves);
+            w.u16((std::uint16_t)c.body.size());
+            for (const Cell& cell : c.body) w.cell(cell);
+        }
+    }
+    w.patch16(countAt, changed);
+
+    // Fruits: removed cells, then added cells with their type
+    countAt = w.size();
+    w.u16(0);
+    std::uint16_t removed = 0;
+    for (const Fruit& f : base.fruits) {
+        if (contains(cur.fruits, f)) continue;
+        w.cell({f.x, f.y});
+        removed++;
+    }
+    w.patch16(countAt, removed);
+    countAt = w.size();
+    w.u16(0);
+    std::uint16_t added = 0;
+    for (const Fruit& f : cur.fruits) {
+        if (contains(base.fruits, f)) continue;
+        w.cell({f.x, f.y});
+        w.u8((std::uint8_t)f.type);
+        added++;
+    }
+    w.patch16(countAt, added);
+
+    if (samePortals(base.portals, cur.portals)) {
+        w.u8(0);
+    } else {
+        w.u8(1);
+        w.u8((std::uint8_t)cur.portals.size());
+        for (const Portal& p : cur.portals) w.cell({p.x, p.y});
+    }
+}
+
+bool readDeltaTicks(ByteReader& r, std::uint32_t& tick, std::uint32_t& baseTick, std::uint32_t& lastInputSeq) {
+    tick = r.u32();
+    baseTick = r.u32();
+    lastInputSeq = r.u32();
+    return r.ok();
+}
+
+bool applyDelta(ByteReader& r, const NetWorld& base, std::uint32_t tick, NetWorld& out) {
+    out.tick = tick;
+    std::uint16_t snakeCount = r.u16();
+    out.snakes.resize(snakeCount);
+    for (size_t id = 0; id < snakeCount; ++id) {
+        if (id < base.snakes.size()) out.snakes[id] = base.snakes[id];
+        else out.snakes[id] = NetSnake();
+    }
+
+    std::uint16_t changed = r.u16();
+    for (std::uint16_t n = 0; n < changed && r.ok(); ++n) {
+        std::uint16_t id = r.u16();
+        std::uint8_t flags = r.u8();
+        if (id >= snakeCount) return false;
+        NetSnake& s = out.snakes[id];
+        s.alive = (flags & SNAKE_ALIVE) != 0;
+        s.score = r.u16();
+        if (flags & SNAKE_FULL) {
+            s.epoch = r.u32();
+            s.moves = r.u32();
+            s.body.resize(r.u16());
+            for (Cell& c : s.body) c = r.cell();
+            continue;
+        }
+        if (id >= base.snakes.size()) return false;
+        std::uint16_t newHeads = r.u16();
+        std::uint16_t dropped = r.u16();
+        const std::vector<Cell>& old = base.snakes[id].body;
+        if (dropped > old.size()) return false;
+        s.moves = base.snakes[id].moves + newHeads;
+        s.body.resize(newHeads + old.size() - dropped);
+        for (std::uint16_t i = 0; i < newHeads; ++i) s.body[i] = r.cell();
+        std::copy(old.begin(), old.end() - dropped, s.body.begin() + newHeads);
+    }
+
+    out.fruits = base.fruits;
+    std::uint16_t removed = r.u16();
+    for (std::uint16_t n = 0; n < removed && r.ok(); ++n) {
+        Cell c = r.cell();
+        for (size_t i = 0; i < out.fruits.size(); ++i) {
+            if (out.fruits[i].x != c.x || out.fruits[i].y != c.y) continue;
+            out.fruits[i] = out.fruits.back();
+            out.fruits.pop_back();
+            break;
+        }
+    }
+    std::uint16_t added = r.u16();
+    for (std::uint16_t n = 0; n < added && r.ok(); ++n) {
+        Fruit f;
+        Cell c = r.cell();
+        f.x = c.x;
+        f.y = c.y;
+        f.type = (Fruit::Type)(r.u8() % 3);
+        f.spawnTime = 0.f;
+        f.duration = 0.f;
+        out.fruits.push_back(f);
+    }
+
+    if (r.u8()) {
+        out.portals.resize(r.u8());
+        for (Portal& p : out.portals) {
+            Cell c = r.cell();
+            p.x = c.x;
+            p.y = c.y;
+            p.active = true;
+            p.isExit = false;
+        }
+    } else {
+        out.portals = base.portals;
+    }
+    return r.ok();
+}
+
+}
@@ -0,0 +1,69 @@
+#include "NetServer.hpp"
+#include <iostream>
+#include <random>
+
+NetServer::NetServer(int players, int bots, unsigned short port, float tickSeconds)
+    : players(players),
+      port(port),
+      tickSeconds(tickSeconds),
+      room(0, players, bots, (unsigned)std::random_device{}(), tickSeconds,
+           [this](std::uint64_t peer, const std::vector<std::uint8_t>& packet) { send(peer, packet); }) {
+    receiveBuffer.resize(sf::UdpSocket::MaxDatagramSize);
+}
+
+bool NetServer::start() {
+    if (socket.bind(port) != sf::Socket::Done) {
+        std::cerr << "Server: cannot bind UDP port " << port << std::endl;
+        return false;
+    }
+    socket.setBlocking(false);
+    const Arena& arena = room.getArena();
+    std::cout << "Server: port " << port << ": " << players << " players, "
+              << arena.getSnakeCount() - players << " bots, board "
+              << arena.getGridWidth() << "x" << arena.getGridHeight() << std::endl;
+    return true;
+}
+
+void NetServer::run(const std::atomic<bool>& running) {
+    sf::SocketSelector selector;
+    selector.add(socket);
+    sf::Clock clock;
+    float next = tickSeconds;
+
+    while (running) {
+        float now = clock.getElapsedTime().asSeconds();
+        if (now >= next) {
+            room.tick();
+            next += tickSeconds;
+            // After a long stall skip ticks instead of running them back to back
+            now = clock.getElapsedTime().asSeconds();
+            if (now > next + tickSeconds * 5) next = now + tickSeconds;
+
+            if (statsClock.getElapsedTime().asSeconds() >= 10.f) {
+                std::uint64_t snapshots = 0, bytes = 0;
+                room.takeTraffic(snapshots, bytes);
+                if (snapshots > 0) {
+                    std::cout << "Tick " << room.getArena().getTickCount() << ": " << bytes / snapshots
+                              << " B per snapshot, best score " << room.getArena().getBestScore() << std::endl;
+                }
+                statsClock.restart();
+            }
+            continue;
+        }
+        if (selector.wait(sf::seconds(next - now))) receiveAll();
+    }
+    room.close();
+}
+
+void NetServer::receiveAll() {
+    std::size_t received = 0;
+    sf::IpAddress from;
+    unsigned short fromPort = 0;
+    while (socket.receive(receiveBuffer.data(), receiveBuffer.size(), received, from, fromPort) == sf::Socket::Done) {
+        room.receive(NetRoom::peerKey(from.toInteger(), fromPort), receiveBuffer.data(), received);
+    }
+}
+
+void NetServer::send(std::uint64_t peer, const std::vector<std::uint8_t>& packet) {
+    socket.send(packet.data(), packet.size(), sf::IpAddress(NetRoom::peerAddress(peer)), NetRoom::peerPort(peer));
+}
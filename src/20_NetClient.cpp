@@ -0,0 +1,236 @@
+#include "NetClient.hpp"
+#include "Arena.hpp"
+#include "SnakeRenderer.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+using namespace net;
+
+bool NetClient::connect(const std::string& host, unsigned short port, int room, sf::Time timeout) {
+    server = sf::IpAddress(host);
+    serverPort = port;
+    if (server == sf::IpAddress::None) {
+        std::cerr << "Client: cannot resolve " << host << std::endl;
+        return false;
+    }
+    if (socket.bind(sf::Socket::AnyPort) != sf::Socket::Done) {
+        std::cerr << "Client: cannot open a UDP socket" << std::endl;
+        return false;
+    }
+    socket.setBlocking(false);
+    receiveBuffer.resize(sf::UdpSocket::MaxDatagramSize);
+    received.assign((size_t)HISTORY, NetWorld());
+    vertices.setPrimitiveType(sf::Quads);
+
+    sf::Clock waited;
+    sf::Clock resend;
+    bool first = true;
+    while (waited.getElapsedTime() < timeout) {
+        if (first || resend.getElapsedTime() >= sf::milliseconds(250)) {
+            first = false;
+            resend.restart();
+            ByteWriter w(packet);
+            w.header(MsgType::Hello);
+            w.u16((std::uint16_t)room);
+            socket.send(packet.data(), packet.size(), server, serverPort);
+        }
+        std::size_t size = 0;
+        sf::IpAddress from;
+        unsigned short fromPort = 0;
+        if (socket.receive(receiveBuffer.data(), receiveBuffer.size(), size, from, fromPort) != sf::Socket::Done) {
+            sf::sleep(sf::milliseconds(5));
+            continue;
+        }
+        ByteReader r(receiveBuffer.data(), size);
+        MsgType type;
+        if (!r.header(type)) continue;
+        if (type == MsgType::Full) {
+            std::cerr << "Client: server is full" << std::endl;
+            return false;
+        }
+        if (type != MsgType::Welcome) continue;
+
+        playerId = r.u8();
+        gridWidth = r.u8();
+        gridHeight = r.u8();
+        r.u16(); // snake count, also carried by every snapshot
+        tickSeconds = (float)r.u16() / 1000.f;
+        walls.resize(r.u16());
+        for (Cell& c : walls) c = r.cell();
+        if (!r.ok() || gridWidth == 0 || gridHeight == 0 || tickSeconds <= 0.f) continue;
+
+        connected = true;
+        tickClock.restart();
+        std::cout << "Client: player " << playerId << " on " << gridWidth << "x" << gridHeight
+                  << ", tick " << (int)(tickSeconds * 1000.f) << " ms" << std::endl;
+        return true;
+    }
+    std::cerr << "Client: no answer from " << host << ":" << port << std::endl;
+    return false;
+}
+
+void NetClient::disconnect() {
+    if (!connected) return;
+    ByteWriter w(packet);
+    w.header(MsgType::Bye);
+    socket.send(packet.data(), packet.size(), server, serverPort);
+    connected = false;
+}
+
+void NetClient::update() {
+    if (!connected) return;
+    receiveAll();
+    if (!connected) return;
+    readDirection();
+
+    // Inputs go out at the server's tick rate, one per tick, like the server applies them
+    accum = std::min(accum + tickClock.restart().asSeconds(), tickSeconds * 5);
+    bool ticked = false;
+    while (accum >= tickSeconds) {
+        accum -= tickSeconds;
+        PendingInput p;
+        p.entry.seq = nextSeq++;
+        p.entry.dx = (std::int8_t)wantedDir.x;
+        p.entry.dy = (std::int8_t)wantedDir.y;
+        p.sentAt = clock.getElapsedTime();
+        pending.push_back(p);
+        // The server stopped answering; don't let the backlog grow forever
+        if (pending.size() > (size_t)HISTORY) pending.pop_front();
+        ticked = true;
+    }
+    if (ticked) {
+        sendInput();
+        predict();
+    }
+}
+
+void NetClient::receiveAll() {
+    std::size_t size = 0;
+    sf::IpAddress from;
+    unsigned short fromPort = 0;
+    while (socket.receive(receiveBuffer.data(), receiveBuffer.size(), size, from, fromPort) == sf::Socket::Done) {
+        if (from != server || fromPort != serverPort) continue;
+        ByteReader r(receiveBuffer.data(), size);
+        MsgType type;
+        if (!r.header(type)) continue;
+        if (type == MsgType::Snapshot) {
+            handleSnapshot(r, size);
+        } else if (type == MsgType::Bye) {
+            std::cout << "Client: server closed the game" << std::endl;
+            connected = false;
+            return;
+        }
+    }
+}
+
+void NetClient::handleSnapshot(ByteReader& r, std::size_t size) {
+    std::uint32_t tick = 0, baseTick = 0, lastInputSeq = 0;
+    if (!readDeltaTicks(r, tick, baseTick, lastInputSeq)) return;
+    // Late datagrams are useless: a newer world is already here
+    if (tick <= latestTick) return;
+    const NetWorld& stored = received[baseTick % HISTORY];
+    if (baseTick != 0 && stored.tick != baseTick) return; // baseline already overwritten
+    const NetWorld& base = baseTick == 0 ? empty : stored;
+    if (!applyDelta(r, base, tick, scratch)) return;
+
+    // Base and target never share a slot: the server only uses baselines
+    // from its own last HISTORY ticks
+    std::swap(received[tick % HISTORY], scratch);
+    latestTick = tick;
+    lastSnapshotBytes = size;
+
+    if (lastInputSeq > appliedSeq) appliedSeq = lastInputSeq;
+    while (!pending.empty() && pending.front().entry.seq <= appliedSeq) {
+        if (pending.front().entry.seq == appliedSeq) {
+            float sample = (clock.getElapsedTime() - pending.front().sentAt).asSeconds() * 1000.f;
+            rttMs = rttMs == 0.f ? sample : rttMs * 0.9f + sample * 0.1f;
+        }
+        pending.pop_front();
+    }
+    predict();
+}
+
+void NetClient::readDirection() {
+    using K = sf::Keyboard;
+    if (K::isKeyPressed(K::Up) || K::isKeyPressed(K::W)) wantedDir = {0, -1};
+    else if (K::isKeyPressed(K::Down) || K::isKeyPressed(K::S)) wantedDir = {0, 1};
+    else if (K::isKeyPressed(K::Left) || K::isKeyPressed(K::A)) wantedDir = {-1, 0};
+    else if (K::isKeyPressed(K::Right) || K::isKeyPressed(K::D)) wantedDir = {1, 0};
+}
+
+void NetClient::sendInput() {
+    // The newest few inputs every time, so a lost datagram loses nothing
+    ByteWriter w(packet);
+    w.header(MsgType::Input);
+    w.u32(latestTick);
+    size_t count = std::min(pending.size(), (size_t)MAX_INPUTS_PER_PACKET);
+    w.u8((std::uint8_t)count);
+    for (size_t i = pending.size() - count; i < pending.size(); ++i) {
+        w.u32(pending[i].entry.seq);
+        w.u8((std::uint8_t)pending[i].entry.dx);
+        w.u8((std::uint8_t)pending[i].entry.dy);
+    }
+    socket.send(packet.data(), packet.size(), server, serverPort);
+}
+
+void NetClient::predict() {
+    const NetWorld& world = latest();
+    predicted.clear();
+    if (playerId < 0 || (size_t)playerId >= world.snakes.size()) return;
+    const NetSnake& me = world.snakes[(size_t)playerId];
+    if (!me.alive || me.body.empty()) return;
+    predicted = me.body;
+
+    // Replay what the server has not applied yet with the same turning rule
+    Cell dir{0, -1};
+    if (predicted.size() >= 2) dir = {predicted[0].x - predicted[1].x, predicted[0].y - predicted[1].y};
+    for (const PendingInput& p : pending) {
+        Cell d{p.entry.dx, p.entry.dy};
+        if (std::abs(d.x) + std::abs(d.y) == 1 && !(d.x == -dir.x && d.y == -dir.y)) dir = d;
+        Cell head{predicted[0].x + dir.x, predicted[0].y + dir.y};
+        if (head.x < 0 || head.y < 0 || head.x >= gridWidth || head.y >= gridHeight) break;
+        bool onFruit = false;
+        for (const Fruit& f : world.fruits) onFruit = onFruit || (f.x == head.x && f.y == head.y);
+        predicted.insert(predicted.begin(), head);
+        if (!onFruit) predicted.pop_back();
+    }
+}
+
+int NetClient::getScore() const {
+    const NetWorld& world = latest();
+    if (playerId < 0 || (size_t)playerId >= world.snakes.size()) return 0;
+    return world.snakes[(size_t)playerId].score;
+}
+
+int NetClient::getBestScore() const {
+    int best = 0;
+    for (const NetSnake& s : latest().snakes) best = std::max(best, (int)s.score);
+    return best;
+}
+
+void NetClient::draw(sf::RenderTarget& target, int blockSize) {
+    vertices.clear();
+    const float b = (float)blockSize;
+    auto quad = [&](int x, int y, sf::Color color, float inset) { cellquad::append(vertices, x, y, b, color, inset); };
+
+    const NetWorld& world = latest();
+    for (const Cell& c : walls) quad(c.x, c.y, sf::Color(150, 150, 150), 0.f);
+    for (const Fruit& f : world.fruits) {
+        quad(f.x, f.y, cellquad::fruitColor(f.type), b * 0.15f);
+    }
+    for (const Portal& p : world.portals) quad(p.x, p.y, sf::Color(120, 60, 220), 0.f);
+    for (size_t id = 0; id < world.snakes.size(); ++id) {
+        const NetSnake& s = world.snakes[id];
+        if ((int)id == playerId || !s.alive || s.body.empty()) continue;
+        sf::Color color = Arena::snakeColor((int)id);
+        for (const Cell& c : s.body) quad(c.x, c.y, color, 0.f);
+        quad(s.body[0].x, s.body[0].y, sf::Color::White, b * 0.2f);
+    }
+    // Our snake last, so it stays visible where the prediction overlaps others
+    if (!predicted.empty()) {
+        for (const Cell& c : predicted) quad(c.x, c.y, sf::Color(60, 220, 60), 0.f);
+        quad(predicted[0].x, predicted[0].y, sf::Color::White, b * 0.2f);
+    }
+    target.draw(vertices);
+}
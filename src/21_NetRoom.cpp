@@ -0,0 +1,209 @@
+#include "NetRoom.hpp"
+#include "Log.hpp"
+#include <algorithm>
+
+using namespace net;
+
+namespace {
+
+const size_t MAX_QUEUED_INPUTS = 4; // older inputs are dropped to bound lag
+
+int boardSide(int snakeCount) {
+    return std::min(MAX_BOARD_SIDE, Arena::boardSideFor(snakeCount));
+}
+
+}
+
+NetRoom::NetRoom(int roomId, int players, int bots, unsigned seed, float tickSeconds, Send send)
+    : roomId(roomId),
+      players(players),
+      tickSeconds(tickSeconds),
+      timeoutTicks((long)(CLIENT_TIMEOUT / tickSeconds) + 1),
+      arena(boardSide(players + bots), boardSide(players + bots), std::min(players + bots, MAX_SNAKES), seed, tickSeconds),
+      send(std::move(send)),
+      clients((size_t)players),
+      history((size_t)HISTORY) {
+    arena.copyWalls(walls);
+}
+
+int NetRoom::findClient(std::uint64_t peer) const {
+    for (int slot = 0; slot < players; ++slot) {
+        const Client& c = clients[(size_t)slot];
+        if (c.connected && c.peer == peer) return slot;
+    }
+    return -1;
+}
+
+void NetRoom::receive(std::uint64_t peer, const std::uint8_t* data, std::size_t size) {
+    ByteReader r(data, size);
+    MsgType type;
+    if (!r.header(type)) return;
+    int slot = findClient(peer);
+
+    switch (type) {
+    case MsgType::Hello:
+        if (slot < 0) {
+            for (int i = 0; i < players && slot < 0; ++i) {
+                if (!clients[(size_t)i].connected) slot = i;
+            }
+            if (slot < 0) {
+                ByteWriter w(packet);
+                w.header(MsgType::Full);
+                send(peer, packet);
+                return;
+            }
+            Client& c = clients[(size_t)slot];
+            c = Client();
+            c.connected = true;
+            c.peer = peer;
+            connectedCount++;
+            arena.setControlled(slot, true);
+            LOG_INFO("Room {}: player {} joined from port {}", roomId, slot, peerPort(peer));
+        }
+        // A repeated Hello means our Welcome was lost
+        clients[(size_t)slot].lastHeardTick = arena.getTickCount();
+        sendWelcome(slot);
+        break;
+
+    case MsgType::Input: {
+        if (slot < 0) return;
+        Client& c = clients[(size_t)slot];
+        c.lastHeardTick = arena.getTickCount();
+        std::uint32_t ack = r.u32();
+        // Only move the baseline forward; datagrams may arrive out of order
+        if (ack > c.ackTick) c.ackTick = ack;
+        std::uint8_t count = r.u8();
+        for (std::uint8_t i = 0; i < count; ++i) {
+            InputEntry e;
+            e.seq = r.u32();
+            e.dx = (std::int8_t)r.u8();
+            e.dy = (std::int8_t)r.u8();
+            if (!r.ok()) break;
+            // Inputs are resent until acknowledged; keep only the new ones
+            if (e.seq <= c.lastReceivedSeq) continue;
+            c.lastReceivedSeq = e.seq;
+            c.inputs.push_back(e);
+        }
+        while (c.inputs.size() > MAX_QUEUED_INPUTS) {
+            c.lastAppliedSeq = c.inputs.front().seq;
+            c.inputs.pop_front();
+        }
+        break;
+    }
+
+    case MsgType::Bye:
+        if (slot >= 0) disconnect(slot, "left");
+        break;
+
+    default:
+        break;
+    }
+}
+
+void NetRoom::sendWelcome(int slot) {
+    ByteWriter w(packet);
+    w.header(MsgType::Welcome);
+    w.u8((std::uint8_t)slot);
+    w.u8((std::uint8_t)arena.getGridWidth());
+    w.u8((std::uint8_t)arena.getGridHeight());
+    w.u16((std::uint16_t)arena.getSnakeCount());
+    w.u16((std::uint16_t)(tickSeconds * 1000.f + 0.5f));
+    w.u16((std::uint16_t)walls.size());
+    for (const Cell& c : walls) w.cell(c);
+    // Boards within MAX_SNAKES carry far fewer walls; never send a datagram
+    // the socket would reject
+    if (packet.size() > MAX_PAYLOAD) {
+        LOG_ERROR("Room {}: welcome of {} bytes does not fit in a datagram", roomId, (int)packet.size());
+        return;
+    }
+    send(clients[(size_t)slot].peer, packet);
+}
+
+void NetRoom::disconnect(int slot, const char* reason) {
+    clients[(size_t)slot].connected = false;
+    connectedCount--;
+    // The AI takes the snake over until someone else joins
+    arena.setControlled(slot, false);
+    LOG_INFO("Room {}: player {} {}", roomId, slot, reason);
+}
+
+void NetRoom::close() {
+    ByteWriter w(packet);
+    w.header(MsgType::Bye);
+    for (int slot = 0; slot < players; ++slot) {
+        if (clients[(size_t)slot].connected) send(clients[(size_t)slot].peer, packet);
+    }
+}
+
+void NetRoom::tick() {
+    for (int slot = 0; slot < players; ++slot) {
+        Client& c = clients[(size_t)slot];
+        if (!c.connected) continue;
+        if (arena.getTickCount() - c.lastHeardTick > timeoutTicks) {
+            disconnect(slot, "timed out");
+            continue;
+        }
+        if (c.inputs.empty()) continue;
+        const InputEntry& e = c.inputs.front();
+        arena.steer(slot, e.dx, e.dy);
+        c.lastAppliedSeq = e.seq;
+        c.inputs.pop_front();
+    }
+
+    arena.tick();
+    capture(history[(size_t)(arena.getTickCount() % HISTORY)]);
+    sendSnapshots();
+}
+
+void NetRoom::capture(NetWorld& world) {
+    world.tick = (std::uint32_t)arena.getTickCount();
+    world.snakes.resize((size_t)arena.getSnakeCount());
+    for (int id = 0; id < arena.getSnakeCount(); ++id) {
+        NetSnake& s = world.snakes[(size_t)id];
+        s.epoch = arena.getEpoch(id);
+        s.moves = arena.getMoves(id);
+        s.score = (std::uint16_t)std::min(arena.getScore(id), 0xFFFF);
+        s.alive = arena.isAlive(id);
+        arena.copyBody(id, s.body);
+    }
+    world.fruits = arena.getFruits();
+    world.portals = arena.getPortals();
+}
+
+void NetRoom::sendSnapshots() {
+    const NetWorld& cur = history[(size_t)(arena.getTickCount() % HISTORY)];
+    for (int slot = 0; slot < players; ++slot) {
+        const Client& c = clients[(size_t)slot];
+        if (!c.connected) continue;
+        // Baseline: the acked world if we still have it, otherwise from scratch
+        const NetWorld& acked = history[(size_t)(c.ackTick % HISTORY)];
+        const NetWorld& base = (c.ackTick != 0 && acked.tick == c.ackTick) ? acked : empty;
+
+        ByteWriter w(packet);
+        w.header(MsgType::Snapshot);
+        writeDelta(w, base, cur, c.lastAppliedSeq);
+        // Best effort: a lost datagram is covered by the next one
+        send(c.peer, packet);
+        snapshotsSent++;
+        snapshotBytes += packet.size();
+    }
+}
+
+void NetRoom::takeTraffic(std::uint64_t& snapshots, std::uint64_t& bytes) {
+    snapshots += snapshotsSent;
+    bytes += snapshotBytes;
+    snapshotsSent = 0;
+    snapshotBytes = 0;
+}
+
+std::size_t NetRoom::getMemoryBytes() const {
+    std::size_t bytes = sizeof(NetRoom) + arena.getMemoryBytes() + walls.capacity() * sizeof(Cell) +
+                        packet.capacity() + clients.capacity() * sizeof(Client);
+    for (const Client& c : clients) bytes += c.inputs.size() * sizeof(InputEntry);
+    for (const NetWorld& w : history) {
+        bytes += sizeof(NetWorld) + w.snakes.capacity() * sizeof(NetSnake) +
+                 w.fruits.capacity() * sizeof(Fruit) + w.portals.capacity() * sizeof(Portal);
+        for (const NetSnake& s : w.snakes) bytes += s.body.capacity() * sizeof(Cell);
+    }
+    return bytes;
+}
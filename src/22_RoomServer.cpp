@@ -0,0 +1,355 @@
+#include "RoomServer.hpp"
+#include "TimerWheel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+using namespace net;
+
+namespace {
+
+using SteadyClock = std::chrono::steady_clock;
+const SteadyClock::time_point startTime = SteadyClock::now();
+
+std::uint64_t nowMs() {
+    return (std::uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(SteadyClock::now() - startTime).count();
+}
+
+float microsSince(SteadyClock::time_point from) {
+    return std::chrono::duration<float, std::micro>(SteadyClock::now() - from).count();
+}
+
+const int RECV_BATCH = 64;
+const int SOCKET_BUFFER = 4 << 20;
+
+}
+
+void RoomServer::Histogram::add(float us) {
+    int bucket = std::min(BUCKETS - 1, std::max(0, (int)(us / 10.f)));
+    counts[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+float RoomServer::Histogram::takePercentile(float p) {
+    std::uint32_t local[BUCKETS];
+    std::uint64_t total = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        local[i] = counts[i].exchange(0, std::memory_order_relaxed);
+        total += local[i];
+    }
+    if (total == 0) return 0.f;
+    std::uint64_t rank = (std::uint64_t)((double)total * p);
+    std::uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += local[i];
+        if (seen > rank) return (float)(i + 1) * 10.f; // upper edge of the bucket
+    }
+    return (float)BUCKETS * 10.f;
+}
+
+RoomServer::RoomServer(const Config& config) : config(config) {
+    this->config.rooms = std::max(1, std::min(this->config.rooms, 0xFFFF));
+    int workerCount = config.workers;
+    if (workerCount <= 0) workerCount = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+    workerCount = std::min(workerCount, this->config.rooms);
+    for (int i = 0; i < workerCount; ++i) workers.emplace_back(new Worker());
+}
+
+#ifdef __linux__
+
+RoomServer::~RoomServer() {
+    stopping = true;
+    for (auto& w : workers) {
+        {
+            std::lock_guard<std::mutex> guard(w->sleepMutex);
+        }
+        w->wake.notify_one();
+        if (w->thread.joinable()) w->thread.join();
+    }
+    if (epollFd >= 0) ::close(epollFd);
+    if (fd >= 0) ::close(fd);
+}
+
+bool RoomServer::start() {
+    fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::cerr << "RoomServer: socket failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    // Bursts of inputs from thousands of clients land between two epoll wakeups
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &SOCKET_BUFFER, sizeof(SOCKET_BUFFER));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &SOCKET_BUFFER, sizeof(SOCKET_BUFFER));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(config.port);
+    if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        std::cerr << "RoomServer: cannot bind UDP port " << config.port << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epollFd < 0 || ::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        std::cerr << "RoomServer: epoll setup failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    for (int i = 0; i < (int)workers.size(); ++i) {
+        workers[(size_t)i]->thread = std::thread([this, i] { workerLoop(i); });
+    }
+    std::cout << "RoomServer: port " << config.port << ", " << config.rooms << " rooms x ("
+              << config.players << " players + " << config.bots << " bots), "
+              << workers.size() << " workers" << std::endl;
+    return true;
+}
+
+void RoomServer::run(const std::atomic<bool>& running) {
+    epoll_event events[4];
+    while (running) {
+        // Short timeout so a cleared `running` is noticed
+        int n = ::epoll_wait(epollFd, events, 4, 100);
+        if (n > 0) receiveBatch();
+        std::uint64_t now = nowMs();
+        if (now >= nextPeerExpiry) {
+            expirePeers(now);
+            nextPeerExpiry = now + 1000;
+        }
+    }
+}
+
+void RoomServer::expirePeers(std::uint64_t now) {
+    const std::uint64_t timeoutMs = (std::uint64_t)(NetRoom::CLIENT_TIMEOUT * 2000.f);
+    for (auto it = peerRooms.begin(); it != peerRooms.end();) {
+        if (now - it->second.lastHeardMs > timeoutMs) it = peerRooms.erase(it);
+        else ++it;
+    }
+}
+
+void RoomServer::receiveBatch() {
+    static thread_local std::uint8_t buffers[RECV_BATCH][512];
+    sockaddr_in addrs[RECV_BATCH];
+    iovec iovs[RECV_BATCH];
+    mmsghdr msgs[RECV_BATCH];
+    for (;;) {
+        for (int i = 0; i < RECV_BATCH; ++i) {
+            iovs[i].iov_base = buffers[i];
+            iovs[i].iov_len = sizeof(buffers[i]);
+            std::memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int n = ::recvmmsg(fd, msgs, RECV_BATCH, MSG_DONTWAIT, nullptr);
+        if (n <= 0) break;
+        datagramsIn.fetch_add((std::uint64_t)n, std::memory_order_relaxed);
+        batchMs = nowMs();
+        for (int i = 0; i < n; ++i) {
+            std::uint64_t peer = NetRoom::peerKey(ntohl(addrs[i].sin_addr.s_addr), ntohs(addrs[i].sin_port));
+            route(peer, buffers[i], msgs[i].msg_len);
+        }
+        if (n < RECV_BATCH) break;
+    }
+
+    // One wakeup per worker and batch, and only for workers that sleep
+    for (auto& w : workers) {
+        if (!w->pending) continue;
+        w->pending = false;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (w->sleeping.load(std::memory_order_relaxed)) {
+            {
+                std::lock_guard<std::mutex> guard(w->sleepMutex);
+            }
+            w->wake.notify_one();
+        }
+    }
+}
+
+void RoomServer::route(std::uint64_t peer, const std::uint8_t* data, std::size_t size) {
+    if (size > (std::size_t)MAX_DATAGRAM) return;
+    ByteReader r(data, size);
+    MsgType type;
+    if (!r.header(type)) return;
+
+    std::uint16_t room = 0;
+    if (type == MsgType::Hello) {
+        room = r.u16();
+        if (!r.ok() || room >= config.rooms) {
+            ByteWriter w(packet);
+            w.header(MsgType::Full);
+            sendTo(peer, packet);
+            return;
+        }
+        peerRooms[peer] = PeerRoute{room, batchMs};
+    } else {
+        auto it = peerRooms.find(peer);
+        if (it == peerRooms.end()) return;
+        room = it->second.room;
+        it->second.lastHeardMs = batchMs;
+        if (type == MsgType::Bye) peerRooms.erase(it);
+    }
+
+    Worker& w = *workers[room % workers.size()];
+    Datagram d;
+    d.peer = peer;
+    d.room = room;
+    d.size = (std::uint8_t)size;
+    std::memcpy(d.data, data, size);
+    if (!w.inbox.push(d)) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    w.pending = true;
+}
+
+void RoomServer::sendTo(std::uint64_t peer, const std::vector<std::uint8_t>& out) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(NetRoom::peerAddress(peer));
+    addr.sin_port = htons(NetRoom::peerPort(peer));
+    // Best effort, as every datagram; a full send buffer drops the snapshot
+    ::sendto(fd, out.data(), out.size(), MSG_DONTWAIT, (sockaddr*)&addr, sizeof(addr));
+}
+
+#else
+
+RoomServer::~RoomServer() {}
+
+bool RoomServer::start() {
+    std::cerr << "RoomServer: the multi-room server needs Linux (epoll); use the single-room server" << std::endl;
+    return false;
+}
+
+void RoomServer::run(const std::atomic<bool>&) {}
+void RoomServer::receiveBatch() {}
+void RoomServer::route(std::uint64_t, const std::uint8_t*, std::size_t) {}
+void RoomServer::expirePeers(std::uint64_t) {}
+void RoomServer::sendTo(std::uint64_t, const std::vector<std::uint8_t>&) {}
+
+#endif
+
+void RoomServer::workerLoop(int index) {
+    Worker& w = *workers[(size_t)index];
+    const std::size_t stride = workers.size();
+    const std::uint64_t tickMs = std::max<std::uint64_t>(1, (std::uint64_t)(config.tickSeconds * 1000.f + 0.5f));
+
+    // Room r lives on worker r % stride, at local index r / stride
+    std::vector<std::unique_ptr<NetRoom>> rooms(((std::size_t)config.rooms + stride - 1 - (std::size_t)index) / stride);
+    std::vector<char> scheduled(rooms.size(), 0);
+    std::mt19937 seeds(std::random_device{}() + (unsigned)index);
+    NetRoom::Send send = [this](std::uint64_t peer, const std::vector<std::uint8_t>& out) { sendTo(peer, out); };
+    TimerWheel wheel(nowMs());
+    std::uint64_t nextMemoryScan = 0;
+
+    auto tickRoom = [&](std::uint32_t id, std::uint64_t due) {
+        std::size_t local = id / stride;
+        NetRoom& room = *rooms[local];
+        // The last player left: the room goes dormant until someone joins
+        if (room.getConnectedCount() == 0) {
+            scheduled[local] = 0;
+            w.activeRooms.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+        SteadyClock::time_point begin = SteadyClock::now();
+        w.latenessUs.add(std::max(0.f, (float)((double)std::chrono::duration_cast<std::chrono::microseconds>(
+                                                   begin - startTime).count() - (double)due * 1000.0)));
+        room.tick();
+        w.tickUs.add(microsSince(begin));
+        w.ticks.fetch_add(1, std::memory_order_relaxed);
+        std::uint64_t snapshots = 0, bytes = 0;
+        room.takeTraffic(snapshots, bytes);
+        w.snapshots.fetch_add(snapshots, std::memory_order_relaxed);
+        w.snapshotBytes.fetch_add(bytes, std::memory_order_relaxed);
+        // Next deadline from the previous one, so the rate does not drift
+        wheel.schedule(id, due + tickMs);
+    };
+
+    while (!stopping.load(std::memory_order_acquire)) {
+        Datagram d;
+        while (w.inbox.pop(d)) {
+            std::size_t local = d.room / stride;
+            if (!rooms[local]) {
+                rooms[local].reset(new NetRoom(d.room, config.players, config.bots, seeds(), config.tickSeconds, send));
+                w.createdRooms.fetch_add(1, std::memory_order_relaxed);
+            }
+            rooms[local]->receive(d.peer, d.data, d.size);
+            if (!scheduled[local] && rooms[local]->getConnectedCount() > 0) {
+                scheduled[local] = 1;
+                w.activeRooms.fetch_add(1, std::memory_order_relaxed);
+                wheel.schedule(d.room, nowMs() + tickMs);
+            }
+        }
+
+        std::uint64_t now = nowMs();
+        wheel.advance(now, tickRoom);
+
+        // Histories fill up over the first ticks, so re-measure now and then
+        if (now >= nextMemoryScan) {
+            nextMemoryScan = now + 1000;
+            std::uint64_t bytes = 0;
+            for (const auto& room : rooms) {
+                if (room) bytes += room->getMemoryBytes();
+            }
+            w.memoryBytes.store(bytes, std::memory_order_relaxed);
+        }
+
+        // Sleep until the next deadline or a datagram; the network thread
+        // only notifies when `sleeping` is set
+        std::uint64_t due = 0;
+        bool hasTimer = wheel.nextDue(due);
+        w.sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(w.sleepMutex);
+            auto ready = [&] { return !w.inbox.empty() || stopping.load(std::memory_order_acquire); };
+            if (hasTimer) {
+                w.wake.wait_until(lock, startTime + std::chrono::milliseconds(due), ready);
+            } else {
+                w.wake.wait_until(lock, SteadyClock::now() + std::chrono::milliseconds(nextMemoryScan - now), ready);
+            }
+        }
+        w.sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    for (const auto& room : rooms) {
+        if (room) room->close();
+    }
+}
+
+RoomServer::Stats RoomServer::takeStats() {
+    Stats s;
+    std::uint64_t memory = 0;
+    float tickP99 = 0.f, lateP99 = 0.f;
+    for (auto& w : workers) {
+        s.activeRooms += w->activeRooms.load(std::memory_order_relaxed);
+        s.createdRooms += w->createdRooms.load(std::memory_order_relaxed);
+        s.ticks += w->ticks.exchange(0, std::memory_order_relaxed);
+        s.snapshots += w->snapshots.exchange(0, std::memory_order_relaxed);
+        s.snapshotBytes += w->snapshotBytes.exchange(0, std::memory_order_relaxed);
+        memory += w->memoryBytes.load(std::memory_order_relaxed);
+        // Worst worker; merging histograms would hide one overloaded core
+        tickP99 = std::max(tickP99, w->tickUs.takePercentile(0.99f));
+        lateP99 = std::max(lateP99, w->latenessUs.takePercentile(0.99f));
+    }
+    s.tickP99Us = tickP99;
+    s.latenessP99Us = lateP99;
+    s.datagramsIn = datagramsIn.exchange(0, std::memory_order_relaxed);
+    s.dropped = dropped.exchange(0, std::memory_order_relaxed);
+    s.bytesPerRoom = s.createdRooms > 0 ? (std::size_t)(memory / (std::uint64_t)s.createdRooms) : 0;
+    return s;
+}
@@ -0,0 +1,202 @@
+#include "LoadGenerator.hpp"
+#include "NetProtocol.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+using namespace net;
+
+namespace {
+
+std::uint64_t nowMs() {
+    using namespace std::chrono;
+    return (std::uint64_t)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+std::uint32_t xorshift(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+const std::uint64_t HELLO_RESEND_MS = 250;
+
+}
+
+LoadGenerator::LoadGenerator(unsigned short port, int clients, int rooms, float tickSeconds)
+    : port(port), rooms(std::max(1, rooms)), tickSeconds(tickSeconds), requested(std::max(0, clients)) {}
+
+LoadGenerator::~LoadGenerator() {
+    stop();
+}
+
+#ifdef __linux__
+
+bool LoadGenerator::start() {
+    // One socket per simulated player: lift the descriptor limit as far as allowed
+    rlimit limit{};
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+        ::getrlimit(RLIMIT_NOFILE, &limit);
+    }
+    int count = requested;
+    if ((rlim_t)count + 64 > limit.rlim_cur) {
+        count = std::max(0, (int)limit.rlim_cur - 64);
+        std::cerr << "LoadGenerator: descriptor limit allows only " << count << " clients" << std::endl;
+    }
+
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) return false;
+    sockaddr_in server{};
+    server.sin_family = AF_INET;
+    server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    server.sin_port = htons(port);
+
+    const std::uint64_t tickMs = std::max<std::uint64_t>(1, (std::uint64_t)(tickSeconds * 1000.f + 0.5f));
+    const std::uint64_t now = nowMs();
+    clients.resize((std::size_t)count);
+    for (int i = 0; i < count; ++i) {
+        SimClient& c = clients[(std::size_t)i];
+        c.fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        // connect() filters out everything but the server and allows send()/recv()
+        if (c.fd < 0 || ::connect(c.fd, (sockaddr*)&server, sizeof(server)) != 0) {
+            std::cerr << "LoadGenerator: socket " << i << " failed: " << std::strerror(errno) << std::endl;
+            if (c.fd >= 0) ::close(c.fd);
+            clients.resize((std::size_t)i);
+            break;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u32 = (std::uint32_t)i;
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, c.fd, &ev);
+        c.room = (std::uint16_t)(i % rooms);
+        c.rng = 2654435761u * (std::uint32_t)(i + 1) | 1u;
+        // Spread the clients over one tick so the server sees a steady stream
+        c.nextSendMs = now + tickMs * (std::uint64_t)i / (std::uint64_t)std::max(1, count);
+    }
+
+    running = true;
+    thread = std::thread([this] { run(); });
+    return true;
+}
+
+void LoadGenerator::stop() {
+    if (running.exchange(false) && thread.joinable()) thread.join();
+    for (SimClient& c : clients) {
+        if (c.fd < 0) continue;
+        if (c.joined) {
+            ByteWriter w(packet);
+            w.header(MsgType::Bye);
+            ::send(c.fd, packet.data(), packet.size(), MSG_DONTWAIT);
+        }
+        ::close(c.fd);
+        c.fd = -1;
+    }
+    if (epollFd >= 0) ::close(epollFd);
+    epollFd = -1;
+}
+
+void LoadGenerator::run() {
+    epoll_event events[256];
+    while (running.load(std::memory_order_relaxed)) {
+        int n = ::epoll_wait(epollFd, events, 256, 1);
+        for (int i = 0; i < n; ++i) receive(clients[events[i].data.u32]);
+        std::uint64_t now = nowMs();
+        for (SimClient& c : clients) {
+            if (c.fd >= 0 && !c.refused && now >= c.nextSendMs) sendNext(c, now);
+        }
+    }
+}
+
+void LoadGenerator::receive(SimClient& c) {
+    std::uint8_t buffer[2048];
+    for (;;) {
+        ssize_t size = ::recv(c.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (size <= 0) return;
+        ByteReader r(buffer, (std::size_t)size);
+        MsgType type;
+        if (!r.header(type)) continue;
+        if (type == MsgType::Welcome && !c.joined) {
+            c.joined = true;
+            joined.fetch_add(1, std::memory_order_relaxed);
+        } else if (type == MsgType::Full && !c.refused) {
+            c.refused = true;
+            refused.fetch_add(1, std::memory_order_relaxed);
+        } else if (type == MsgType::Snapshot) {
+            std::uint32_t tick = 0, baseTick = 0, lastInputSeq = 0;
+            if (!readDeltaTicks(r, tick, baseTick, lastInputSeq)) continue;
+            c.latestTick = std::max(c.latestTick, tick);
+            snapshots.fetch_add(1, std::memory_order_relaxed);
+            bytes.fetch_add((std::uint64_t)size, std::memory_order_relaxed);
+        } else if (type == MsgType::Bye && c.joined) {
+            c.joined = false;
+            joined.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void LoadGenerator::sendNext(SimClient& c, std::uint64_t now) {
+    ByteWriter w(packet);
+    if (!c.joined) {
+        w.header(MsgType::Hello);
+        w.u16(c.room);
+        c.nextSendMs = now + HELLO_RESEND_MS;
+    } else {
+        // Mostly straight on, sometimes a turn to either side
+        std::uint32_t roll = xorshift(c.rng) % 8;
+        if (roll == 0) {
+            std::int8_t dx = c.dx;
+            c.dx = (std::int8_t)-c.dy;
+            c.dy = dx;
+        } else if (roll == 1) {
+            std::int8_t dx = c.dx;
+            c.dx = c.dy;
+            c.dy = (std::int8_t)-dx;
+        }
+        w.header(MsgType::Input);
+        w.u32(c.latestTick);
+        w.u8(1);
+        w.u32(++c.seq);
+        w.u8((std::uint8_t)c.dx);
+        w.u8((std::uint8_t)c.dy);
+        c.nextSendMs += std::max<std::uint64_t>(1, (std::uint64_t)(tickSeconds * 1000.f + 0.5f));
+        if (c.nextSendMs < now) c.nextSendMs = now; // fell behind, don't burst
+    }
+    ::send(c.fd, packet.data(), packet.size(), MSG_DONTWAIT);
+}
+
+#else
+
+bool LoadGenerator::start() {
+    std::cerr << "LoadGenerator: needs Linux (epoll)" << std::endl;
+    return false;
+}
+
+void LoadGenerator::stop() {}
+void LoadGenerator::run() {}
+void LoadGenerator::receive(SimClient&) {}
+void LoadGenerator::sendNext(SimClient&, std::uint64_t) {}
+
+#endif
+
+LoadGenerator::Stats LoadGenerator::takeStats() {
+    Stats s;
+    s.joined = joined.load(std::memory_order_relaxed);
+    s.refused = refused.load(std::memory_order_relaxed);
+    s.snapshots = snapshots.exchange(0, std::memory_order_relaxed);
+    s.bytes = bytes.exchange(0, std::memory_order_relaxed);
+    return s;
+}
@@ -0,0 +1,412 @@
+#include "Broadcast.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+using namespace net;
+
+namespace cast {
+
+namespace {
+
+// up, down, left, right
+std::uint8_t directionCode(const Cell& d) {
+    if (d.y < 0) return 0;
+    if (d.y > 0) return 1;
+    return d.x < 0 ? 2 : 3;
+}
+
+Cell directionOf(std::uint8_t code) {
+    static const Cell DIRS[4] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+    return DIRS[code & 3];
+}
+
+std::uint16_t deciseconds(float seconds) {
+    return (std::uint16_t)std::min(65535.f, std::max(0.f, seconds * 10.f + 0.5f));
+}
+
+std::uint16_t clamp16(int v) {
+    return (std::uint16_t)std::min(65535, std::max(0, v));
+}
+
+bool sameFruit(const Fruit& a, const Fruit& b) {
+    return a.x == b.x && a.y == b.y && a.type == b.type;
+}
+
+bool contains(const std::vector<Fruit>& fruits, const Fruit& f) {
+    for (const Fruit& o : fruits) if (sameFruit(o, f)) return true;
+    return false;
+}
+
+bool samePortal(const Portal& a, const Portal& b) {
+    return a.active == b.active && a.isExit == b.isExit && a.x == b.x && a.y == b.y;
+}
+
+void writeStatus(ByteWriter& w, const Replica& r) {
+    w.u8((std::uint8_t)r.state);
+    w.u8((std::uint8_t)((r.showCountdown ? 1 : 0) | (r.portalShowCountdown ? 2 : 0)));
+    w.u8((std::uint8_t)r.countdownNumber);
+}
+
+void readStatus(ByteReader& r, Replica& out) {
+    out.state = (GameState)std::min<int>(r.u8(), (int)GameState::GameOver);
+    std::uint8_t bits = r.u8();
+    out.showCountdown = (bits & 1) != 0;
+    out.portalShowCountdown = (bits & 2) != 0;
+    out.countdownNumber = r.u8();
+}
+
+void writePortal(ByteWriter& w, const Portal& p) {
+    w.u8((std::uint8_t)((p.active ? 1 : 0) | (p.isExit ? 2 : 0)));
+    w.cell({p.x, p.y});
+}
+
+void readPortal(ByteReader& r, Portal& p) {
+    std::uint8_t bits = r.u8();
+    p.active = (bits & 1) != 0;
+    p.isExit = (bits & 2) != 0;
+    Cell c = r.cell();
+    p.x = c.x;
+    p.y = c.y;
+}
+
+void writeFruit(ByteWriter& w, const Fruit& f) {
+    w.cell({f.x, f.y});
+    w.u8((std::uint8_t)f.type);
+}
+
+Fruit readFruit(ByteReader& r) {
+    Fruit f{};
+    Cell c = r.cell();
+    f.x = c.x;
+    f.y = c.y;
+    f.type = (Fruit::Type)std::min<int>(r.u8(), (int)Fruit::Type::Ope);
+    return f;
+}
+
+}
+
+void writeKeyframe(ByteWriter& w, const Replica& r) {
+    w.u32(r.tick);
+    w.u8((std::uint8_t)r.gridWidth);
+    w.u8((std::uint8_t)r.gridHeight);
+    w.cell({r.walls.getMinX(), r.walls.getMinY()});
+    w.cell({r.walls.getMaxX(), r.walls.getMaxY()});
+    writeStatus(w, r);
+    w.u16(clamp16(r.score));
+    w.u16(deciseconds(r.elapsed));
+    w.u16(deciseconds(r.fruitCountdown));
+    w.body(r.body);
+    w.u8((std::uint8_t)std::min<std::size_t>(r.fruits.size(), 255));
+    for (std::size_t i = 0; i < r.fruits.size() && i < 255; ++i) writeFruit(w, r.fruits[i]);
+    writePortal(w, r.portalEntrance);
+    writePortal(w, r.portalExit);
+    const std::vector<Cell>& walls = r.walls.getWalls();
+    w.u16((std::uint16_t)walls.size());
+    for (const Cell& c : walls) w.cell(c);
+}
+
+bool readKeyframe(ByteReader& r, Replica& out) {
+    out.synced = false;
+    out.tick = r.u32();
+    out.gridWidth = r.u8();
+    out.gridHeight = r.u8();
+    Cell lo = r.cell();
+    Cell hi = r.cell();
+    readStatus(r, out);
+    out.score = r.u16();
+    out.elapsed = (float)r.u16() / 10.f;
+    out.fruitCountdown = (float)r.u16() / 10.f;
+    r.body(out.body, (std::size_t)(out.gridWidth * out.gridHeight));
+    out.fruits.resize(r.u8());
+    for (Fruit& f : out.fruits) f = readFruit(r);
+    readPortal(r, out.portalEntrance);
+    readPortal(r, out.portalExit);
+    std::vector<Cell> walls(r.u16());
+    for (Cell& c : walls) c = r.cell();
+    if (!r.ok()) return false;
+    out.walls = Barrier(lo.x, lo.y, hi.x, hi.y);
+    out.walls.setWalls(walls);
+    out.synced = true;
+    return true;
+}
+
+void writeChange(ByteWriter& w, std::uint32_t tick, const TickMotion& motion, const Replica& before, const Replica& now) {
+    bool fruitsChanged = before.fruits.size() != now.fruits.size();
+    for (std::size_t i = 0; !fruitsChanged && i < now.fruits.size(); ++i) {
+        fruitsChanged = !contains(before.fruits, now.fruits[i]);
+    }
+    std::uint8_t flags = 0;
+    if (motion.moved) flags |= MOVED;
+    if (motion.regrow) flags |= REGROW;
+    if (motion.teleport) flags |= TELEPORT;
+    if (now.state != before.state || now.showCountdown != before.showCountdown ||
+        now.portalShowCountdown != before.portalShowCountdown || now.countdownNumber != before.countdownNumber) {
+        flags |= STATE;
+    }
+    if (now.score != before.score) flags |= SCORE;
+    if (fruitsChanged) flags |= FRUITS;
+    if (!samePortal(now.portalEntrance, before.portalEntrance) || !samePortal(now.portalExit, before.portalExit)) {
+        flags |= PORTALS;
+    }
+
+    w.u32(tick);
+    w.u8(flags);
+    w.u16(deciseconds(now.elapsed));
+    w.u16(deciseconds(now.fruitCountdown));
+    // Direction in the low bits, tail cells grown from a fruit above
+    if (motion.moved) w.u8((std::uint8_t)(directionCode(motion.direction) | (std::min(motion.grown, 63) << 2)));
+    if (flags & TELEPORT) {
+        w.u32(motion.mapSeed);
+        w.cell(motion.exit);
+        w.u16((std::uint16_t)motion.exitLength);
+        w.u8(motion.exitColumn ? 1 : 0);
+    }
+    if (flags & STATE) writeStatus(w, now);
+    if (flags & SCORE) w.u16(clamp16(now.score));
+    if (flags & FRUITS) {
+        std::size_t at = w.size();
+        w.u8(0);
+        int removed = 0;
+        for (const Fruit& f : before.fruits) {
+            if (contains(now.fruits, f) || removed == 255) continue;
+            w.cell({f.x, f.y});
+            removed++;
+        }
+        w.patch8(at, (std::uint8_t)removed);
+        at = w.size();
+        w.u8(0);
+        int added = 0;
+        for (const Fruit& f : now.fruits) {
+            if (contains(before.fruits, f) || added == 255) continue;
+            writeFruit(w, f);
+            added++;
+        }
+        w.patch8(at, (std::uint8_t)added);
+    }
+    if (flags & PORTALS) {
+        writePortal(w, now.portalEntrance);
+        writePortal(w, now.portalExit);
+    }
+}
+
+bool applyChange(ByteReader& r, Replica& replica) {
+    std::uint32_t tick = r.u32();
+    if (!replica.synced) return false;
+    if (tick <= replica.tick) return true; // duplicate of something the keyframe had
+    if (tick != replica.tick + 1) {
+        replica.synced = false;
+        return false;
+    }
+    std::uint8_t flags = r.u8();
+    replica.elapsed = (float)r.u16() / 10.f;
+    replica.fruitCountdown = (float)r.u16() / 10.f;
+
+    // Same order as GameLogic::update: regrow, step, portal jump, fruit growth
+    int grown = 0;
+    std::vector<Cell>& body = replica.body;
+    if ((flags & MOVED) && !body.empty()) {
+        std::uint8_t move = r.u8();
+        Cell d = directionOf(move);
+        grown = move >> 2;
+        Cell head{body.front().x + d.x, body.front().y + d.y};
+        body.insert(body.begin(), head);
+        if (!(flags & REGROW)) body.pop_back();
+    }
+    if (flags & TELEPORT) {
+        std::uint32_t seed = r.u32();
+        Cell exit = r.cell();
+        int length = r.u16();
+        bool column = r.u8() != 0;
+        if (!r.ok()) {
+            replica.synced = false;
+            return false;
+        }
+        std::vector<Cell> safeArea;
+        Barrier::portalSafeArea(exit.x, exit.y, length, column, replica.gridWidth, replica.gridHeight, safeArea);
+        std::mt19937 mapRng(seed);
+        replica.walls.generateRandom(mapRng, replica.gridWidth, replica.gridHeight, safeArea);
+        body.resize((std::size_t)length);
+        for (int i = 0; i < length; ++i) body[(std::size_t)i] = {exit.x, exit.y - 1 + i};
+    }
+    for (int i = 0; i < grown && !body.empty(); ++i) body.push_back(body.back());
+
+    if (flags & STATE) readStatus(r, replica);
+    if (flags & SCORE) replica.score = r.u16();
+    if (flags & FRUITS) {
+        int removed = r.u8();
+        for (int i = 0; i < removed; ++i) {
+            Cell c = r.cell();
+            auto it = std::find_if(replica.fruits.begin(), replica.fruits.end(),
+                                   [&](const Fruit& f) { return f.x == c.x && f.y == c.y; });
+            if (it != replica.fruits.end()) replica.fruits.erase(it);
+        }
+        int added = r.u8();
+        for (int i = 0; i < added; ++i) replica.fruits.push_back(readFruit(r));
+    }
+    if (flags & PORTALS) {
+        readPortal(r, replica.portalEntrance);
+        readPortal(r, replica.portalExit);
+    }
+    if (!r.ok()) {
+        replica.synced = false;
+        return false;
+    }
+    replica.tick = tick;
+    return true;
+}
+
+std::uint32_t tickOf(const std::uint8_t* data, std::size_t size) {
+    ByteReader r(data, size);
+    return r.u32();
+}
+
+}
+
+namespace {
+
+const float VIEWER_TIMEOUT = 10.f; // viewers repeat Watch every few seconds
+const std::size_t MAX_RECENT = (std::size_t)cast::KEYFRAME_TICKS * 4;
+
+}
+
+Broadcaster::Broadcaster(unsigned short port) : port(port) {}
+
+Broadcaster::~Broadcaster() {
+    stop();
+}
+
+bool Broadcaster::start() {
+    if (socket.bind(port) != sf::Socket::Done) {
+        std::cerr << "Broadcast: cannot bind UDP port " << port << std::endl;
+        return false;
+    }
+    socket.setBlocking(false);
+    receiveBuffer.resize(sf::UdpSocket::MaxDatagramSize);
+    running = true;
+    thread = std::thread([this] { run(); });
+    std::cout << "Broadcast: spectators can watch with SNAKE_WATCH=<this host>:" << port << std::endl;
+    return true;
+}
+
+void Broadcaster::stop() {
+    if (!running.exchange(false)) return;
+    if (thread.joinable()) thread.join();
+    for (const Viewer& v : viewers) send(v, MsgType::Bye, nullptr, 0);
+    viewers.clear();
+    viewerCount = 0;
+    socket.unbind();
+}
+
+bool Broadcaster::pushChange(const std::vector<std::uint8_t>& change) {
+    if (change.size() > sizeof(Record::data)) return false;
+    Record record;
+    record.size = (std::uint16_t)change.size();
+    std::memcpy(record.data, change.data(), change.size());
+    return ring.push(record);
+}
+
+bool Broadcaster::offerKeyframe(std::vector<std::uint8_t>& bytes) {
+    std::unique_lock<std::mutex> lock(offerMutex, std::try_to_lock);
+    if (!lock.owns_lock()) return false;
+    // An offer the broadcaster has not taken yet is simply replaced
+    offered.swap(bytes);
+    hasOffer = true;
+    return true;
+}
+
+void Broadcaster::run() {
+    sf::SocketSelector selector;
+    selector.add(socket);
+    while (running.load(std::memory_order_relaxed)) {
+        // A tick is 80 ms; 5 ms of extra latency is invisible to a viewer
+        if (selector.wait(sf::milliseconds(5))) receiveAll(clock.getElapsedTime().asSeconds());
+
+        float now = clock.getElapsedTime().asSeconds();
+        std::size_t before = viewers.size();
+        viewers.erase(std::remove_if(viewers.begin(), viewers.end(),
+                                     [&](const Viewer& v) { return now - v.lastHeard > VIEWER_TIMEOUT; }),
+                      viewers.end());
+        if (viewers.size() != before) {
+            viewerCount = (int)viewers.size();
+            LOG_INFO("Broadcast: spectator timed out, {} watching", (int)viewers.size());
+        }
+
+        // Keyframe first: a forced one (new game) must reach viewers before
+        // the records that follow it
+        takeKeyframe();
+        Record record;
+        while (ring.pop(record)) sendRecord(record);
+    }
+}
+
+void Broadcaster::receiveAll(float now) {
+    std::size_t size = 0;
+    sf::IpAddress from;
+    unsigned short fromPort = 0;
+    while (socket.receive(receiveBuffer.data(), receiveBuffer.size(), size, from, fromPort) == sf::Socket::Done) {
+        ByteReader r(receiveBuffer.data(), size);
+        MsgType type;
+        if (!r.header(type)) continue;
+        auto it = std::find_if(viewers.begin(), viewers.end(),
+                               [&](const Viewer& v) { return v.address == from && v.port == fromPort; });
+        if (type == MsgType::Watch) {
+            bool needKeyframe = r.u8() != 0;
+            if (it == viewers.end()) {
+                viewers.push_back({from, fromPort, now});
+                viewerCount = (int)viewers.size();
+                LOG_INFO("Broadcast: spectator joined from port {}, {} watching", (int)fromPort, (int)viewers.size());
+                sendCatchUp(viewers.back());
+            } else {
+                it->lastHeard = now;
+                if (needKeyframe) sendCatchUp(*it);
+            }
+        } else if (type == MsgType::Bye && it != viewers.end()) {
+            viewers.erase(it);
+            viewerCount = (int)viewers.size();
+            LOG_INFO("Broadcast: spectator left, {} watching", (int)viewers.size());
+        }
+    }
+}
+
+void Broadcaster::takeKeyframe() {
+    {
+        std::lock_guard<std::mutex> lock(offerMutex);
+        if (!hasOffer) return;
+        keyframe.swap(offered);
+        hasOffer = false;
+    }
+    std::uint32_t tick = cast::tickOf(keyframe.data(), keyframe.size());
+    while (!recent.empty() && cast::tickOf(recent.front().data, recent.front().size) <= tick) recent.pop_front();
+    // Everyone gets it: viewers in sync skip it, the others recover from it
+    for (const Viewer& v : viewers) sendCatchUp(v);
+}
+
+void Broadcaster::sendCatchUp(const Viewer& v) {
+    if (keyframe.empty()) return; // the first one is at most KEYFRAME_TICKS away
+    send(v, MsgType::Keyframe, keyframe.data(), keyframe.size());
+    // Then the records after it, up to the first hole (the viewer re-asks there)
+    std::uint32_t next = cast::tickOf(keyframe.data(), keyframe.size()) + 1;
+    for (const Record& r : recent) {
+        std::uint32_t tick = cast::tickOf(r.data, r.size);
+        if (tick < next) continue;
+        if (tick != next) break;
+        send(v, MsgType::Change, r.data, r.size);
+        next++;
+    }
+}
+
+void Broadcaster::sendRecord(const Record& record) {
+    recent.push_back(record);
+    if (recent.size() > MAX_RECENT) recent.pop_front();
+    for (const Viewer& v : viewers) send(v, MsgType::Change, record.data, record.size);
+}
+
+void Broadcaster::send(const Viewer& v, MsgType type, const std::uint8_t* data, std::size_t size) {
+    ByteWriter w(packet);
+    w.header(type);
+    packet.insert(packet.end(), data, data + size);
+    socket.send(packet.data(), packet.size(), v.address, v.port);
+}
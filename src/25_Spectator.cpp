@@ -0,0 +1,122 @@
+#include "Spectator.hpp"
+#include "SnakeRenderer.hpp"
+#include <iostream>
+
+using namespace net;
+
+namespace {
+
+const float WATCH_SECONDS = 2.f;      // keep-alive, well inside the broadcaster's timeout
+const float RESYNC_SECONDS = 0.25f;   // keyframe requests while out of sync
+const std::size_t HEADER_BYTES = 4;   // MAGIC, VERSION, type
+
+}
+
+bool Spectator::connect(const std::string& hostName, unsigned short port, sf::Time timeout) {
+    host = sf::IpAddress(hostName);
+    hostPort = port;
+    if (host == sf::IpAddress::None) {
+        std::cerr << "Spectator: cannot resolve " << hostName << std::endl;
+        return false;
+    }
+    if (socket.bind(sf::Socket::AnyPort) != sf::Socket::Done) {
+        std::cerr << "Spectator: cannot open a UDP socket" << std::endl;
+        return false;
+    }
+    socket.setBlocking(false);
+    receiveBuffer.resize(sf::UdpSocket::MaxDatagramSize);
+    vertices.setPrimitiveType(sf::Quads);
+    connected = true;
+
+    sf::Clock waited;
+    sendWatch(true);
+    while (waited.getElapsedTime() < timeout && connected) {
+        update();
+        if (replica.synced) {
+            std::cout << "Spectator: watching " << hostName << ":" << port << ", board "
+                      << replica.gridWidth << "x" << replica.gridHeight << std::endl;
+            return true;
+        }
+        sf::sleep(sf::milliseconds(5));
+    }
+    std::cerr << "Spectator: no broadcast at " << hostName << ":" << port << std::endl;
+    connected = false;
+    return false;
+}
+
+void Spectator::disconnect() {
+    if (!connected) return;
+    ByteWriter w(packet);
+    w.header(MsgType::Bye);
+    socket.send(packet.data(), packet.size(), host, hostPort);
+    connected = false;
+}
+
+void Spectator::update() {
+    receiveAll();
+    float sinceWatch = watchClock.getElapsedTime().asSeconds();
+    if (!replica.synced && sinceWatch >= RESYNC_SECONDS) sendWatch(true);
+    else if (sinceWatch >= WATCH_SECONDS) sendWatch(false);
+
+    if (rateClock.getElapsedTime().asSeconds() >= 1.f) {
+        bytesPerSecond = (float)bytesThisSecond / rateClock.restart().asSeconds();
+        bytesThisSecond = 0;
+    }
+}
+
+void Spectator::receiveAll() {
+    std::size_t size = 0;
+    sf::IpAddress from;
+    unsigned short fromPort = 0;
+    while (socket.receive(receiveBuffer.data(), receiveBuffer.size(), size, from, fromPort) == sf::Socket::Done) {
+        if (from != host || fromPort != hostPort) continue;
+        ByteReader r(receiveBuffer.data(), size);
+        MsgType type;
+        if (!r.header(type)) continue;
+        bytesThisSecond += size;
+        if (type == MsgType::Keyframe) {
+            // Everyone gets every keyframe; in sync, only newer ones matter
+            std::uint32_t tick = cast::tickOf(receiveBuffer.data() + HEADER_BYTES, size - HEADER_BYTES);
+            if (replica.synced && tick <= replica.tick) continue;
+            cast::readKeyframe(r, replica);
+        } else if (type == MsgType::Change) {
+            bool wasSynced = replica.synced;
+            if (!cast::applyChange(r, replica) && wasSynced) {
+                resyncs++;
+                sendWatch(true);
+            }
+        } else if (type == MsgType::Bye) {
+            std::cout << "Spectator: the game stopped broadcasting" << std::endl;
+            connected = false;
+            return;
+        }
+    }
+}
+
+void Spectator::sendWatch(bool needKeyframe) {
+    watchClock.restart();
+    ByteWriter w(packet);
+    w.header(MsgType::Watch);
+    w.u8(needKeyframe ? 1 : 0);
+    socket.send(packet.data(), packet.size(), host, hostPort);
+}
+
+void Spectator::draw(sf::RenderTarget& target, int blockSize) {
+    vertices.clear();
+    const float b = (float)blockSize;
+    auto quad = [&](int x, int y, sf::Color color, float inset) { cellquad::append(vertices, x, y, b, color, inset); };
+
+    for (const Cell& c : replica.walls.getWalls()) quad(c.x, c.y, sf::Color(150, 150, 150), 0.f);
+    for (const Fruit& f : replica.fruits) {
+        quad(f.x, f.y, cellquad::fruitColor(f.type), b * 0.15f);
+    }
+    if (replica.portalEntrance.active) quad(replica.portalEntrance.x, replica.portalEntrance.y, sf::Color(120, 60, 220), 0.f);
+    if (replica.portalExit.active) quad(replica.portalExit.x, replica.portalExit.y, sf::Color(60, 160, 220), 0.f);
+    // Segments still inside the exit portal stay hidden, as in the game
+    for (const Cell& c : replica.body) {
+        if (replica.portalExit.active && c.y >= replica.portalExit.y) continue;
+        quad(c.x, c.y, sf::Color(60, 220, 60), 0.f);
+    }
+    if (!replica.body.empty()) quad(replica.body[0].x, replica.body[0].y, sf::Color::White, b * 0.2f);
+    target.draw(vertices);
+}
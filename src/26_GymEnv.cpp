@@ -0,0 +1,413 @@
+#include "GymEnv.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const Cell DIRS[4] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+const float SPAWN_CHECK_SECONDS = 0.5f;
+const int PORTAL_EVERY = 30;
+
+}
+
+GymEnv::GymEnv(int gridWidth, int gridHeight, float tickSeconds)
+    : gridWidth(gridWidth),
+      gridHeight(gridHeight),
+      area(gridWidth * gridHeight),
+      tickSeconds(tickSeconds),
+      barrier(2, 2, gridWidth - 3, gridHeight - 3),
+      board(gridWidth, gridHeight),
+      traps(gridWidth, gridHeight),
+      wallBits((std::size_t)Bitboard::wordsFor(area), 0),
+      bodyBits((std::size_t)Bitboard::wordsFor(area), 0),
+      fruitAt((std::size_t)area, 0),
+      ring((std::size_t)area, 0) {
+    fruits.reserve(8);
+}
+
+void GymEnv::reset(std::uint32_t seed) {
+    rng.seed(seed);
+    trapsLive = false;
+    if (obs) std::memset(obs, 0, observationSize());
+    clearBody();
+    for (std::size_t i = fruits.size(); i-- > 0;) removeFruit(i);
+    if (entrance.active) mark(PLANE_PORTAL, index(entrance.x, entrance.y), 0);
+    entrance = Portal();
+    exit = Portal();
+
+    // Same start as GameLogic::startGame: three cells heading up from the centre
+    int x = gridWidth / 2, y = gridHeight / 2;
+    scratch.assign({{x, y}, {x, y + 1}, {x, y + 2}});
+    std::mt19937 mapRng((std::uint32_t)rng());
+    barrier.generateRandom(mapRng, gridWidth, gridHeight, scratch);
+    loadWalls();
+    for (int i = 2; i >= 0; --i) pushHead(board, index(x, y + i));
+    dir = {0, -1};
+    growPending = 0;
+    emerging = 0;
+
+    time = 0.f;
+    fruitCountdown = 20.f;
+    lastSpawnCheck = 0.f;
+    score = 0;
+    nextPortalScore = PORTAL_EVERY;
+    steps = 0;
+    done = false;
+    end = End::None;
+    spawnGomu();
+}
+
+GymEnv::Step GymEnv::step(int action) {
+    if (genericBoard) return stepOn(board, action);
+    return withBoard(gridWidth, gridHeight, [&](const auto& b) { return stepOn(b, action); });
+}
+
+template <class B>
+GymEnv::Step GymEnv::stepOn(const B& b, int action) {
+    Step result;
+    if (done) {
+        result.done = true;
+        result.end = end;
+        return result;
+    }
+    steps++;
+    time += tickSeconds;
+    fruitCountdown -= tickSeconds;
+
+    Cell want = DIRS[action & 3];
+    if (want.x != -dir.x || want.y != -dir.y) dir = want;
+    int heading = dir.y < 0 ? ACTION_UP : dir.y > 0 ? ACTION_DOWN : dir.x < 0 ? ACTION_LEFT : ACTION_RIGHT;
+    int cell = b.neighbour(ring[(std::size_t)headSlot], heading);
+    if (cell < 0) {
+        finish(End::Wall, result);
+        return result;
+    }
+    // The tail moves first, so following it into its old cell is fine
+    bool growing = growPending > 0;
+    int tail = ring[(std::size_t)b.wrap(headSlot + length - 1)];
+    bool portal = entrance.active && cell == b.index(entrance.x, entrance.y);
+    if (!portal && Bitboard::test(wallBits, cell)) {
+        finish(End::Wall, result);
+        return result;
+    }
+    if (!portal && Bitboard::test(bodyBits, cell) && (growing || cell != tail)) {
+        finish(End::Self, result);
+        return result;
+    }
+    if (growing) growPending--;
+    else popTail(b);
+    if (emerging > 0) emerging--;
+    if (portal) {
+        teleport();
+        cell = ring[(std::size_t)headSlot];
+    } else {
+        pushHead(b, cell);
+    }
+
+    if (std::uint8_t f = fruitAt[(std::size_t)cell]) {
+        Fruit::Type type = (Fruit::Type)(f - 1);
+        static const int POINTS[3] = {1, 5, 10};
+        static const float SECONDS[3] = {5.f, 10.f, 15.f};
+        score += POINTS[(int)type];
+        result.reward += (float)POINTS[(int)type];
+        growPending += (int)type + 1;
+        fruitCountdown += SECONDS[(int)type];
+        for (std::size_t i = 0; i < fruits.size(); ++i) {
+            if (b.index(fruits[i].x, fruits[i].y) == cell) { removeFruit(i); break; }
+        }
+        if (type == Fruit::Type::Gomu) spawnGomu();
+    }
+
+    if (time - lastSpawnCheck >= SPAWN_CHECK_SECONDS) {
+        spawnCheck();
+        lastSpawnCheck = time;
+    }
+    for (std::size_t i = fruits.size(); i-- > 0;) {
+        const Fruit& f = fruits[i];
+        if (f.duration > 0.f && time - f.spawnTime >= f.duration) removeFruit(i);
+    }
+
+    // A portal every PORTAL_EVERY points; the board is cleared of fruit
+    if (score >= nextPortalScore && !entrance.active && !exit.active) {
+        for (std::size_t i = fruits.size(); i-- > 0;) removeFruit(i);
+        int portal;
+        if (randomFreeCell(portal)) {
+            Cell c = cellOf(portal);
+            entrance.x = c.x;
+            entrance.y = c.y;
+            entrance.active = true;
+            mark(PLANE_PORTAL, portal, 1);
+        }
+    }
+    if (exit.active && emerging == 0) {
+        exit.active = false;
+        nextPortalScore += PORTAL_EVERY;
+    }
+
+    if (fruitCountdown <= 0.f) finish(End::FruitTimer, result);
+    return result;
+}
+
+void GymEnv::finish(End why, Step& result) {
+    done = true;
+    end = why;
+    result.done = true;
+    result.end = why;
+    // The game over screen adds one point per second played
+    result.reward += (float)(int)time;
+}
+
+// Same search as GameLogic::findPortalExit, then the map from its own seed
+void GymEnv::teleport() {
+    int target = length + growPending + 1;
+    mark(PLANE_PORTAL, index(entrance.x, entrance.y), 0);
+    entrance.active = false;
+
+    std::uniform_int_distribution<int> distX(barrier.getMinX() + 3, barrier.getMaxX() - 3);
+    std::uniform_int_distribution<int> distY(barrier.getMinY() + 3, barrier.getMaxY() - 3);
+    int ex = gridWidth / 2, ey = gridHeight / 2;
+    bool found = false;
+    for (int tries = 0; tries < 500 && !found; ++tries) {
+        ex = distX(rng);
+        ey = distY(rng);
+        Barrier::portalSafeArea(ex, ey, target, true, gridWidth, gridHeight, scratch);
+        found = true;
+        for (const Cell& c : scratch) {
+            if (Bitboard::test(wallBits, index(c.x, c.y))) { found = false; break; }
+        }
+    }
+    if (!found) {
+        ex = gridWidth / 2;
+        ey = gridHeight / 2;
+        Barrier::portalSafeArea(ex, ey, target, false, gridWidth, gridHeight, scratch);
+    }
+    std::mt19937 mapRng((std::uint32_t)rng());
+    barrier.generateRandom(mapRng, gridWidth, gridHeight, scratch);
+    loadWalls();
+
+    // The head comes out just above the exit; the rest follows step by step
+    clearBody();
+    for (std::size_t i = fruits.size(); i-- > 0;) removeFruit(i);
+    pushHead(board, index(ex, ey - 1));
+    dir = {0, -1};
+    growPending = target - 1;
+    emerging = target - 1;
+    exit.x = ex;
+    exit.y = ey;
+    exit.active = true;
+    exit.isExit = true;
+    spawnGomu();
+}
+
+template <class B>
+void GymEnv::pushHead(const B& b, int cell) {
+    if (length > 0) mark(PLANE_HEAD, ring[(std::size_t)headSlot], 0);
+    headSlot = b.wrap(headSlot + b.area() - 1);
+    ring[(std::size_t)headSlot] = cell;
+    length++;
+    Bitboard::set(bodyBits, cell);
+    if (trapsLive) traps.occupy(b.cellOf(cell));
+    mark(PLANE_BODY, cell, 1);
+    mark(PLANE_HEAD, cell, 1);
+}
+
+template <class B>
+void GymEnv::popTail(const B& b) {
+    int cell = ring[(std::size_t)b.wrap(headSlot + length - 1)];
+    length--;
+    Bitboard::reset(bodyBits, cell);
+    if (trapsLive) traps.release(b.cellOf(cell));
+    mark(PLANE_BODY, cell, 0);
+    if (length == 0) mark(PLANE_HEAD, cell, 0);
+}
+
+void GymEnv::clearBody() {
+    while (length > 0) popTail(board);
+}
+
+void GymEnv::loadWalls() {
+    walls = std::make_shared<const std::vector<Cell>>(barrier.getWalls());
+    applyWalls();
+}
+
+void GymEnv::applyWalls() {
+    trapsLive = false;
+    std::fill(wallBits.begin(), wallBits.end(), 0);
+    if (obs) std::memset(obs + (std::size_t)PLANE_WALLS * (std::size_t)area, 0, (std::size_t)area);
+    wallHash = 0;
+    for (const Cell& c : *walls) {
+        if (c.x < 0 || c.y < 0 || c.x >= gridWidth || c.y >= gridHeight) continue;
+        int i = index(c.x, c.y);
+        if (Bitboard::test(wallBits, i)) continue; // listed twice
+        Bitboard::set(wallBits, i);
+        wallHash ^= zobrist(PLANE_WALLS, i);
+        mark(PLANE_WALLS, i, 1);
+    }
+    spawnMap.build(*walls, gridWidth, gridHeight, barrier.getMinX(), barrier.getMinY(), barrier.getMaxX(), barrier.getMaxY());
+}
+
+bool GymEnv::isFree(int x, int y) const {
+    if (x < 0 || y < 0 || x >= gridWidth || y >= gridHeight) return false;
+    int i = index(x, y);
+    return !Bitboard::test(wallBits, i) && !Bitboard::test(bodyBits, i);
+}
+
+// A random cell strictly inside the walls with nothing on it, in the area
+// the head is in (the same rule as GameLogic::randomOpenCell)
+bool GymEnv::randomFreeCell(int& cell) {
+    int area = length > 0 ? spawnMap.areaOf(getHead()) : -1;
+    if (area < 0) area = spawnMap.getLargestArea();
+    Cell c;
+    auto taken = [&](int i) { return Bitboard::test(bodyBits, i) || fruitAt[(std::size_t)i]; };
+    if (!spawnMap.pick(area, rng, taken, c)) return false;
+    cell = index(c.x, c.y);
+    return true;
+}
+
+void GymEnv::addFruit(Fruit::Type type, float duration) {
+    int cell;
+    if (!randomFreeCell(cell)) return;
+    Fruit f;
+    Cell c = cellOf(cell);
+    f.x = c.x;
+    f.y = c.y;
+    f.type = type;
+    f.spawnTime = time;
+    f.duration = duration;
+    placeFruit(f);
+}
+
+void GymEnv::placeFruit(const Fruit& f) {
+    int cell = index(f.x, f.y);
+    fruits.push_back(f);
+    fruitAt[(std::size_t)cell] = (std::uint8_t)((int)f.type + 1);
+    mark((Plane)(PLANE_GOMU + (int)f.type), cell, 1);
+}
+
+void GymEnv::removeFruit(std::size_t i) {
+    int cell = index(fruits[i].x, fruits[i].y);
+    fruitAt[(std::size_t)cell] = 0;
+    mark((Plane)(PLANE_GOMU + (int)fruits[i].type), cell, 0);
+    fruits.erase(fruits.begin() + (std::ptrdiff_t)i);
+}
+
+void GymEnv::spawnGomu() {
+    if (!entrance.active) addFruit(Fruit::Type::Gomu, 0.f);
+}
+
+// Mera and Ope: at most one of each, not while a portal is open
+void GymEnv::spawnCheck() {
+    if (entrance.active || exit.active) return;
+    std::uniform_real_distribution<float> dist01(0.f, 1.f);
+    auto present = [&](Fruit::Type t) {
+        for (const Fruit& f : fruits) if (f.type == t) return true;
+        return false;
+    };
+    if (dist01(rng) < 0.40f && !present(Fruit::Type::Mera)) addFruit(Fruit::Type::Mera, 4.f);
+    if (dist01(rng) < 0.15f && !present(Fruit::Type::Ope)) addFruit(Fruit::Type::Ope, 2.f);
+}
+
+void GymEnv::saveState(State& out) const {
+    out.body.resize((std::size_t)length);
+    for (int i = 0; i < length; ++i) out.body[(std::size_t)i] = ring[(std::size_t)((headSlot + i) % area)];
+    out.fruits.assign(fruits.begin(), fruits.end());
+    out.walls = walls;
+    out.entrance = entrance;
+    out.exit = exit;
+    out.dir = dir;
+    out.growPending = growPending;
+    out.emerging = emerging;
+    out.nextPortalScore = nextPortalScore;
+    out.score = score;
+    out.time = time;
+    out.fruitCountdown = fruitCountdown;
+    out.lastSpawnCheck = lastSpawnCheck;
+    out.steps = steps;
+    out.done = done;
+    out.end = end;
+    out.rng = rng;
+}
+
+// Only the cells that differ are touched through mark(), which keeps the
+// observation and the hash in step; walls are reloaded only when a rollout
+// went through a portal
+void GymEnv::loadState(const State& in) {
+    trapsLive = false;
+    clearBody();
+    for (std::size_t i = fruits.size(); i-- > 0;) removeFruit(i);
+    if (entrance.active) mark(PLANE_PORTAL, index(entrance.x, entrance.y), 0);
+    if (in.walls && in.walls != walls) {
+        walls = in.walls;
+        barrier.setWalls(*walls);
+        applyWalls();
+    }
+
+    for (std::size_t i = in.body.size(); i-- > 0;) pushHead(board, in.body[i]);
+    for (const Fruit& f : in.fruits) placeFruit(f);
+    entrance = in.entrance;
+    if (entrance.active) mark(PLANE_PORTAL, index(entrance.x, entrance.y), 1);
+    exit = in.exit;
+    dir = in.dir;
+    growPending = in.growPending;
+    emerging = in.emerging;
+    nextPortalScore = in.nextPortalScore;
+    score = in.score;
+    time = in.time;
+    fruitCountdown = in.fruitCountdown;
+    lastSpawnCheck = in.lastSpawnCheck;
+    steps = in.steps;
+    done = in.done;
+    end = in.end;
+    rng = in.rng;
+}
+
+std::uint64_t GymEnv::getHash() const {
+    int heading = dir.y < 0 ? 0 : dir.y > 0 ? 1 : dir.x < 0 ? 2 : 3;
+    return wallHash ^ boardHash ^ zobrist(PLANE_COUNT, heading) ^ zobrist(PLANE_COUNT + 1, growPending)
+         ^ zobrist(PLANE_COUNT + 2, emerging) ^ zobrist(PLANE_COUNT + 3, nextPortalScore - score);
+}
+
+void GymEnv::followTraps() {
+    if (trapsLive) return;
+    scratch.clear();
+    for (int i = 0; i < length; ++i) scratch.push_back(cellOf(ring[(std::size_t)((headSlot + i) % area)]));
+    traps.reset(*walls, scratch);
+    trapsLive = true;
+}
+
+int GymEnv::getReachableArea() {
+    if (length == 0) return 0;
+    followTraps();
+    return traps.reachableArea(getHead());
+}
+
+// The portal entrance counts as a way out, as in GameLogic::checkTrapped
+bool GymEnv::isTrapped() {
+    if (length == 0 || emerging > 0) return false;
+    followTraps();
+    Cell head = getHead();
+    return traps.isTrapped(head, getTail(), length + growPending)
+           && !(entrance.active && traps.canReach(head, {entrance.x, entrance.y}));
+}
+
+void GymEnv::bindObservation(std::uint8_t* planes) {
+    obs = planes;
+    if (obs) writeObservation(obs);
+}
+
+void GymEnv::writeObservation(std::uint8_t* planes) const {
+    std::memset(planes, 0, observationSize());
+    std::uint8_t* walls = planes + (std::size_t)PLANE_WALLS * (std::size_t)area;
+    std::uint8_t* body = planes + (std::size_t)PLANE_BODY * (std::size_t)area;
+    for (int i = 0; i < area; ++i) {
+        walls[i] = (std::uint8_t)Bitboard::test(wallBits, i);
+        body[i] = (std::uint8_t)Bitboard::test(bodyBits, i);
+    }
+    if (length > 0) planes[(std::size_t)PLANE_HEAD * (std::size_t)area + (std::size_t)ring[(std::size_t)headSlot]] = 1;
+    for (const Fruit& f : fruits) {
+        planes[(std::size_t)(PLANE_GOMU + (int)f.type) * (std::size_t)area + (std::size_t)index(f.x, f.y)] = 1;
+    }
+    if (entrance.active) {
+        planes[(std::size_t)PLANE_PORTAL * (std::size_t)area + (std::size_t)index(entrance.x, entrance.y)] = 1;
+    }
+}
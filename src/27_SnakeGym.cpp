@@ -0,0 +1,96 @@
+#include "SnakeGym.h"
+#include "GymEnv.hpp"
+
+static_assert((int)GymEnv::PLANE_COUNT == SNAKE_GYM_PLANES, "plane lists differ");
+static_assert((int)GymEnv::ACTION_RIGHT == SNAKE_GYM_RIGHT, "action lists differ");
+static_assert((int)GymEnv::End::FruitTimer == SNAKE_GYM_FRUIT_TIMER, "end reasons differ");
+
+// The C handle is the environment itself
+struct SnakeGym {
+    GymEnv env;
+    SnakeGym(int width, int height) : env(width, height) {}
+};
+
+struct SnakeGymState {
+    GymEnv::State state;
+};
+
+int snake_gym_version(void) {
+    return SNAKE_GYM_VERSION;
+}
+
+SnakeGym* snake_gym_create(int width, int height) {
+    // Cells must stay addressable as bytes, and the map generator needs room
+    if (width < GymEnv::MIN_SIDE || height < GymEnv::MIN_SIDE || width > 255 || height > 255) return nullptr;
+    return new SnakeGym(width, height);
+}
+
+void snake_gym_destroy(SnakeGym* env) {
+    delete env;
+}
+
+void snake_gym_reset(SnakeGym* env, uint32_t seed) {
+    env->env.reset(seed);
+}
+
+int snake_gym_step(SnakeGym* env, int action, float* reward) {
+    GymEnv::Step s = env->env.step(action);
+    if (reward) *reward = s.reward;
+    return s.done ? 1 : 0;
+}
+
+size_t snake_gym_observation_size(const SnakeGym* env) {
+    return env->env.observationSize();
+}
+
+void snake_gym_bind_observation(SnakeGym* env, uint8_t* planes) {
+    env->env.bindObservation(planes);
+}
+
+void snake_gym_write_observation(const SnakeGym* env, uint8_t* planes) {
+    env->env.writeObservation(planes);
+}
+
+int snake_gym_score(const SnakeGym* env) {
+    return env->env.getScore();
+}
+
+int snake_gym_length(const SnakeGym* env) {
+    return env->env.getLength();
+}
+
+float snake_gym_fruit_timer(const SnakeGym* env) {
+    return env->env.getFruitCountdown();
+}
+
+int snake_gym_end(const SnakeGym* env) {
+    return (int)env->env.getEnd();
+}
+
+uint64_t snake_gym_hash(const SnakeGym* env) {
+    return env->env.getHash();
+}
+
+SnakeGymState* snake_gym_state_create(void) {
+    return new SnakeGymState();
+}
+
+void snake_gym_state_destroy(SnakeGymState* state) {
+    delete state;
+}
+
+void snake_gym_save(const SnakeGym* env, SnakeGymState* state) {
+    env->env.saveState(state->state);
+}
+
+void snake_gym_load(SnakeGym* env, const SnakeGymState* state) {
+    env->env.loadState(state->state);
+}
+
+int snake_gym_reachable_area(SnakeGym* env) {
+    return env->env.getReachableArea();
+}
+
+int snake_gym_trapped(SnakeGym* env) {
+    return env->env.isTrapped() ? 1 : 0;
+}
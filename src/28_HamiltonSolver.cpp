@@ -0,0 +1,672 @@
+#include "HamiltonSolver.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+namespace {
+
+const int DX[4] = {0, 0, -1, 1};
+const int DY[4] = {-1, 1, 0, 0};
+const int SPLICE_DEPTH = 12;   // longest run of missed cells spliced in at once
+const int DETOUR_CELLS = 64;   // off-cycle cells searched around a goal
+const int FRUIT_GROWTH = 3;    // the most one fruit adds (Ope)
+
+bool adjacent(const Cell& a, const Cell& b) {
+    return std::abs(a.x - b.x) + std::abs(a.y - b.y) == 1;
+}
+
+}
+
+HamiltonSolver::HamiltonSolver(int gridWidth, int gridHeight)
+    : gridWidth(gridWidth),
+      gridHeight(gridHeight),
+      area(gridWidth * gridHeight),
+      wall((std::size_t)area, 0),
+      region((std::size_t)area, 0),
+      links((std::size_t)area * 2, -1),
+      anchor((std::size_t)area, -1),
+      touched((std::size_t)area, 0),
+      order((std::size_t)area, -1),
+      nextOf((std::size_t)area, -1),
+      prevOf((std::size_t)area, -1),
+      visit((std::size_t)area, 0),
+      parent((std::size_t)area, -1) {}
+
+HamiltonSolver::Status HamiltonSolver::build(const std::vector<Cell>& walls, const Cell& start) {
+    PROFILE_ZONE("HamiltonSolver::build");
+    std::fill(wall.begin(), wall.end(), 0);
+    for (const Cell& c : walls) {
+        if (inGrid(c)) wall[(std::size_t)index(c)] = 1;
+    }
+    bool impossible = floodRegion(start);
+    if (originX < 0) chooseOrigin();
+    buildForest(start);
+
+    // Splice the missed cells in until nothing moves, then join cycles that
+    // run side by side (which can open new splices)
+    while (true) {
+        bool grew = true;
+        while (grew) {
+            grew = false;
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < uncovered.size(); ++i) {
+                int c = uncovered[i];
+                if (links[(std::size_t)c * 2] >= 0) continue; // taken by an earlier splice
+                if (absorb(c)) {
+                    grew = true;
+                    continue;
+                }
+                uncovered[kept++] = c;
+            }
+            uncovered.resize(kept);
+        }
+        if (mergeCycles() == 0) break;
+    }
+    walkMainCycle();
+
+    if (cycleLength == 0) status = Status::None;
+    else if (cycleLength == freeCells) status = Status::Complete;
+    else status = impossible ? Status::Impossible : Status::Partial;
+
+    forward = true;
+    oriented = false;
+    plannedSteps = 0;
+    rejoin = -1;
+    stretch.clear();
+    detour.clear();
+    detourStep = 0;
+    return status;
+}
+
+int HamiltonSolver::blockOf(int cell) const {
+    int x = cell % gridWidth - originX;
+    int y = cell / gridWidth - originY;
+    if (x < 0 || y < 0) return -1;
+    int bx = x >> 1, by = y >> 1;
+    if (bx >= blocksW || by >= blocksH) return -1;
+    return by * blocksW + bx;
+}
+
+int HamiltonSolver::findSet(int block) {
+    while (blockSet[(std::size_t)block] != block) {
+        blockSet[(std::size_t)block] = blockSet[(std::size_t)blockSet[(std::size_t)block]];
+        block = blockSet[(std::size_t)block];
+    }
+    return block;
+}
+
+bool HamiltonSolver::unite(int a, int b) {
+    a = findSet(a);
+    b = findSet(b);
+    if (a == b) return false;
+    blockSet[(std::size_t)b] = a;
+    return true;
+}
+
+// BFS from start; also checks the two things that rule a full cycle out:
+// a cell with fewer than two free neighbours, or unequal colour counts
+bool HamiltonSolver::floodRegion(const Cell& start) {
+    std::fill(region.begin(), region.end(), 0);
+    freeCells = 0;
+    if (!inGrid(start) || wall[(std::size_t)index(start)]) return true;
+    queue.clear();
+    queue.push_back(index(start));
+    region[(std::size_t)index(start)] = 1;
+    int colour[2] = {0, 0};
+    bool deadEnd = false;
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        Cell c = cellOf(queue[head]);
+        colour[(c.x + c.y) & 1]++;
+        int open = 0;
+        for (int d = 0; d < 4; ++d) {
+            Cell n{c.x + DX[d], c.y + DY[d]};
+            if (!inGrid(n) || wall[(std::size_t)index(n)]) continue;
+            open++;
+            if (region[(std::size_t)index(n)]) continue;
+            region[(std::size_t)index(n)] = 1;
+            queue.push_back(index(n));
+        }
+        if (open < 2) deadEnd = true;
+    }
+    freeCells = (int)queue.size();
+    return deadEnd || colour[0] != colour[1];
+}
+
+// The block alignment with the most fully free blocks; kept for later builds
+// so the forest can be reused
+void HamiltonSolver::chooseOrigin() {
+    int best = -1;
+    for (int oy = 0; oy < 2; ++oy) {
+        for (int ox = 0; ox < 2; ++ox) {
+            int full = 0;
+            for (int y = oy; y + 1 < gridHeight; y += 2) {
+                for (int x = ox; x + 1 < gridWidth; x += 2) {
+                    int i = y * gridWidth + x;
+                    if (region[(std::size_t)i] && region[(std::size_t)i + 1] &&
+                        region[(std::size_t)(i + gridWidth)] && region[(std::size_t)(i + gridWidth + 1)]) full++;
+                }
+            }
+            if (full > best) {
+                best = full;
+                originX = ox;
+                originY = oy;
+            }
+        }
+    }
+    blocksW = (gridWidth - originX) / 2;
+    blocksH = (gridHeight - originY) / 2;
+    std::size_t blocks = (std::size_t)(blocksW * blocksH);
+    blockFull.assign(blocks, 0);
+    blockOpen.assign(blocks, 0);
+    blockSet.assign(blocks, 0);
+    setCells.assign(blocks, 0);
+}
+
+void HamiltonSolver::buildForest(const Cell& start) {
+    int blocks = blocksW * blocksH;
+    std::vector<std::uint8_t> full((std::size_t)blocks, 0);
+    std::vector<std::uint8_t> open((std::size_t)blocks, 0);
+    for (int b = 0; b < blocks; ++b) {
+        blockSet[(std::size_t)b] = b;
+        int i = (originY + (b / blocksW) * 2) * gridWidth + originX + (b % blocksW) * 2;
+        full[(std::size_t)b] = region[(std::size_t)i] && region[(std::size_t)i + 1] &&
+                               region[(std::size_t)(i + gridWidth)] && region[(std::size_t)(i + gridWidth + 1)];
+    }
+    auto join = [&](int b, int n, Side out, Side in) {
+        if (!full[(std::size_t)n] || !unite(b, n)) return;
+        open[(std::size_t)b] |= out;
+        open[(std::size_t)n] |= in;
+    };
+    // Tree edges of the previous build that still join two free blocks...
+    for (int b = 0; b < blocks; ++b) {
+        if (!full[(std::size_t)b]) continue;
+        if (blockOpen[(std::size_t)b] & RIGHT) join(b, b + 1, RIGHT, LEFT);
+        if (blockOpen[(std::size_t)b] & DOWN) join(b, b + blocksW, DOWN, UP);
+    }
+    // ...then breadth first from the start, so the tour sweeps around it
+    // and cycle order follows the angle: a goal "behind" the head is never
+    // more than a lap around the start away
+    std::vector<std::uint8_t> seen((std::size_t)blocks, 0);
+    int first = blockOf(index(start));
+    for (int root = -1; root < blocks; ++root) {
+        int r = root < 0 ? first : root;
+        if (r < 0 || !full[(std::size_t)r] || seen[(std::size_t)r]) continue;
+        seen[(std::size_t)r] = 1;
+        queue.clear();
+        queue.push_back(r);
+        for (std::size_t i = 0; i < queue.size(); ++i) {
+            int b = queue[i];
+            int bx = b % blocksW, by = b / blocksW;
+            const int next[4] = {by > 0 ? b - blocksW : -1, by + 1 < blocksH ? b + blocksW : -1,
+                                 bx > 0 ? b - 1 : -1, bx + 1 < blocksW ? b + 1 : -1};
+            const Side out[4] = {UP, DOWN, LEFT, RIGHT};
+            const Side in[4] = {DOWN, UP, RIGHT, LEFT};
+            for (int d = 0; d < 4; ++d) {
+                int n = next[d];
+                if (n < 0 || !full[(std::size_t)n]) continue;
+                join(b, n, out[d], in[d]);
+                if (seen[(std::size_t)n]) continue;
+                seen[(std::size_t)n] = 1;
+                queue.push_back(n);
+            }
+        }
+    }
+
+    // Only cells that were spliced or whose block changed get new links
+    std::vector<int> dirty;
+    dirty.swap(touchedCells);
+    for (int c : dirty) touched[(std::size_t)c] = 0;
+    for (int b = 0; b < blocks; ++b) {
+        if (full[(std::size_t)b] == blockFull[(std::size_t)b] && open[(std::size_t)b] == blockOpen[(std::size_t)b]) continue;
+        int i = (originY + (b / blocksW) * 2) * gridWidth + originX + (b % blocksW) * 2;
+        dirty.push_back(i);
+        dirty.push_back(i + 1);
+        dirty.push_back(i + gridWidth);
+        dirty.push_back(i + gridWidth + 1);
+    }
+    blockFull.swap(full);
+    blockOpen.swap(open);
+    for (int c : dirty) resetCell(c);
+
+    std::fill(setCells.begin(), setCells.end(), 0);
+    for (int b = 0; b < blocks; ++b) {
+        if (blockFull[(std::size_t)b]) setCells[(std::size_t)findSet(b)] += 4;
+    }
+    uncovered.clear();
+    for (int c = 0; c < area; ++c) {
+        if (region[(std::size_t)c] && links[(std::size_t)c * 2] < 0) uncovered.push_back(c);
+    }
+}
+
+// The links a cell gets from its block alone: around the block, except
+// across each side that is a tree edge
+void HamiltonSolver::resetCell(int cell) {
+    int b = blockOf(cell);
+    int* l = &links[(std::size_t)cell * 2];
+    if (b < 0 || !blockFull[(std::size_t)b]) {
+        l[0] = l[1] = -1;
+        anchor[(std::size_t)cell] = -1;
+        return;
+    }
+    Cell c = cellOf(cell);
+    int lx = (c.x - originX) & 1, ly = (c.y - originY) & 1;
+    std::uint8_t open = blockOpen[(std::size_t)b];
+    // Top or bottom side
+    if (open & (ly ? DOWN : UP)) l[0] = index({c.x, c.y + (ly ? 1 : -1)});
+    else l[0] = index({c.x + (lx ? -1 : 1), c.y});
+    // Left or right side
+    if (open & (lx ? RIGHT : LEFT)) l[1] = index({c.x + (lx ? 1 : -1), c.y});
+    else l[1] = index({c.x, c.y + (ly ? -1 : 1)});
+    anchor[(std::size_t)cell] = b;
+}
+
+void HamiltonSolver::markTouched(int cell) {
+    if (touched[(std::size_t)cell]) return;
+    touched[(std::size_t)cell] = 1;
+    touchedCells.push_back(cell);
+}
+
+void HamiltonSolver::linkCell(int cell, int from, int to) {
+    int* l = &links[(std::size_t)cell * 2];
+    if (l[0] == from) l[0] = to;
+    else l[1] = to;
+    markTouched(cell);
+}
+
+// Replace a cycle edge p-q with p - u ... v - q, where u ... v runs through
+// cells off every cycle (shortest such run found by BFS from u)
+bool HamiltonSolver::absorb(int u) {
+    Cell cu = cellOf(u);
+    stamp++;
+    queue.clear();
+    queue.push_back(u);
+    visit[(std::size_t)u] = stamp;
+    parent[(std::size_t)u] = -1;
+    std::size_t levelEnd = 1;
+    int depth = 0;
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        if (head == levelEnd) {
+            if (++depth >= SPLICE_DEPTH) break;
+            levelEnd = queue.size();
+        }
+        int v = queue[head];
+        Cell cv = cellOf(v);
+        for (int d = 0; d < 4 && v != u; ++d) {
+            Cell cq{cv.x + DX[d], cv.y + DY[d]};
+            if (!inGrid(cq)) continue;
+            int q = index(cq);
+            if (links[(std::size_t)q * 2] < 0) continue;
+            for (int s = 0; s < 2; ++s) {
+                int p = links[(std::size_t)q * 2 + (std::size_t)s];
+                if (!adjacent(cellOf(p), cu)) continue;
+                // p - u ... v - q
+                linkCell(p, q, u);
+                linkCell(q, p, v);
+                int added = 0;
+                int prev = q;
+                for (int c = v; c >= 0; c = parent[(std::size_t)c]) {
+                    int* l = &links[(std::size_t)c * 2];
+                    l[1] = prev;
+                    l[0] = parent[(std::size_t)c] >= 0 ? parent[(std::size_t)c] : p;
+                    anchor[(std::size_t)c] = anchor[(std::size_t)p];
+                    markTouched(c);
+                    prev = c;
+                    added++;
+                }
+                setCells[(std::size_t)findSet(anchor[(std::size_t)p])] += added;
+                return true;
+            }
+        }
+        for (int d = 0; d < 4; ++d) {
+            Cell cn{cv.x + DX[d], cv.y + DY[d]};
+            if (!inGrid(cn)) continue;
+            int n = index(cn);
+            if (!region[(std::size_t)n] || links[(std::size_t)n * 2] >= 0 || visit[(std::size_t)n] == stamp) continue;
+            visit[(std::size_t)n] = stamp;
+            parent[(std::size_t)n] = v;
+            queue.push_back(n);
+        }
+    }
+    return false;
+}
+
+// Two cycles with parallel edges p-q and p2-q2 become one: p-p2 and q-q2
+int HamiltonSolver::mergeCycles() {
+    int cycles = 0;
+    for (std::size_t b = 0; b < setCells.size(); ++b) {
+        if (blockSet[b] == (int)b && setCells[b] > 0) cycles++;
+    }
+    if (cycles < 2) return 0;
+    auto linked = [&](int a, int b) {
+        return links[(std::size_t)a * 2] == b || links[(std::size_t)a * 2 + 1] == b;
+    };
+    int merged = 0;
+    for (int p = 0; p < area; ++p) {
+        if (links[(std::size_t)p * 2] < 0) continue;
+        Cell c = cellOf(p);
+        for (int k = 0; k < 2; ++k) {
+            // k = 0: horizontal edge with one below; k = 1: vertical edge with one to the right
+            Cell cq = k == 0 ? Cell{c.x + 1, c.y} : Cell{c.x, c.y + 1};
+            Cell cp2 = k == 0 ? Cell{c.x, c.y + 1} : Cell{c.x + 1, c.y};
+            Cell cq2{cq.x + cp2.x - c.x, cq.y + cp2.y - c.y};
+            if (!inGrid(cq2)) continue;
+            int q = index(cq), p2 = index(cp2), q2 = index(cq2);
+            if (!linked(p, q) || !linked(p2, q2)) continue;
+            int a = findSet(anchor[(std::size_t)p]);
+            int b = findSet(anchor[(std::size_t)p2]);
+            if (a == b) continue;
+            linkCell(p, q, p2);
+            linkCell(q, p, q2);
+            linkCell(p2, q2, p);
+            linkCell(q2, p2, q);
+            blockSet[(std::size_t)b] = a;
+            setCells[(std::size_t)a] += setCells[(std::size_t)b];
+            merged++;
+        }
+    }
+    return merged;
+}
+
+// Number the largest cycle; the others are left for the off-cycle detours
+void HamiltonSolver::walkMainCycle() {
+    std::fill(order.begin(), order.end(), -1);
+    cycleLength = 0;
+    int best = -1, bestCells = 0;
+    for (std::size_t b = 0; b < setCells.size(); ++b) {
+        if (blockSet[b] == (int)b && setCells[b] > bestCells) {
+            best = (int)b;
+            bestCells = setCells[b];
+        }
+    }
+    if (best < 0) return;
+    int first = -1;
+    for (int b = 0; b < (int)blockFull.size() && first < 0; ++b) {
+        if (blockFull[(std::size_t)b] && findSet(b) == best) {
+            first = (originY + (b / blocksW) * 2) * gridWidth + originX + (b % blocksW) * 2;
+        }
+    }
+    int prev = -1, cur = first;
+    do {
+        order[(std::size_t)cur] = cycleLength++;
+        int next = links[(std::size_t)cur * 2] != prev ? links[(std::size_t)cur * 2] : links[(std::size_t)cur * 2 + 1];
+        nextOf[(std::size_t)cur] = next;
+        prevOf[(std::size_t)next] = cur;
+        prev = cur;
+        cur = next;
+    } while (cur != first && cycleLength < area);
+}
+
+int HamiltonSolver::distance(int from, int to) const {
+    int d = order[(std::size_t)to] - order[(std::size_t)from];
+    if (!forward) d = -d;
+    return d < 0 ? d + cycleLength : d;
+}
+
+Cell HamiltonSolver::nextMove(const SnakeState& snake, const std::vector<Cell>& goals, bool teleport,
+                              const std::function<bool(const Cell&)>& isBody) {
+    int h = index(snake.head);
+    Cell back{snake.head.x - snake.direction.x, snake.head.y - snake.direction.y};
+    int reverse = inGrid(back) ? index(back) : -1;
+    if (cycleLength == 0 || !inGrid(snake.head)) return anyFreeNeighbour(snake, reverse, isBody);
+
+    // A detour in progress
+    if (detourStep > 0) {
+        if (detourStep < detour.size() && detour[detourStep - 1] == h && !isBody(cellOf(detour[detourStep]))) {
+            int n = detour[detourStep++];
+            if (order[(std::size_t)n] >= 0) rejoin = n;
+            else stretch.push_back(n);
+            plannedSteps++;
+            return cellOf(n);
+        }
+        detour.clear();
+        detourStep = 0;
+    }
+
+    // Off the cycle (start, portal exit, a fallback): find the way back
+    if (order[(std::size_t)h] < 0) {
+        int n = approachCycle(h, reverse, isBody);
+        if (n < 0) {
+            plannedSteps = 0;
+            return anyFreeNeighbour(snake, reverse, isBody);
+        }
+        if (stretch.empty() || stretch.back() != h) {
+            stretch.clear();
+            stretch.push_back(h);
+        }
+        if (order[(std::size_t)n] >= 0) rejoin = n;
+        else stretch.push_back(n);
+        plannedSteps++;
+        return cellOf(n);
+    }
+
+    if (!oriented) {
+        // Ride the cycle whichever way does not start by turning back
+        oriented = true;
+        int n = follow(h);
+        if (n == reverse || isBody(cellOf(n))) forward = !forward;
+    }
+    int next = follow(h);
+    int tailCell = inGrid(snake.tail) ? index(snake.tail) : -1;
+    // The body is in cycle order once it is entirely made of planned moves.
+    // Segments still on the last off-cycle stretch free no cycle cell when
+    // the tail leaves them, and a tail among them counts as the cell where
+    // the stretch rejoined the cycle.
+    bool ordered = plannedSteps >= snake.length - 1 && tailCell >= 0;
+    int inStretch = 0;
+    if (ordered) {
+        for (int c : stretch) inStretch += isBody(cellOf(c)) ? 1 : 0;
+    }
+    int tail = tailCell;
+    if (ordered && order[(std::size_t)tail] < 0) tail = rejoin;
+    if (tail < 0 || order[(std::size_t)tail] < 0) ordered = false;
+
+    if (!ordered) {
+        bool blocked = next == reverse || (isBody(cellOf(next)) && !(next == tailCell && snake.growPending == 0));
+        if (blocked) {
+            plannedSteps = 0;
+            return anyFreeNeighbour(snake, reverse, isBody);
+        }
+        plannedSteps++;
+        return cellOf(next);
+    }
+
+    int gap = distance(h, tail);
+    if (gap == 0) gap = cycleLength;
+    gap -= inStretch;
+    int maxJump = jumpLimit(gap, snake);
+
+    // The goal reached first along the cycle; off-cycle goals count from the
+    // detour's entry
+    int target = -1, targetDist = INT_MAX;
+    bool viaDetour = false;
+    for (const Cell& g : goals) {
+        if (!inGrid(g)) continue;
+        int gi = index(g);
+        if (order[(std::size_t)gi] >= 0) {
+            int d = distance(h, gi);
+            if (d < targetDist) {
+                target = gi;
+                targetDist = d;
+                viaDetour = false;
+            }
+        } else if (inStretch == 0) {
+            // (one off-cycle stretch in the body at a time)
+            int entry;
+            if (!planDetour(h, gap, snake, gi, teleport, isBody, entry, candidate)) continue;
+            int d = distance(h, entry);
+            if (d < targetDist && (entry != h || candidate[0] != reverse)) {
+                target = entry;
+                targetDist = d;
+                viaDetour = true;
+                detour.swap(candidate);
+            }
+        }
+    }
+    if (viaDetour && target == h) {
+        detourStep = 1;
+        stretch.clear();
+        stretch.push_back(detour[0]);
+        plannedSteps++;
+        return cellOf(detour[0]);
+    }
+    if (!viaDetour) detour.clear();
+
+    int best = next, bestDist = 1;
+    if (target >= 0) {
+        for (int d = 0; d < 4; ++d) {
+            Cell cn{snake.head.x + DX[d], snake.head.y + DY[d]};
+            if (!inGrid(cn)) continue;
+            int n = index(cn);
+            if (order[(std::size_t)n] < 0 || n == reverse) continue;
+            int dist = distance(h, n);
+            if (dist <= bestDist || dist > targetDist || dist > maxJump) continue;
+            if (isBody(cn)) continue;
+            best = n;
+            bestDist = dist;
+        }
+    }
+    if (best == next && isBody(cellOf(next)) && !(next == tailCell && snake.growPending == 0)) {
+        plannedSteps = 0;
+        return anyFreeNeighbour(snake, reverse, isBody);
+    }
+    plannedSteps++;
+    return cellOf(best);
+}
+
+// How far along the cycle a move may land, from a cell `ahead` steps short
+// of the tail. 1 means no shortcut: ride the cycle.
+int HamiltonSolver::jumpLimit(int ahead, const SnakeState& snake) const {
+    int body = snake.length + snake.growPending;
+    // Past half the cycle the snake only rides it
+    if (2 * body > cycleLength) return 1;
+    // The landing cell stays behind the tail with the body, the growth to
+    // come and the fruit being chased still free in between
+    return std::max(1, ahead - body - FRUIT_GROWTH);
+}
+
+// A path from the cycle at `entry` through off-cycle cells to the goal and,
+// unless the goal is a portal, on to a cycle cell the tail cannot reach first
+bool HamiltonSolver::planDetour(int head, int gap, const SnakeState& snake, int goal, bool teleport,
+                                const std::function<bool(const Cell&)>& isBody, int& entry, std::vector<int>& path) {
+    if (!region[(std::size_t)goal] || isBody(cellOf(goal))) return false;
+    stamp++;
+    queue.clear();
+    queue.push_back(goal);
+    visit[(std::size_t)goal] = stamp;
+    parent[(std::size_t)goal] = -1;
+    // Doors: (off-cycle cell, cycle cell next to it)
+    std::vector<std::pair<int, int>>& doors = doorScratch;
+    doors.clear();
+    for (std::size_t i = 0; i < queue.size(); ++i) {
+        int v = queue[i];
+        Cell cv = cellOf(v);
+        for (int d = 0; d < 4; ++d) {
+            Cell cn{cv.x + DX[d], cv.y + DY[d]};
+            if (!inGrid(cn)) continue;
+            int n = index(cn);
+            if (order[(std::size_t)n] >= 0) {
+                if (n == head || !isBody(cn)) doors.push_back({v, n});
+                continue;
+            }
+            if ((int)queue.size() >= DETOUR_CELLS) continue;
+            if (!region[(std::size_t)n] || visit[(std::size_t)n] == stamp || isBody(cn)) continue;
+            visit[(std::size_t)n] = stamp;
+            parent[(std::size_t)n] = v;
+            queue.push_back(n);
+        }
+    }
+    // First step away from the goal on the way to v (the goal itself for v == goal)
+    auto branch = [&](int v) {
+        while (v != goal && parent[(std::size_t)v] != goal) v = parent[(std::size_t)v];
+        return v;
+    };
+
+    int bestIn = -1, bestOut = -1, bestDist = INT_MAX;
+    for (std::size_t i = 0; i < doors.size(); ++i) {
+        int a = doors[i].second;
+        int toEntry = distance(head, a);
+        if (a != head && toEntry >= gap) continue; // behind the tail
+        if (toEntry >= bestDist) continue;
+        if (teleport) {
+            bestIn = (int)i;
+            bestDist = toEntry;
+            continue;
+        }
+        int maxJump = jumpLimit(gap - toEntry, snake);
+        int out = -1, outJump = INT_MAX;
+        for (std::size_t j = 0; j < doors.size(); ++j) {
+            int c = doors[j].second;
+            if (c == a) continue;
+            int vi = doors[i].first, vj = doors[j].first;
+            if (vi != goal && vj != goal && branch(vi) == branch(vj)) continue; // the two halves would cross
+            int jump = distance(a, c);
+            if (jump < 1 || jump > maxJump || jump >= outJump) continue;
+            out = (int)j;
+            outJump = jump;
+        }
+        if (out < 0) continue;
+        bestIn = (int)i;
+        bestOut = out;
+        bestDist = toEntry;
+    }
+    if (bestIn < 0) return false;
+
+    path.clear();
+    for (int v = doors[(std::size_t)bestIn].first; v >= 0; v = parent[(std::size_t)v]) path.push_back(v);
+    if (!teleport) {
+        std::size_t mid = path.size();
+        for (int v = doors[(std::size_t)bestOut].first; v != goal; v = parent[(std::size_t)v]) path.push_back(v);
+        std::reverse(path.begin() + (std::ptrdiff_t)mid, path.end());
+        path.push_back(doors[(std::size_t)bestOut].second);
+    }
+    entry = doors[(std::size_t)bestIn].second;
+    return true;
+}
+
+// First step of the shortest free path to the cycle
+int HamiltonSolver::approachCycle(int head, int reverse, const std::function<bool(const Cell&)>& isBody) {
+    stamp++;
+    queue.clear();
+    queue.push_back(head);
+    visit[(std::size_t)head] = stamp;
+    parent[(std::size_t)head] = -1;
+    for (std::size_t i = 0; i < queue.size(); ++i) {
+        int v = queue[i];
+        Cell cv = cellOf(v);
+        for (int d = 0; d < 4; ++d) {
+            Cell cn{cv.x + DX[d], cv.y + DY[d]};
+            if (!inGrid(cn)) continue;
+            int n = index(cn);
+            if (visit[(std::size_t)n] == stamp || wall[(std::size_t)n] || (v == head && n == reverse)) continue;
+            if (isBody(cn)) continue;
+            visit[(std::size_t)n] = stamp;
+            parent[(std::size_t)n] = v;
+            if (order[(std::size_t)n] >= 0) {
+                while (parent[(std::size_t)n] != head) n = parent[(std::size_t)n];
+                return n;
+            }
+            queue.push_back(n);
+        }
+    }
+    return -1;
+}
+
+// Nothing planned works: any free neighbour, cycle cells first, else straight on
+Cell HamiltonSolver::anyFreeNeighbour(const SnakeState& snake, int reverse,
+                                      const std::function<bool(const Cell&)>& isBody) const {
+    Cell fallback{snake.head.x + snake.direction.x, snake.head.y + snake.direction.y};
+    bool found = false;
+    for (int d = 0; d < 4; ++d) {
+        Cell cn{snake.head.x + DX[d], snake.head.y + DY[d]};
+        if (!inGrid(cn)) continue;
+        int n = index(cn);
+        if (n == reverse || wall[(std::size_t)n] || isBody(cn)) continue;
+        if (order[(std::size_t)n] >= 0) return cn;
+        if (!found) {
+            fallback = cn;
+            found = true;
+        }
+    }
+    return fallback;
+}
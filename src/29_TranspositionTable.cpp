@@ -0,0 +1,88 @@
+#include "TranspositionTable.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// data: value bits 0-31, depth 32-39, bound 40-41, action 42-43,
+// generation 48-55, bit 63 set in every stored entry
+const std::uint64_t USED = 1ull << 63;
+
+int depthOf(std::uint64_t data) { return (int)((data >> 32) & 0xff); }
+std::uint8_t generationOf(std::uint64_t data) { return (std::uint8_t)(data >> 48); }
+
+}
+
+TranspositionTable::TranspositionTable(std::size_t megabytes) {
+    std::size_t pairs = std::max<std::size_t>(1, megabytes * 1024 * 1024 / (2 * sizeof(Slot)));
+    std::size_t size = 1;
+    while (size * 2 <= pairs) size *= 2;
+    slots.reset(new Slot[size * 2]);
+    mask = size - 1;
+}
+
+std::uint64_t TranspositionTable::pack(const Entry& e, std::uint8_t generation) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &e.value, sizeof bits);
+    return (std::uint64_t)bits
+         | (std::uint64_t)(std::min(std::max(e.depth, 0), 255)) << 32
+         | (std::uint64_t)((int)e.bound & 3) << 40
+         | (std::uint64_t)(e.action & 3) << 42
+         | (std::uint64_t)generation << 48
+         | USED;
+}
+
+void TranspositionTable::unpack(std::uint64_t data, Entry& e) {
+    std::uint32_t bits = (std::uint32_t)data;
+    std::memcpy(&e.value, &bits, sizeof bits);
+    e.depth = depthOf(data);
+    e.bound = (Bound)((data >> 40) & 3);
+    e.action = (int)((data >> 42) & 3);
+}
+
+bool TranspositionTable::probe(std::uint64_t key, Entry& out) const {
+    const Slot* pair = &slots[(key & mask) * 2];
+    for (int i = 0; i < 2; ++i) {
+        std::uint64_t data = pair[i].data.load(std::memory_order_relaxed);
+        std::uint64_t check = pair[i].check.load(std::memory_order_relaxed);
+        if ((data & USED) && (check ^ data) == key) {
+            unpack(data, out);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(std::uint64_t key, const Entry& entry) {
+    Slot* pair = &slots[(key & mask) * 2];
+    std::uint8_t now = generation.load(std::memory_order_relaxed);
+    std::uint64_t d0 = pair[0].data.load(std::memory_order_relaxed);
+    std::uint64_t d1 = pair[1].data.load(std::memory_order_relaxed);
+
+    Slot* target;
+    if ((pair[0].check.load(std::memory_order_relaxed) ^ d0) == key) target = &pair[0];
+    else if ((pair[1].check.load(std::memory_order_relaxed) ^ d1) == key) target = &pair[1];
+    else if (!(d0 & USED)) target = &pair[0];
+    else if (!(d1 & USED)) target = &pair[1];
+    else {
+        bool old0 = generationOf(d0) != now, old1 = generationOf(d1) != now;
+        if (old0 != old1) target = old0 ? &pair[0] : &pair[1];
+        else target = depthOf(d0) <= depthOf(d1) ? &pair[0] : &pair[1];
+    }
+    // A deeper result from this search is not given up for a shallower one
+    std::uint64_t held = target->data.load(std::memory_order_relaxed);
+    if ((target->check.load(std::memory_order_relaxed) ^ held) == key && generationOf(held) == now
+        && depthOf(held) > entry.depth) {
+        return;
+    }
+    std::uint64_t data = pack(entry, now);
+    target->data.store(data, std::memory_order_relaxed);
+    target->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+    for (std::size_t i = 0; i < getSlots(); ++i) {
+        slots[i].data.store(0, std::memory_order_relaxed);
+        slots[i].check.store(0, std::memory_order_relaxed);
+    }
+}
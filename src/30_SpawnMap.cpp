@@ -0,0 +1,131 @@
+#include "SpawnMap.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+
+namespace {
+
+// As in TrapDetector: a tick loses at most a tail cell and gains growth
+const int MAX_TAIL_STEPS = 4;
+
+}
+
+void SpawnMap::build(const std::vector<Cell>& walls, int width, int height, int minX, int minY, int maxX, int maxY) {
+    PROFILE_ZONE("SpawnMap::build");
+    gridWidth = width;
+    gridHeight = height;
+    // -2 = open and not labelled yet
+    label.assign((std::size_t)(width * height), -1);
+    int x0 = std::max(minX + 1, 0), y0 = std::max(minY + 1, 0);
+    int x1 = std::min(maxX - 1, width - 1), y1 = std::min(maxY - 1, height - 1);
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) label[(std::size_t)(y * width + x)] = -2;
+    }
+    for (const Cell& c : walls) {
+        if (c.x >= 0 && c.y >= 0 && c.x < width && c.y < height) label[(std::size_t)(c.y * width + c.x)] = -1;
+    }
+
+    // Each area's cells end up contiguous: the flood fill appends them in turn
+    cells.clear();
+    start.assign(1, 0);
+    largest = -1;
+    int largestSize = 0;
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            int seed = y * width + x;
+            if (label[(std::size_t)seed] != -2) continue;
+            int area = (int)start.size() - 1;
+            std::size_t first = cells.size();
+            label[(std::size_t)seed] = area;
+            cells.push_back(seed);
+            for (std::size_t i = first; i < cells.size(); ++i) {
+                int c = cells[i];
+                int cx = c % width, cy = c / width;
+                const int next[4] = {cy > 0 ? c - width : -1, cy + 1 < height ? c + width : -1,
+                                     cx > 0 ? c - 1 : -1, cx + 1 < width ? c + 1 : -1};
+                for (int n : next) {
+                    if (n < 0 || label[(std::size_t)n] != -2) continue;
+                    label[(std::size_t)n] = area;
+                    cells.push_back(n);
+                }
+            }
+            start.push_back((int)cells.size());
+            int size = (int)(cells.size() - first);
+            if (size > largestSize) {
+                largestSize = size;
+                largest = area;
+            }
+        }
+    }
+
+    freeCount.resize(start.size() - 1);
+    for (std::size_t a = 0; a + 1 < start.size(); ++a) freeCount[a] = start[a + 1] - start[a];
+    slot.assign(label.size(), -1);
+    for (std::size_t i = 0; i < cells.size(); ++i) slot[(std::size_t)cells[i]] = (int)i;
+    users.assign(label.size(), 0);
+    trail.clear();
+}
+
+void SpawnMap::follow(const PackedBody& body) {
+    if (trail.empty() || body.empty()) {
+        assignBody(body);
+        return;
+    }
+    if (!(body.front() == trail.front())) {
+        if (body.size() < 2 || !(body[1] == trail.front())) {
+            assignBody(body);
+            return;
+        }
+        occupy(body.front());
+        trail.pushFront(body.front());
+    }
+    int steps = 0;
+    while (!trail.empty() && (trail.size() > body.size() || !(trail.back() == body[trail.size() - 1]))) {
+        if (++steps > MAX_TAIL_STEPS) {
+            assignBody(body);
+            return;
+        }
+        release(trail.back());
+        trail.popBack();
+    }
+    while (trail.size() < body.size()) {
+        if (++steps > MAX_TAIL_STEPS) {
+            assignBody(body);
+            return;
+        }
+        Cell c = body[trail.size()];
+        occupy(c);
+        trail.pushBack(c);
+    }
+}
+
+void SpawnMap::assignBody(const PackedBody& body) {
+    for (const Cell& c : trail) release(c);
+    trail = body;
+    for (const Cell& c : trail) occupy(c);
+}
+
+// The first segment on a cell swaps it to the back of its area's list, the
+// last one to leave swaps it back
+void SpawnMap::occupy(const Cell& c) {
+    int area = areaOf(c);
+    if (area < 0) return;
+    std::size_t cell = (std::size_t)(c.y * gridWidth + c.x);
+    if (users[cell]++ > 0) return;
+    int last = start[(std::size_t)area] + --freeCount[(std::size_t)area];
+    int other = cells[(std::size_t)last];
+    std::swap(cells[(std::size_t)slot[cell]], cells[(std::size_t)last]);
+    slot[(std::size_t)other] = slot[cell];
+    slot[cell] = last;
+}
+
+void SpawnMap::release(const Cell& c) {
+    int area = areaOf(c);
+    if (area < 0) return;
+    std::size_t cell = (std::size_t)(c.y * gridWidth + c.x);
+    if (users[cell] == 0 || --users[cell] > 0) return;
+    int first = start[(std::size_t)area] + freeCount[(std::size_t)area]++;
+    int other = cells[(std::size_t)first];
+    std::swap(cells[(std::size_t)slot[cell]], cells[(std::size_t)first]);
+    slot[(std::size_t)other] = slot[cell];
+    slot[cell] = first;
+}
@@ -0,0 +1,337 @@
+#include "TrapDetector.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// Around a cell, clockwise from the one above; even entries share a side
+const int RING[8][2] = {{0, -1}, {1, -1}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}};
+
+// The follow() tail can lose a cell and gain growth in one tick; more than
+// this and the body did not just move
+const int MAX_TAIL_STEPS = 4;
+
+}
+
+TrapDetector::TrapDetector(int gridWidth, int gridHeight)
+    : gridWidth(gridWidth),
+      gridHeight(gridHeight),
+      blocked((std::size_t)(gridWidth * gridHeight), 0),
+      wall((std::size_t)(gridWidth * gridHeight), 0),
+      label((std::size_t)(gridWidth * gridHeight), -1),
+      seen((std::size_t)(gridWidth * gridHeight), 0),
+      owner((std::size_t)(gridWidth * gridHeight), 0) {
+    relabel();
+}
+
+void TrapDetector::reset(const std::vector<Cell>& walls, const PackedBody& body) {
+    std::fill(blocked.begin(), blocked.end(), 0);
+    std::fill(wall.begin(), wall.end(), 0);
+    trail.clear();
+    setWalls(walls);
+    assignBody(body);
+}
+
+void TrapDetector::reset(const std::vector<Cell>& walls, const std::vector<Cell>& body) {
+    PackedBody packed;
+    packed.assign(body);
+    reset(walls, packed);
+}
+
+void TrapDetector::setWalls(const std::vector<Cell>& walls) {
+    for (std::size_t i = 0; i < wall.size(); ++i) {
+        if (wall[i]) blocked[i]--;
+        wall[i] = 0;
+    }
+    for (const Cell& c : walls) {
+        if (!inside(c)) continue;
+        std::size_t i = (std::size_t)index(c);
+        if (wall[i]) continue; // listed twice
+        wall[i] = 1;
+        blocked[i]++;
+    }
+    relabel();
+}
+
+void TrapDetector::assignBody(const PackedBody& body) {
+    for (const Cell& c : trail) {
+        if (inside(c)) blocked[(std::size_t)index(c)]--;
+    }
+    trail = body;
+    for (const Cell& c : trail) {
+        if (inside(c)) blocked[(std::size_t)index(c)]++;
+    }
+    relabel();
+}
+
+void TrapDetector::follow(const PackedBody& body) {
+    if (trail.empty() || body.empty()) {
+        assignBody(body);
+        return;
+    }
+    if (!(body.front() == trail.front())) {
+        // One step: the old head is now second
+        if (body.size() < 2 || !(body[1] == trail.front())) {
+            assignBody(body);
+            return;
+        }
+        occupy(body.front());
+        trail.pushFront(body.front());
+    }
+    int steps = 0;
+    while (!trail.empty() && (trail.size() > body.size() || !(trail.back() == body[trail.size() - 1]))) {
+        if (++steps > MAX_TAIL_STEPS) {
+            assignBody(body);
+            return;
+        }
+        release(trail.back());
+        trail.popBack();
+    }
+    while (trail.size() < body.size()) {
+        if (++steps > MAX_TAIL_STEPS) {
+            assignBody(body);
+            return;
+        }
+        Cell c = body[trail.size()];
+        occupy(c);
+        trail.pushBack(c);
+    }
+}
+
+void TrapDetector::occupy(const Cell& c) {
+    if (inside(c)) occupyCell(index(c));
+}
+
+void TrapDetector::release(const Cell& c) {
+    if (inside(c)) releaseCell(index(c));
+}
+
+int TrapDetector::find(int node) const {
+    while (parent[(std::size_t)node] != node) {
+        parent[(std::size_t)node] = parent[(std::size_t)parent[(std::size_t)node]];
+        node = parent[(std::size_t)node];
+    }
+    return node;
+}
+
+int TrapDetector::unite(int a, int b) {
+    if (a == b) return a;
+    if (size[(std::size_t)a] < size[(std::size_t)b]) std::swap(a, b);
+    parent[(std::size_t)b] = a;
+    size[(std::size_t)a] += size[(std::size_t)b];
+    return a;
+}
+
+int TrapDetector::newRegion(int cells) {
+    int node = (int)parent.size();
+    parent.push_back(node);
+    size.push_back(cells);
+    return node;
+}
+
+void TrapDetector::occupyCell(int cell) {
+    if (blocked[(std::size_t)cell] > 0) {
+        blocked[(std::size_t)cell]++;
+        return;
+    }
+    // Regions left behind by unions and splits pile up; start over now and
+    // then, which costs O(board) once per O(board) changes
+    if (parent.size() > 2 * label.size()) relabel();
+    blocked[(std::size_t)cell] = 1;
+    int region = find(label[(std::size_t)cell]);
+    label[(std::size_t)cell] = -1;
+    size[(std::size_t)region]--;
+    split(cell, region);
+}
+
+void TrapDetector::releaseCell(int cell) {
+    if (blocked[(std::size_t)cell] != 1) {
+        if (blocked[(std::size_t)cell] > 1) blocked[(std::size_t)cell]--;
+        return;
+    }
+    if (parent.size() > 2 * label.size()) relabel();
+    blocked[(std::size_t)cell] = 0;
+    Cell c{cell % gridWidth, cell / gridWidth};
+    int around[4];
+    int n = regionsAround(c, around);
+    int region = n > 0 ? around[0] : newRegion(0);
+    for (int i = 1; i < n; ++i) region = unite(region, around[i]);
+    label[(std::size_t)cell] = region;
+    size[(std::size_t)region]++;
+}
+
+void TrapDetector::split(int cell, int region) {
+    int cx = cell % gridWidth, cy = cell / gridWidth;
+    bool open[8];
+    int start = -1;
+    for (int k = 0; k < 8; ++k) {
+        open[k] = isFree({cx + RING[k][0], cy + RING[k][1]});
+        if (!open[k]) start = k;
+    }
+    if (start < 0) return;
+
+    // Going round from a blocked cell, each run of free cells joins the side
+    // neighbours in it; one search starts from each run that has any
+    int seeds[4];
+    int count = 0;
+    bool seeded = false;
+    for (int i = 1; i <= 8; ++i) {
+        int k = (start + i) % 8;
+        if (!open[k]) {
+            seeded = false;
+        } else if (k % 2 == 0 && !seeded) {
+            seeds[count++] = (cy + RING[k][1]) * gridWidth + cx + RING[k][0];
+            seeded = true;
+        }
+    }
+    if (count < 2) return;
+
+    PROFILE_ZONE("TrapDetector::split");
+    if (++stamp == 0) {
+        std::fill(seen.begin(), seen.end(), 0);
+        stamp = 1;
+    }
+    // Searches that meet are on one side: group[] joins them
+    int group[4];
+    std::size_t next[4];
+    for (int s = 0; s < count; ++s) {
+        found[s].assign(1, seeds[s]);
+        next[s] = 0;
+        group[s] = s;
+        seen[(std::size_t)seeds[s]] = stamp;
+        owner[(std::size_t)seeds[s]] = (std::uint8_t)s;
+    }
+    auto groupOf = [&](int s) {
+        while (group[s] != s) s = group[s];
+        return s;
+    };
+    auto running = [&](int g) {
+        for (int s = 0; s < count; ++s) {
+            if (groupOf(s) == g && next[s] < found[s].size()) return true;
+        }
+        return false;
+    };
+
+    int groups = count;
+    int busy = count;
+    while (groups > 1 && busy > 1) {
+        for (int s = 0; s < count; ++s) {
+            if (next[s] == found[s].size()) continue;
+            int c = found[s][next[s]++];
+            int x = c % gridWidth, y = c / gridWidth;
+            const int around[4] = {y > 0 ? c - gridWidth : -1, y + 1 < gridHeight ? c + gridWidth : -1,
+                                   x > 0 ? c - 1 : -1, x + 1 < gridWidth ? c + 1 : -1};
+            for (int n : around) {
+                if (n < 0 || blocked[(std::size_t)n]) continue;
+                if (seen[(std::size_t)n] == stamp) {
+                    int a = groupOf(s), b = groupOf(owner[(std::size_t)n]);
+                    if (a != b) {
+                        group[std::max(a, b)] = std::min(a, b);
+                        groups--;
+                    }
+                    continue;
+                }
+                seen[(std::size_t)n] = stamp;
+                owner[(std::size_t)n] = (std::uint8_t)s;
+                found[s].push_back(n);
+            }
+        }
+        busy = 0;
+        for (int g = 0; g < count; ++g) {
+            if (groupOf(g) == g && running(g)) busy++;
+        }
+    }
+    for (int s = 0; s < count; ++s) cellsSearched += (long)found[s].size();
+    if (groups == 1) return;
+
+    // Every side that ran out is a whole region of its own. The one still
+    // running keeps the old label; if none is, the largest does.
+    int total[4] = {0, 0, 0, 0};
+    for (int s = 0; s < count; ++s) total[groupOf(s)] += (int)found[s].size();
+    int keep = -1;
+    for (int g = 0; g < count; ++g) {
+        if (groupOf(g) != g) continue;
+        if (running(g)) {
+            keep = g;
+            break;
+        }
+        if (keep < 0 || total[g] > total[keep]) keep = g;
+    }
+    for (int g = 0; g < count; ++g) {
+        if (groupOf(g) != g || g == keep) continue;
+        int node = newRegion(total[g]);
+        size[(std::size_t)region] -= total[g];
+        for (int s = 0; s < count; ++s) {
+            if (groupOf(s) != g) continue;
+            for (int c : found[s]) label[(std::size_t)c] = node;
+        }
+    }
+}
+
+// One region per flood-filled area of free cells
+void TrapDetector::relabel() {
+    PROFILE_ZONE("TrapDetector::relabel");
+    parent.clear();
+    size.clear();
+    for (std::size_t i = 0; i < label.size(); ++i) label[i] = blocked[i] ? -1 : -2;
+    std::vector<int>& queue = found[0];
+    for (int seed = 0; seed < (int)label.size(); ++seed) {
+        if (label[(std::size_t)seed] != -2) continue;
+        int node = newRegion(0);
+        label[(std::size_t)seed] = node;
+        queue.assign(1, seed);
+        for (std::size_t i = 0; i < queue.size(); ++i) {
+            int c = queue[i];
+            int x = c % gridWidth, y = c / gridWidth;
+            const int around[4] = {y > 0 ? c - gridWidth : -1, y + 1 < gridHeight ? c + gridWidth : -1,
+                                   x > 0 ? c - 1 : -1, x + 1 < gridWidth ? c + 1 : -1};
+            for (int n : around) {
+                if (n < 0 || label[(std::size_t)n] != -2) continue;
+                label[(std::size_t)n] = node;
+                queue.push_back(n);
+            }
+        }
+        size[(std::size_t)node] = (int)queue.size();
+        cellsSearched += (long)queue.size();
+    }
+}
+
+int TrapDetector::regionsAround(const Cell& c, int out[4]) const {
+    int n = 0;
+    for (int k = 0; k < 8; k += 2) {
+        Cell side{c.x + RING[k][0], c.y + RING[k][1]};
+        if (!isFree(side)) continue;
+        int region = find(label[(std::size_t)index(side)]);
+        if (std::find(out, out + n, region) == out + n) out[n++] = region;
+    }
+    return n;
+}
+
+int TrapDetector::reachableArea(const Cell& head) const {
+    int around[4];
+    int n = regionsAround(head, around);
+    int cells = 0;
+    for (int i = 0; i < n; ++i) cells += size[(std::size_t)around[i]];
+    return cells;
+}
+
+bool TrapDetector::canReach(const Cell& head, const Cell& target) const {
+    if (!isFree(target)) return false;
+    int around[4];
+    int n = regionsAround(head, around);
+    return std::find(around, around + n, find(label[(std::size_t)index(target)])) != around + n;
+}
+
+bool TrapDetector::isTrapped(const Cell& head, const Cell& tail, int length) const {
+    if (reachableArea(head) >= length) return false;
+    // Chasing its own tail
+    if (std::abs(head.x - tail.x) + std::abs(head.y - tail.y) == 1) return false;
+    int fromHead[4], fromTail[4];
+    int n = regionsAround(head, fromHead);
+    int m = regionsAround(tail, fromTail);
+    for (int i = 0; i < m; ++i) {
+        if (std::find(fromHead, fromHead + n, fromTail[i]) != fromHead + n) return false;
+    }
+    return true;
+}
@@ -0,0 +1,119 @@
+#include "BodyCodec.hpp"
+#include <cstdlib>
+
+namespace bodycodec {
+
+namespace {
+
+const Cell STEPS[4] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+
+// -1 when b is not one step from a
+int stepCode(const Cell& a, const Cell& b) {
+    int dx = b.x - a.x, dy = b.y - a.y;
+    if (std::abs(dx) + std::abs(dy) != 1) return -1;
+    return dy < 0 ? 0 : dy > 0 ? 1 : dx < 0 ? 2 : 3;
+}
+
+void put16(std::vector<std::uint8_t>& out, int v) {
+    out.push_back((std::uint8_t)v);
+    out.push_back((std::uint8_t)((unsigned)v >> 8));
+}
+
+void put32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    put16(out, (int)(v & 0xffff));
+    put16(out, (int)(v >> 16));
+}
+
+int get16(const std::uint8_t* p) { return (std::int16_t)(p[0] | p[1] << 8); }
+
+std::uint32_t get32(const std::uint8_t* p) { return (std::uint32_t)(std::uint16_t)get16(p) | (std::uint32_t)(std::uint16_t)get16(p + 2) << 16; }
+
+// Cell vectors and PackedBodies both read as Cells, front to back
+template <typename Body>
+void encodeBody(const Body& body, std::vector<std::uint8_t>& out) {
+    std::size_t n = body.size();
+    // Copies of the tail, then every other segment must be one step on
+    std::size_t copies = 0;
+    while (copies + 1 < n && body[n - 1 - copies] == body[n - 2 - copies]) copies++;
+    std::size_t steps = n == 0 ? 0 : n - 1 - copies;
+
+    std::size_t start = out.size();
+    put32(out, (std::uint32_t)n);
+    if (n > 0) {
+        // Written as a chain in one pass; undone if a segment is not a step
+        Cell prev = body[0];
+        out.push_back(CHAIN);
+        put16(out, prev.x);
+        put16(out, prev.y);
+        put32(out, (std::uint32_t)copies);
+        std::size_t first = out.size();
+        out.resize(first + (steps + 3) / 4, 0);
+        auto it = body.begin();
+        ++it;
+        bool chain = true;
+        for (std::size_t i = 0; i < steps; ++i, ++it) {
+            Cell next = *it;
+            int code = stepCode(prev, next);
+            if (code < 0) {
+                chain = false;
+                break;
+            }
+            out[first + i / 4] |= (std::uint8_t)(code << (2 * (i % 4)));
+            prev = next;
+        }
+        if (chain) return;
+        out.resize(start + 4);
+    }
+    out.push_back(CELLS);
+    for (const Cell& c : body) {
+        put16(out, c.x);
+        put16(out, c.y);
+    }
+}
+
+}
+
+void encode(const std::vector<Cell>& body, std::vector<std::uint8_t>& out) {
+    encodeBody(body, out);
+}
+
+void encode(const PackedBody& body, std::vector<std::uint8_t>& out) {
+    encodeBody(body, out);
+}
+
+std::size_t decode(const std::uint8_t* data, std::size_t size, std::size_t maxSegments, std::vector<Cell>& body) {
+    body.clear();
+    if (size < 5) return 0;
+    std::size_t n = get32(data);
+    if (n > maxSegments) return 0;
+    std::uint8_t format = data[4];
+    const std::uint8_t* p = data + 5;
+    std::size_t left = size - 5;
+
+    if (format == CELLS) {
+        if (left / 4 < n) return 0;
+        body.resize(n);
+        for (std::size_t i = 0; i < n; ++i, p += 4) body[i] = {get16(p), get16(p + 2)};
+        return 5 + 4 * n;
+    }
+    if (format != CHAIN || n == 0 || left < 8) return 0;
+    Cell head{get16(p), get16(p + 2)};
+    // copies < n <= maxSegments keeps what the data does not pay for bounded
+    std::size_t copies = get32(p + 4);
+    if (copies >= n) return 0;
+    std::size_t steps = n - 1 - copies;
+    std::size_t bytes = (steps + 3) / 4;
+    if (left - 8 < bytes) return 0;
+    p += 8;
+
+    body.resize(n);
+    body[0] = head;
+    for (std::size_t i = 0; i < steps; ++i) {
+        const Cell& d = STEPS[(p[i / 4] >> (2 * (i % 4))) & 3];
+        body[i + 1] = {body[i].x + d.x, body[i].y + d.y};
+    }
+    for (std::size_t i = steps + 1; i < n; ++i) body[i] = body[steps];
+    return 5 + 8 + bytes;
+}
+
+}
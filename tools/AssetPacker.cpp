@@ -0,0 +1,139 @@
+// Offline packer: bundles the assets/ tree into a single assets.pak that the
+// game memory-maps at startup (see include/AssetArchive.hpp for the layout).
+//
+//   AssetPacker <assets-dir> <out.pak> [--no-rgba] [--rgba-max-pixels N] [--align N]
+//
+// Images with at most N pixels (default 4096, i.e. 64x64) are stored as raw
+// RGBA8 so the game can upload them to the GPU without decoding.
+#include <SFML/Graphics.hpp>
+#include "AssetArchive.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct PackItem {
+    std::string name;
+    std::vector<char> bytes;
+    pak::Format format = pak::Format::Raw;
+    unsigned width = 0, height = 0;
+};
+
+static bool isImage(const fs::path& p) {
+    std::string ext = p.extension().string();
+    for (char& c : ext) c = (char)std::tolower((unsigned char)c);
+    return ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp" || ext == ".tga";
+}
+
+static std::uint64_t alignUp(std::uint64_t v, std::uint64_t a) {
+    return (v + a - 1) / a * a;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: AssetPacker <assets-dir> <out.pak> [--no-rgba] [--rgba-max-pixels N] [--align N]\n";
+        return 1;
+    }
+    fs::path root = argv[1];
+    std::string outPath = argv[2];
+    bool rgba = true;
+    unsigned rgbaMaxPixels = 64 * 64;
+    std::uint32_t alignment = pak::DEFAULT_ALIGNMENT;
+    for (int i = 3; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--no-rgba") rgba = false;
+        else if (a == "--rgba-max-pixels" && i + 1 < argc) rgbaMaxPixels = (unsigned)std::stoul(argv[++i]);
+        else if (a == "--align" && i + 1 < argc) alignment = (std::uint32_t)std::stoul(argv[++i]);
+        else { std::cerr << "unknown option: " << a << "\n"; return 1; }
+    }
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        std::cerr << "--align must be a power of two\n";
+        return 1;
+    }
+
+    std::vector<PackItem> items;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file()) continue;
+        PackItem item;
+        item.name = fs::relative(it->path(), root).generic_string();
+        if (item.name.size() >= pak::NAME_SIZE) {
+            std::cerr << "name too long for the index, skipped: " << item.name << "\n";
+            continue;
+        }
+
+        // Pre-decoded sizes are 16-bit in the index; anything larger stays encoded
+        sf::Image img;
+        if (rgba && isImage(it->path()) && img.loadFromFile(it->path().string()) &&
+            img.getSize().x <= 0xFFFF && img.getSize().y <= 0xFFFF &&
+            (std::uint64_t)img.getSize().x * img.getSize().y <= rgbaMaxPixels) {
+            const char* px = (const char*)img.getPixelsPtr();
+            item.bytes.assign(px, px + (std::size_t)img.getSize().x * img.getSize().y * 4);
+            item.format = pak::Format::RGBA8;
+            item.width = img.getSize().x;
+            item.height = img.getSize().y;
+        } else {
+            std::ifstream in(it->path(), std::ios::binary);
+            item.bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        items.push_back(std::move(item));
+    }
+    if (ec) {
+        std::cerr << "cannot read " << root << ": " << ec.message() << "\n";
+        return 1;
+    }
+    // The runtime binary-searches the index by name
+    std::sort(items.begin(), items.end(), [](const PackItem& a, const PackItem& b) { return a.name < b.name; });
+
+    std::vector<pak::Entry> index(items.size());
+    std::uint64_t cursor = alignUp(sizeof(pak::Header) + index.size() * sizeof(pak::Entry), alignment);
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        pak::Entry& e = index[i];
+        std::memset(&e, 0, sizeof(e));
+        std::memcpy(e.name, items[i].name.c_str(), items[i].name.size());
+        e.offset = cursor;
+        e.size = items[i].bytes.size();
+        e.format = (std::uint32_t)items[i].format;
+        e.width = (std::uint16_t)items[i].width;
+        e.height = (std::uint16_t)items[i].height;
+        cursor = alignUp(cursor + e.size, alignment);
+    }
+
+    pak::Header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, pak::MAGIC, 4);
+    h.version = pak::VERSION;
+    h.entryCount = (std::uint32_t)index.size();
+    h.alignment = alignment;
+    h.indexOffset = sizeof(pak::Header);
+    h.fileSize = cursor;
+
+    std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "cannot write " << outPath << "\n";
+        return 1;
+    }
+    out.write((const char*)&h, sizeof(h));
+    out.write((const char*)index.data(), (std::streamsize)(index.size() * sizeof(pak::Entry)));
+    std::vector<char> zeros(alignment, 0);
+    std::uint64_t written = sizeof(h) + index.size() * sizeof(pak::Entry);
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        out.write(zeros.data(), (std::streamsize)(index[i].offset - written));
+        out.write(items[i].bytes.data(), (std::streamsize)items[i].bytes.size());
+        written = index[i].offset + items[i].bytes.size();
+        std::cout << (index[i].format == (std::uint32_t)pak::Format::RGBA8 ? "  rgba " : "  raw  ")
+                  << items[i].name << " (" << items[i].bytes.size() << " bytes)\n";
+    }
+    out.write(zeros.data(), (std::streamsize)(cursor - written));
+    if (!out) {
+        std::cerr << "write failed: " << outPath << "\n";
+        return 1;
+    }
+    std::cout << "Packed " << items.size() << " assets into " << outPath << " (" << cursor << " bytes)\n";
+    return 0;
+}
@@ -0,0 +1,779 @@
+// Micro-benchmarks for the core game operations (make bench).
+//
+//   Benchmark [out.json] [--reps N] [--filter TEXT] [--label TEXT]
+//
+// Every case is calibrated to a batch of at least ~2 ms, then timed --reps
+// times (default 15); the table and the JSON report ns/op as median, min,
+// mean and standard deviation. Compare the JSON of two commits to spot
+// regressions. Render cases draw into an off-screen sf::RenderTexture and are
+// skipped when no GL context can be created.
+#include <SFML/Graphics.hpp>
+#include "GameLogic.hpp"
+#include "AssetManager.hpp"
+#include "Arena.hpp"
+#include "GymEnv.hpp"
+#include "HamiltonSolver.hpp"
+#include "TranspositionTable.hpp"
+#include "TrapDetector.hpp"
+#include "Barrier.hpp"
+#include "BodyCodec.hpp"
+#include "Snake.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+// Private hooks into GameLogic (declared friend in GameLogic.hpp)
+struct BenchAccess {
+    static void setBody(GameLogic& g, const std::vector<Cell>& body) { g.snake.setBody(body); }
+    static void clearFruits(GameLogic& g) { g.fruits.clear(); }
+    static void spawnFood(GameLogic& g) { g.spawnFood(); }
+    static std::size_t fruitCount(const GameLogic& g) { return g.fruits.size(); }
+    static Barrier& barriers(GameLogic& g) { return g.barriers; }
+    static Barrier& wallView(GameLogic& g) { return g.wallView; }
+    static void publish(GameLogic& g) { g.publishSnapshot(); }
+    static std::mt19937& rng(GameLogic& g) { return g.rng; }
+    static bool findPortalExit(GameLogic& g, int len, int& ex, int& ey, std::vector<Cell>& area) {
+        return g.findPortalExit(len, ex, ey, area);
+    }
+    // Rendering only sees published state
+    static void enterPlay(GameLogic& g) {
+        g.state = GameState::Playing;
+        g.showCountdown = false;
+        g.publishSnapshot();
+        g.consumeSnapshot();
+    }
+};
+
+namespace {
+
+template <typename T>
+void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct Result {
+    std::string name;
+    long long param;
+    long long iterations;
+    int reps;
+    double median, min, mean, stddev; // ns/op
+};
+
+struct Options {
+    std::string out = "bench_results.json";
+    std::string filter;
+    std::string label;
+    int reps = 15;
+};
+
+Options opts;
+bool fillFailed = false; // an autopilot fill run died short of a full board
+std::vector<Result> results;
+
+using Clock = std::chrono::steady_clock;
+
+double timeBatch(const std::function<void(long long)>& batch, long long iters) {
+    auto t0 = Clock::now();
+    batch(iters);
+    return std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+}
+
+// batch(n) must run the operation n times; setup() runs untimed before each batch
+void bench(const std::string& name, long long param, const std::function<void(long long)>& batch,
+           const std::function<void()>& setup = [] {}) {
+    if (!opts.filter.empty() && name.find(opts.filter) == std::string::npos) return;
+
+    long long iters = 1;
+    double t = 0.0;
+    while (true) {
+        setup();
+        t = timeBatch(batch, iters);
+        if (t >= 2e6 || iters >= (1LL << 24)) break;
+        iters *= t < 2e5 ? 8 : 2;
+    }
+    // Slow cases (big map generation) get fewer reps, never fewer than 3
+    int reps = std::max(3, std::min(opts.reps, (int)(2e9 / std::max(t, 1.0))));
+
+    std::vector<double> samples;
+    for (int r = 0; r < reps; ++r) {
+        setup();
+        samples.push_back(timeBatch(batch, iters) / (double)iters);
+    }
+    std::sort(samples.begin(), samples.end());
+    double mean = 0.0;
+    for (double s : samples) mean += s;
+    mean /= samples.size();
+    double var = 0.0;
+    for (double s : samples) var += (s - mean) * (s - mean);
+    double stddev = samples.size() > 1 ? std::sqrt(var / (samples.size() - 1)) : 0.0;
+    double median = samples[samples.size() / 2];
+
+    results.push_back({name, param, iters, reps, median, samples.front(), mean, stddev});
+    std::printf("%-34s %8lld %14.1f %14.1f %10.1f  (x%lld, %d reps)\n", name.c_str(), param, median,
+                samples.front(), stddev, iters, reps);
+    std::fflush(stdout);
+}
+
+std::vector<Cell> straightBody(int length, int x, int y) {
+    std::vector<Cell> body((std::size_t)length);
+    for (int i = 0; i < length; ++i) body[(std::size_t)i] = {x, y + i};
+    return body;
+}
+
+// Boustrophedon fill of the playable interior, head first
+std::vector<Cell> serpentineBody(int gridW, int gridH, int length) {
+    std::vector<Cell> body;
+    for (int y = 1; y < gridH - 1 && (int)body.size() < length; ++y) {
+        for (int i = 1; i < gridW - 1 && (int)body.size() < length; ++i) {
+            int x = (y % 2) ? i : gridW - 1 - i;
+            body.push_back({x, y});
+        }
+    }
+    return body;
+}
+
+void benchSnake() {
+    for (int len : {3, 100, 1000, 10000, 100000}) {
+        Snake snake(0, 0, sf::Color::Green);
+        bench("Snake::update", len, [&](long long n) {
+            for (long long i = 0; i < n; ++i) snake.update();
+            keep(snake.getHead());
+        }, [&] { snake.setBody(straightBody(len, 0, 0)); });
+
+        // grow() appends a segment; shrinkTo() puts the length back so every op sees `len`
+        bench("Snake::grow (+shrinkTo)", len, [&](long long n) {
+            for (long long i = 0; i < n; ++i) { snake.grow(); snake.shrinkTo(len); }
+            keep(snake.getBody().size());
+        }, [&] { snake.setBody(straightBody(len, 0, 0)); });
+    }
+}
+
+void benchCollision() {
+    std::mt19937 rng(1234);
+    for (int count : {236, 1000, 3600, 14400}) {
+        Barrier barrier(0, 0, 59, 59);
+        std::uniform_int_distribution<int> coord(0, 119);
+        std::vector<Cell> walls;
+        for (int i = 0; i < count; ++i) walls.push_back({coord(rng), coord(rng)});
+        barrier.setWalls(walls);
+        std::vector<Cell> queries(1024);
+        for (auto& q : queries) q = {coord(rng), coord(rng)};
+        bench("Barrier::checkCollision", count, [&](long long n) {
+            int hits = 0;
+            for (long long i = 0; i < n; ++i) hits += barrier.checkCollision(queries[(std::size_t)(i & 1023)]);
+            keep(hits);
+        });
+    }
+}
+
+void benchGenerate() {
+    for (int size : {20, 40, 60, 120}) {
+        Barrier barrier(0, 0, size - 1, size - 1);
+        std::mt19937 rng(42);
+        std::vector<Cell> forbidden = straightBody(3, size / 2, size / 2);
+        bench("Barrier::generateRandom", size, [&](long long n) {
+            for (long long i = 0; i < n; ++i) barrier.generateRandom(rng, size, size, forbidden);
+            keep(barrier.getWalls().size());
+        });
+    }
+}
+
+void benchGame(GameLogic& game, int grid) {
+    // Fruit placement with most of the interior covered by the snake
+    BenchAccess::barriers(game).setWalls({});
+    int interior = (grid - 2) * (grid - 2);
+    for (int pct : {50, 90, 99}) {
+        std::vector<Cell> body = serpentineBody(grid, grid, interior * pct / 100);
+        BenchAccess::setBody(game, body);
+        bench("spawnFood (board % full)", pct, [&](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                BenchAccess::clearFruits(game);
+                BenchAccess::spawnFood(game);
+            }
+            keep(BenchAccess::fruitCount(game));
+        });
+    }
+
+    // Portal exit search on a generated map, by snake length
+    BenchAccess::setBody(game, straightBody(3, grid / 2, grid / 2));
+    BenchAccess::barriers(game).generateRandom(BenchAccess::rng(game), grid, grid, straightBody(3, grid / 2, grid / 2));
+    std::vector<Cell> area;
+    for (int len : {5, 20, 50}) {
+        bench("portal exit search", len, [&](long long n) {
+            int ex = 0, ey = 0;
+            for (long long i = 0; i < n; ++i) BenchAccess::findPortalExit(game, len, ex, ey, area);
+            keep(ex);
+            keep(area.size());
+        });
+    }
+
+    // Copying the world into the triple buffer, once per simulation change
+    for (int len : {20, 500, 2000}) {
+        BenchAccess::setBody(game, serpentineBody(grid, grid, len));
+        bench("publishSnapshot", len, [&](long long n) {
+            for (long long i = 0; i < n; ++i) BenchAccess::publish(game);
+        });
+    }
+}
+
+// Full arena ticks (decisions on the JobSystem, moves, collisions, fruit)
+void benchArena() {
+    for (int count : {100, 500, 1000}) {
+        int side = Arena::boardSideFor(count);
+        Arena arena(side, side, count, 1234);
+        for (int i = 0; i < 50; ++i) arena.tick(); // let bodies grow and fruit spread
+        bench("Arena::tick (snakes)", count, [&](long long n) {
+            for (long long i = 0; i < n; ++i) arena.tick();
+            keep(arena.getAliveCount());
+        });
+    }
+}
+
+// Random walk that avoids walls and itself; episodes end on the fruit timer
+int gymAction(const GymEnv& env, std::uint32_t& rng) {
+    static const Cell DIRS[4] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+    rng = rng * 1664525u + 1013904223u;
+    int first = (int)(rng >> 30);
+    Cell h = env.getHead();
+    for (int k = 0; k < 4; ++k) {
+        int a = (first + k) & 3;
+        if (env.isFree(h.x + DIRS[a].x, h.y + DIRS[a].y)) return a;
+    }
+    return first;
+}
+
+// Training throughput with the observation planes bound; resets are included
+// as they come (one per episode)
+void benchGym() {
+    for (int side : {20, 60, 128}) {
+        GymEnv env(side, side);
+        std::vector<std::uint8_t> planes(env.observationSize());
+        env.bindObservation(planes.data());
+        std::uint32_t seed = 1, rng = 1;
+        env.reset(seed);
+        bench("GymEnv::step (episodes)", side, [&](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                if (env.isDone()) env.reset(++seed);
+                env.step(gymAction(env, rng));
+            }
+            keep(planes);
+        });
+    }
+    GymEnv env(60, 60);
+    std::uint32_t seed = 1;
+    bench("GymEnv::reset", 60, [&](long long n) {
+        for (long long i = 0; i < n; ++i) env.reset(++seed);
+        keep(env);
+    });
+}
+
+// Points gained over the next `depth` moves, best case; dying costs 100.
+// Every node saves its position once and loads it back before each move.
+float lookahead(GymEnv& env, std::vector<GymEnv::State>& states, TranspositionTable* table, int depth) {
+    if (depth == 0 || env.isDone()) return 0.f;
+    TranspositionTable::Entry entry;
+    std::uint64_t key = env.getHash();
+    if (table && table->probe(key, entry) && entry.depth >= depth) return entry.value;
+    GymEnv::State& here = states[(std::size_t)depth];
+    env.saveState(here);
+    float best = -1e9f;
+    int bestAction = 0;
+    for (int a = 0; a < 4; ++a) {
+        if (a > 0) env.loadState(here);
+        GymEnv::Step step = env.step(a);
+        float value = step.reward;
+        if (step.done && step.end != GymEnv::End::FruitTimer) value -= 100.f;
+        else value += lookahead(env, states, table, depth - 1);
+        if (value > best) {
+            best = value;
+            bestAction = a;
+        }
+    }
+    env.loadState(here);
+    if (table) {
+        entry.value = best;
+        entry.depth = depth;
+        entry.bound = TranspositionTable::Bound::Exact;
+        entry.action = bestAction;
+        table->store(key, entry);
+    }
+    return best;
+}
+
+// Position copies for rollouts, the shared table, and whole searches with
+// and without it (reversing moves and move orders that meet are hits)
+void benchSearch() {
+    GymEnv env(60, 60);
+    env.reset(3);
+    std::uint32_t rng = 3;
+    for (int i = 0; i < 200 && !env.isDone(); ++i) env.step(gymAction(env, rng));
+    bench("GymEnv copy (whole env)", 60, [&](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            GymEnv copy(env);
+            keep(copy);
+        }
+    });
+    GymEnv::State state;
+    GymEnv rollout(60, 60);
+    rollout.reset(4);
+    bench("GymEnv::saveState+loadState", 60, [&](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            env.saveState(state);
+            rollout.loadState(state);
+        }
+        keep(rollout.getHash());
+    });
+
+    TranspositionTable table(16);
+    std::vector<std::uint64_t> keys(4096);
+    for (std::size_t i = 0; i < keys.size(); ++i) keys[i] = GymEnv::Random::mix(i + 1);
+    bench("TranspositionTable store+probe", (long long)table.getSlots(), [&](long long n) {
+        TranspositionTable::Entry e;
+        int found = 0;
+        for (long long i = 0; i < n; ++i) {
+            std::uint64_t key = keys[(std::size_t)(i & 4095)];
+            e.depth = (int)(i & 7);
+            table.store(key, e);
+            found += table.probe(key ^ 1, e) ? 1 : 0;
+        }
+        keep(found);
+    });
+
+    std::vector<GymEnv::State> states(8);
+    TranspositionTable small(1);
+    for (int depth : {5, 7}) {
+        bench("lookahead search (no table)", depth, [&](long long n) {
+            float v = 0.f;
+            for (long long i = 0; i < n; ++i) v += lookahead(env, states, nullptr, depth);
+            keep(v);
+        });
+        bench("lookahead search (table)", depth, [&](long long n) {
+            float v = 0.f;
+            for (long long i = 0; i < n; ++i) {
+                small.clear();
+                v += lookahead(env, states, &small, depth);
+            }
+            keep(v);
+        });
+    }
+}
+
+// The autopilot's move as a GymEnv action; rebuilds the cycle on new walls
+int autopilotAction(const GymEnv& env, HamiltonSolver& solver, unsigned& wallsVersion, std::vector<Cell>& goals) {
+    if (env.getMapVersion() != wallsVersion) {
+        wallsVersion = env.getMapVersion();
+        solver.build(env.getWalls(), env.getHead());
+    }
+    goals.clear();
+    const Portal& entrance = env.getEntrance();
+    if (entrance.active) goals.push_back({entrance.x, entrance.y});
+    else for (const Fruit& f : env.getFruits()) goals.push_back({f.x, f.y});
+    HamiltonSolver::SnakeState snake;
+    snake.head = env.getHead();
+    snake.tail = env.getTail();
+    snake.direction = env.getDirection();
+    snake.length = env.getBodyLength();
+    snake.growPending = env.getGrowPending();
+    Cell next = solver.nextMove(snake, goals, entrance.active, [&](const Cell& c) {
+        return !env.isFree(c.x, c.y) && !(entrance.active && c.x == entrance.x && c.y == entrance.y);
+    });
+    int dx = next.x - snake.head.x, dy = next.y - snake.head.y;
+    return dy < 0 ? GymEnv::ACTION_UP : dy > 0 ? GymEnv::ACTION_DOWN : dx < 0 ? GymEnv::ACTION_LEFT : GymEnv::ACTION_RIGHT;
+}
+
+// Hamiltonian cycles on generated maps: a solver's first build, the rebuild
+// after a portal (which keeps what it can of the old cycle), and whole
+// autopilot episodes, portals and map generation included. The portal
+// countdown gives a rebuild 3 s.
+void benchHamilton() {
+    for (int side : {60, 128, 512}) {
+        Barrier barrier(2, 2, side - 3, side - 3);
+        std::mt19937 rng(7);
+        std::vector<std::vector<Cell>> maps;
+        for (int i = 0; i < 4; ++i) {
+            barrier.generateRandom(rng, side, side, straightBody(3, side / 2, side / 2));
+            maps.push_back(barrier.getWalls());
+        }
+        Cell start{side / 2, side / 2};
+        bench("HamiltonSolver::build (first)", side, [&](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                HamiltonSolver solver(side, side);
+                solver.build(maps[(std::size_t)(i & 3)], start);
+                keep(solver.getCycleLength());
+            }
+        });
+        HamiltonSolver solver(side, side);
+        long long cycle = 0, freeCells = 0;
+        bench("HamiltonSolver::build (new map)", side, [&](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                solver.build(maps[(std::size_t)(i & 3)], start);
+                cycle += solver.getCycleLength();
+                freeCells += solver.getFreeCells();
+            }
+        });
+        if (freeCells > 0) std::printf("  cycle covers %.1f%% of the free cells\n", 100.0 * (double)cycle / (double)freeCells);
+    }
+
+    for (int side : {20, 60}) {
+        GymEnv env(side, side);
+        HamiltonSolver solver(side, side);
+        std::vector<Cell> goals;
+        unsigned wallsVersion = 0;   // reset() moves the map past version 0
+        std::uint32_t seed = 1;
+        env.reset(seed);
+        bench("GymEnv::step (autopilot)", side, [&](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                if (env.isDone()) env.reset(++seed);
+                env.step(autopilotAction(env, solver, wallsVersion, goals));
+            }
+        });
+    }
+}
+
+// Endurance check for the autopilot: one snake on a wall-free board, a
+// single fruit at a time, until the board is full. Returns the cells the
+// body covered when the game ended; area means the board was filled.
+int fillBoard(int width, int height, int growth, std::uint32_t seed) {
+    HamiltonSolver solver(width, height);
+    solver.build({}, {width / 2, height / 2});
+    std::mt19937 rng(seed);
+    std::vector<std::uint8_t> occupied((std::size_t)(width * height), 0);
+    std::deque<Cell> body;
+    for (int i = 0; i < 3; ++i) {
+        body.push_back({width / 2, height / 2 + i});
+        occupied[(std::size_t)((height / 2 + i) * width + width / 2)] = 1;
+    }
+    Cell direction{0, -1};
+    int growPending = 0;
+    auto isBody = [&](const Cell& c) { return occupied[(std::size_t)(c.y * width + c.x)] != 0; };
+    std::vector<Cell> goals(1);
+    auto spawn = [&] {
+        std::vector<int> free;
+        for (int i = 0; i < width * height; ++i) {
+            if (!occupied[(std::size_t)i]) free.push_back(i);
+        }
+        if (free.empty()) return false;
+        int cell = free[rng() % free.size()];
+        goals[0] = {cell % width, cell / width};
+        return true;
+    };
+    spawn();
+    // A fruit every area ticks at least, or the autopilot is going round in circles
+    long long sinceFruit = 0;
+    while (sinceFruit++ < (long long)width * height * 4) {
+        HamiltonSolver::SnakeState snake;
+        snake.head = body.front();
+        snake.tail = body.back();
+        snake.direction = direction;
+        snake.length = (int)body.size();
+        snake.growPending = growPending;
+        Cell next = solver.nextMove(snake, goals, false, isBody);
+        Cell step{next.x - snake.head.x, next.y - snake.head.y};
+        if (std::abs(step.x) + std::abs(step.y) != 1 || next.x < 0 || next.y < 0 || next.x >= width || next.y >= height) break;
+        // The tail moves first unless the snake is growing
+        if (growPending > 0) {
+            growPending--;
+        } else {
+            occupied[(std::size_t)(body.back().y * width + body.back().x)] = 0;
+            body.pop_back();
+        }
+        if (isBody(next)) break;
+        occupied[(std::size_t)(next.y * width + next.x)] = 1;
+        body.push_front(next);
+        direction = step;
+        if (next == goals[0]) {
+            // Growth stops at a full board
+            growPending = std::min(growPending + growth, width * height - (int)body.size());
+            sinceFruit = 0;
+            if (!spawn()) return (int)body.size();
+        }
+    }
+    return (int)body.size();
+}
+
+// Fill-the-board runs on small boards with Complete cycles, where a
+// shortcut taken too late shows up as a death a few cells short of full
+void benchFill() {
+    const int boards[][2] = {{8, 14}, {8, 20}, {18, 22}};
+    for (const auto& b : boards) {
+        int area = b[0] * b[1];
+        for (int growth : {1, 3}) {
+            int games = 0, filled = 0, worst = area;
+            std::uint32_t seed = 0;
+            bench("autopilot fill (" + std::to_string(b[0]) + "x" + std::to_string(b[1]) + ", +" + std::to_string(growth) + ")",
+                  area, [&](long long n) {
+                      for (long long i = 0; i < n; ++i) {
+                          int cells = fillBoard(b[0], b[1], growth, ++seed);
+                          games++;
+                          filled += cells >= area ? 1 : 0;
+                          worst = std::min(worst, cells);
+                      }
+                  });
+            if (games > 0) {
+                std::printf("  filled %d of %d games%s (worst %d of %d cells)\n", filled, games,
+                            filled == games ? "" : " FAILED", worst, area);
+                if (filled != games) fillFailed = true;
+            }
+        }
+    }
+}
+
+// Tick throughput of GymEnv::step on its Board<W, H> specialisation and on
+// the run-time sized fallback: the same recorded autopilot game is replayed
+// from a saved start, up to its first portal, so neither resets, map
+// generation nor steering are timed
+void benchBoard() {
+    for (int side : {20, 60, 128}) {
+        GymEnv env(side, side);
+        std::vector<std::uint8_t> planes(env.observationSize());
+        env.bindObservation(planes.data());
+        env.reset(3);
+        GymEnv::State start;
+        env.saveState(start);
+        std::vector<int> actions;
+        HamiltonSolver solver(side, side);
+        std::vector<Cell> goals;
+        unsigned wallsVersion = 0;
+        while (!env.isDone() && !env.getEntrance().active && actions.size() < 20000) {
+            actions.push_back(autopilotAction(env, solver, wallsVersion, goals));
+            env.step(actions.back());
+        }
+        for (bool generic : {false, true}) {
+            env.useGenericBoard(generic);
+            env.loadState(start);
+            std::size_t at = 0;
+            bench(generic ? "GymEnv::step (generic board)" : "GymEnv::step (Board<W, H>)", side, [&](long long n) {
+                for (long long i = 0; i < n; ++i) {
+                    if (at == actions.size()) {
+                        env.loadState(start);
+                        at = 0;
+                    }
+                    env.step(actions[at++]);
+                }
+                keep(planes);
+            });
+        }
+    }
+}
+
+// The reachable area from the head along recorded autopilot games on 60x60
+// (snakes of a few thousand cells, portals included): the incremental
+// detector against a flood fill from the head every tick
+void benchTraps() {
+    const int side = 60;
+    struct Tick {
+        Cell head, tail;
+        int length;
+        int map;
+    };
+    std::vector<Tick> ticks;
+    std::vector<std::vector<Cell>> maps;
+    {
+        GymEnv env(side, side);
+        HamiltonSolver solver(side, side);
+        std::vector<Cell> goals;
+        unsigned wallsVersion = 0, mapVersion = 0;
+        std::uint32_t seed = 1;
+        env.reset(seed);
+        while (ticks.size() < 100000) {
+            if (env.isDone()) env.reset(++seed);
+            if (env.getMapVersion() != mapVersion) {
+                mapVersion = env.getMapVersion();
+                maps.push_back(env.getWalls());
+            }
+            ticks.push_back({env.getHead(), env.getTail(), env.getBodyLength(), (int)maps.size() - 1});
+            env.step(autopilotAction(env, solver, wallsVersion, goals));
+        }
+    }
+    // A new map starts with a straight body below the head (reset: three
+    // cells, portal exit: the head alone); otherwise the head moved one cell
+    // and the tail followed unless the snake grew
+    auto replay = [&](std::size_t i, auto&& restart, auto&& occupy, auto&& release) {
+        const Tick& t = ticks[i];
+        if (i == 0 || t.map != ticks[i - 1].map) {
+            restart(maps[(std::size_t)t.map], straightBody(t.length, t.head.x, t.head.y));
+            return;
+        }
+        if (t.length == ticks[i - 1].length) release(ticks[i - 1].tail);
+        occupy(t.head);
+    };
+
+    TrapDetector traps(side, side);
+    std::size_t at = 0;
+    long long ticksRun = 0;
+    long searchedBefore = traps.getCellsSearched();
+    bench("TrapDetector (per tick)", side, [&](long long n) {
+        for (long long k = 0; k < n; ++k, ++ticksRun) {
+            std::size_t i = at++ % ticks.size();
+            replay(i, [&](const std::vector<Cell>& walls, const std::vector<Cell>& body) { traps.reset(walls, body); },
+                   [&](const Cell& c) { traps.occupy(c); }, [&](const Cell& c) { traps.release(c); });
+            keep(traps.reachableArea(ticks[i].head));
+        }
+    });
+    if (ticksRun > 0) {
+        std::printf("  %.1f cells searched per tick\n", (double)(traps.getCellsSearched() - searchedBefore) / (double)ticksRun);
+    }
+
+    std::vector<std::uint16_t> blocked((std::size_t)(side * side), 0);
+    std::vector<std::uint32_t> seen((std::size_t)(side * side), 0);
+    std::vector<int> queue;
+    std::uint32_t stamp = 0;
+    at = 0;
+    bench("flood fill (per tick)", side, [&](long long n) {
+        for (long long k = 0; k < n; ++k) {
+            std::size_t i = at++ % ticks.size();
+            replay(i,
+                   [&](const std::vector<Cell>& walls, const std::vector<Cell>& body) {
+                       std::fill(blocked.begin(), blocked.end(), 0);
+                       for (const Cell& c : walls) blocked[(std::size_t)(c.y * side + c.x)] = 1;
+                       for (const Cell& c : body) {
+                           if (c.y < side) blocked[(std::size_t)(c.y * side + c.x)]++;
+                       }
+                   },
+                   [&](const Cell& c) { blocked[(std::size_t)(c.y * side + c.x)]++; },
+                   [&](const Cell& c) { blocked[(std::size_t)(c.y * side + c.x)]--; });
+            stamp++;
+            queue.clear();
+            int h = ticks[i].head.y * side + ticks[i].head.x;
+            seen[(std::size_t)h] = stamp;
+            queue.push_back(h);
+            for (std::size_t q = 0; q < queue.size(); ++q) {
+                int c = queue[q];
+                int x = c % side, y = c / side;
+                const int next[4] = {y > 0 ? c - side : -1, y + 1 < side ? c + side : -1,
+                                     x > 0 ? c - 1 : -1, x + 1 < side ? c + 1 : -1};
+                for (int m : next) {
+                    if (m < 0 || blocked[(std::size_t)m] || seen[(std::size_t)m] == stamp) continue;
+                    seen[(std::size_t)m] = stamp;
+                    queue.push_back(m);
+                }
+            }
+            keep(queue.size() - 1);
+        }
+    });
+}
+
+// Saved-game / keyframe body encoding of very long snakes
+void benchCodec() {
+    const int side = 1002;
+    for (int len : {1000, 100000, 1000000}) {
+        std::vector<Cell> body = serpentineBody(side, side, len);
+        std::vector<std::uint8_t> bytes;
+        bench("bodycodec::encode", len, [&](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                bytes.clear();
+                bodycodec::encode(body, bytes);
+                keep(bytes.size());
+            }
+        });
+        std::vector<Cell> decoded;
+        bench("bodycodec::decode", len, [&](long long n) {
+            for (long long i = 0; i < n; ++i) keep(bodycodec::decode(bytes.data(), bytes.size(), body.size(), decoded));
+        });
+        if (!bytes.empty()) std::printf("  %.3f bytes per segment (Cell: %zu)\n", (double)bytes.size() / (double)len, sizeof(Cell));
+    }
+}
+
+void benchRender(GameLogic& game, int grid, int blockSize) {
+    sf::RenderTexture target;
+    if (!target.create((unsigned)(grid * blockSize), (unsigned)(grid * blockSize))) {
+        std::printf("render: no off-screen GL context, skipping render cases\n");
+        return;
+    }
+    BenchAccess::setBody(game, straightBody(20, grid / 2, grid / 2 - 10));
+    BenchAccess::enterPlay(game);
+    // The textured, render-side copy of the walls
+    Barrier& barriers = BenchAccess::wallView(game);
+    bench("Barrier::draw", (long long)barriers.getWalls().size(), [&](long long n) {
+        for (long long i = 0; i < n; ++i) barriers.draw(target, blockSize);
+        target.display();
+    });
+    Snake snake(0, 0, sf::Color::Green);
+    for (int len : {20, 500}) {
+        snake.setBody(serpentineBody(grid, grid, len));
+        bench("Snake::draw (fallback)", len, [&](long long n) {
+            for (long long i = 0; i < n; ++i) snake.draw(target, blockSize);
+            target.display();
+        });
+    }
+    bench("GameLogic::draw (playing)", grid, [&](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            target.clear();
+            game.draw(target);
+        }
+        target.display();
+    });
+}
+
+void writeJson() {
+    std::FILE* f = std::fopen(opts.out.c_str(), "w");
+    if (!f) {
+        std::fprintf(stderr, "Could not write %s\n", opts.out.c_str());
+        return;
+    }
+    std::fprintf(f, "{\n  \"label\": \"%s\",\n  \"unit\": \"ns/op\",\n  \"results\": [", opts.label.c_str());
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(f, "%s\n    {\"name\": \"%s\", \"param\": %lld, \"iterations\": %lld, \"reps\": %d, "
+                        "\"median\": %.2f, \"min\": %.2f, \"mean\": %.2f, \"stddev\": %.2f}",
+                     i ? "," : "", r.name.c_str(), r.param, r.iterations, r.reps, r.median, r.min, r.mean, r.stddev);
+    }
+    std::fprintf(f, "\n  ]\n}\n");
+    std::fclose(f);
+    std::printf("Wrote %zu results to %s\n", results.size(), opts.out.c_str());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--reps" && i + 1 < argc) opts.reps = std::max(3, std::atoi(argv[++i]));
+        else if (a == "--filter" && i + 1 < argc) opts.filter = argv[++i];
+        else if (a == "--label" && i + 1 < argc) opts.label = argv[++i];
+        else if (!a.empty() && a[0] != '-') opts.out = a;
+        else {
+            std::fprintf(stderr, "usage: Benchmark [out.json] [--reps N] [--filter TEXT] [--label TEXT]\n");
+            return 1;
+        }
+    }
+
+    const int grid = 60, blockSize = 16;
+    // Built before the table so asset loading messages stay out of it
+    GameLogic game(grid, grid, blockSize);
+    AssetManager::instance().finishLoading();
+
+    std::printf("%-34s %8s %14s %14s %10s\n", "benchmark", "param", "median ns/op", "min ns/op", "stddev");
+    benchSnake();
+    benchCollision();
+    benchGenerate();
+    benchGame(game, grid);
+    benchArena();
+    benchGym();
+    benchHamilton();
+    benchFill();
+    benchSearch();
+    benchTraps();
+    benchBoard();
+    benchCodec();
+    benchRender(game, grid, blockSize);
+    writeJson();
+    // The fill runs are a correctness check as well as a timing
+    if (fillFailed) {
+        std::fprintf(stderr, "Benchmark: autopilot fill FAILED\n");
+        return 1;
+    }
+    return 0;
+}
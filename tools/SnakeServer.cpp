@@ -0,0 +1,144 @@
+// Headless authoritative server for LAN games (make server / make server-load).
+//
+//   SnakeServer [--port N] [--players N] [--bots N] [--tick-ms N]
+//               [--rooms N [--workers N] [--load CLIENTS] [--seconds S]]
+//
+// Players join with SNAKE_CONNECT=host[:port][/room] ./bin/Snake.exe; free
+// player slots are played by the AI. Without --rooms one game runs on this
+// thread (portable). With --rooms the epoll RoomServer hosts that many
+// independent rooms (Linux), --load adds simulated clients over loopback, and
+// ticks/s, p99 tick latency and memory per room are printed every 2 s.
+// Ctrl+C stops the server and tells clients.
+#include "NetServer.hpp"
+#include "RoomServer.hpp"
+#include "LoadGenerator.hpp"
+#include "Log.hpp"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+static std::atomic<bool> running(true);
+
+static void onSignal(int) {
+    running = false;
+}
+
+// Resident set size in bytes (Linux), 0 elsewhere
+static std::size_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    std::size_t pages = 0, resident = 0;
+    if (!(statm >> pages >> resident)) return 0;
+    return resident * 4096;
+}
+
+static int runRooms(const RoomServer::Config& config, int loadClients, int seconds) {
+    RoomServer server(config);
+    if (!server.start()) return 1;
+    std::thread network([&] { server.run(running); });
+
+    LoadGenerator load(config.port, loadClients, config.rooms, config.tickSeconds);
+    if (loadClients > 0) {
+        // Thousands of joins would flood the console
+        Log::setLevel(LogLevel::Warn);
+        if (load.start()) std::cout << "Load: " << load.getClientCount() << " clients on loopback" << std::endl;
+    }
+
+    const float REPORT_SECONDS = 2.f;
+    auto started = std::chrono::steady_clock::now();
+    auto lastReport = started;
+    std::size_t rssBefore = residentBytes();
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        auto now = std::chrono::steady_clock::now();
+        float elapsed = std::chrono::duration<float>(now - lastReport).count();
+        if (elapsed < REPORT_SECONDS) continue;
+        lastReport = now;
+
+        RoomServer::Stats s = server.takeStats();
+        LoadGenerator::Stats l = load.takeStats();
+        std::size_t rss = residentBytes();
+        std::printf("rooms %d/%d active | %.0f ticks/s | p99 tick %.0f us, late %.0f us | "
+                    "%.0f snapshots/s, %.0f B avg | %.1f KB/room (RSS +%.1f MB) | in %.0f/s, dropped %llu",
+                    s.activeRooms, s.createdRooms, s.ticks / elapsed, s.tickP99Us, s.latenessP99Us,
+                    s.snapshots / elapsed, s.snapshots ? (double)s.snapshotBytes / (double)s.snapshots : 0.0,
+                    s.bytesPerRoom / 1024.0, rss > rssBefore ? (rss - rssBefore) / 1048576.0 : 0.0,
+                    s.datagramsIn / elapsed, (unsigned long long)s.dropped);
+        if (loadClients > 0) {
+            std::printf(" | clients %d joined, %d refused, %.0f snapshots/s", l.joined, l.refused, l.snapshots / elapsed);
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+
+        if (seconds > 0 && std::chrono::duration<float>(now - started).count() >= (float)seconds) running = false;
+    }
+    load.stop();
+    network.join();
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int port = net::DEFAULT_PORT;
+    int players = 2;
+    int bots = -1;
+    int tickMs = 80;
+    int rooms = 0;
+    int workers = 0;
+    int loadClients = 0;
+    int seconds = 0;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (hasValue && std::strcmp(argv[i], "--port") == 0) port = std::atoi(argv[++i]);
+        else if (hasValue && std::strcmp(argv[i], "--players") == 0) players = std::atoi(argv[++i]);
+        else if (hasValue && std::strcmp(argv[i], "--bots") == 0) bots = std::atoi(argv[++i]);
+        else if (hasValue && std::strcmp(argv[i], "--tick-ms") == 0) tickMs = std::atoi(argv[++i]);
+        else if (hasValue && std::strcmp(argv[i], "--rooms") == 0) rooms = std::atoi(argv[++i]);
+        else if (hasValue && std::strcmp(argv[i], "--workers") == 0) workers = std::atoi(argv[++i]);
+        else if (hasValue && std::strcmp(argv[i], "--load") == 0) loadClients = std::atoi(argv[++i]);
+        else if (hasValue && std::strcmp(argv[i], "--seconds") == 0) seconds = std::atoi(argv[++i]);
+        else {
+            std::cerr << "usage: SnakeServer [--port N] [--players N] [--bots N] [--tick-ms N]\n"
+                         "                   [--rooms N [--workers N] [--load CLIENTS] [--seconds S]]\n";
+            return 1;
+        }
+    }
+    // Single game: a crowded board; rooms: small matches
+    if (bots < 0) bots = rooms > 0 ? 2 : 20;
+    // Player ids travel as one byte, room ids as two
+    if (port <= 0 || port > 65535 || players < 1 || players > 255 || bots < 0 || tickMs < 10 ||
+        rooms < 0 || rooms > 65535 || loadClients < 0) {
+        std::cerr << "SnakeServer: invalid arguments\n";
+        return 1;
+    }
+    // A snapshot carries every snake, and it must fit in one datagram
+    if (players + bots > NetRoom::MAX_SNAKES) {
+        std::cerr << "SnakeServer: at most " << NetRoom::MAX_SNAKES << " players + bots per game\n";
+        return 1;
+    }
+
+    Log::start();
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    int rc = 0;
+    if (rooms > 0) {
+        RoomServer::Config config;
+        config.port = (unsigned short)port;
+        config.rooms = rooms;
+        config.players = players;
+        config.bots = bots;
+        config.workers = workers;
+        config.tickSeconds = (float)tickMs / 1000.f;
+        rc = runRooms(config, loadClients, seconds);
+    } else {
+        NetServer server(players, bots, (unsigned short)port, (float)tickMs / 1000.f);
+        if (server.start()) server.run(running);
+        else rc = 1;
+    }
+    Log::stop();
+    return rc;
+}